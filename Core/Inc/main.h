@@ -62,6 +62,19 @@ extern "C" {
                                         // 0 - byte by byte read from memory or peripherals
 #define RTECOM_WRITE_ENABLED         0  // 1 - Enable the write data to memory (debugging support)
                                         // 0 - write to embedded system memory disabled
+#define RTECOM_STREAMING_ENABLED     0  // 1 - Enable the RTECOM_READ_NEW command (transfer of new buffer words only)
+                                        // 0 - streaming disabled
+                                        // Note: set the RTE_LAP_COUNTER_ENABLED to 1 in the rtedbg_config.h for streaming
+#define RTECOM_BATCH_ENABLED         0  // 1 - Enable the RTECOM_BATCH command (several commands in one message)
+                                        // 0 - batch command disabled
+#define RTECOM_COMPRESSION_ENABLED   0  // 1 - Enable the RTECOM_READ_COMPRESSED command (run-length encoded data)
+                                        // 0 - compressed read disabled
+#define RTECOM_CHUNKED_READ_ENABLED  0  // 1 - Enable the RTECOM_READ_CHUNK command (chunks with checksum for retries)
+                                        // 0 - chunked read disabled
+#define RTECOM_DMA_RECEIVE           0  // 1 - Reception with DMA into a circular buffer (see the serial driver)
+                                        // 0 - reception with the USART RXNE interrupt (byte by byte)
+#define RTECOM_CRC_ENABLED           0  // 1 - CRC-32 protection of messages and responses (CRC peripheral)
+                                        // 0 - XOR checksum of messages only
 
 // Only if a timeout is implemented for receiving messages from the host, the following two macros must be defined.
 // Macro RTECOM_LOG_TIME_LAST_DATA_RECEIVED() stores time of the last message reception from the host.
@@ -76,6 +89,15 @@ extern "C" {
 #define STM32_DMA_UNIT          DMA1
 #define STM32_LL_DMA_CHANNEL    LL_DMA_CHANNEL_1
 #define STM32_USART             USART2
+#define STM32_DMA_IS_ACTIVE_FLAG_TC(dma)  LL_DMA_IsActiveFlag_TC1(dma)
+#define STM32_DMA_CLEAR_FLAG_TC(dma)      LL_DMA_ClearFlag_TC1(dma)
+#define RTECOM_TX_QUEUE_SIZE    4U      // Number of data blocks in the transmit queue (min. RTECOM_TX_MAX_BLOCKS)
+
+// Definitions for the DMA reception (RTECOM_DMA_RECEIVE == 1) in the rte_com_STM32_driver.h
+#define STM32_LL_DMA_RX_CHANNEL LL_DMA_CHANNEL_2
+#define STM32_LL_DMAMUX_REQ_RX  LL_DMAMUX_REQ_USART2_RX
+#define STM32_DMA_CLEAR_FLAG_RX(dma)      LL_DMA_ClearFlag_GI2(dma)
+#define RTECOM_RX_BUFFER_SIZE   64U     // Size of the circular receive buffer
 
 /* USER CODE END EC */
 
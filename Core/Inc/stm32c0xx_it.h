@@ -50,6 +50,8 @@ void EXTI4_15_IRQHandler(void);
 void TIM17_IRQHandler(void);
 void USART2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void DMA1_Channel1_IRQHandler(void);
+void DMA1_Channel2_3_IRQHandler(void);
 
 /* USER CODE END EFP */
 
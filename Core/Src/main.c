@@ -145,6 +145,13 @@ int main(void)
 	  {
 	      g_rtecom.no_received = 0;     // Restart the command reception from host
 	  }
+#if RTECOM_BATCH_ENABLED == 1
+	  if (((uwTick - uwTick_last_byte_received) > RTECOM_TIMEOUT)
+	       && (g_rtecom_batch.size != 0))
+	  {
+	      g_rtecom_batch.size = 0;      // Discard the incomplete batch of commands
+	  }
+#endif
 #endif
 	  //**************************************************************************
       HAL_Delay(1);
@@ -343,8 +350,19 @@ static void MX_USART2_UART_Init(void)
   }
   /* USER CODE BEGIN USART2_Init 2 */
 
+#if RTECOM_DMA_RECEIVE == 1
+  // Reception with DMA into a circular buffer (DMA1 channel 2)
+  rte_com_rx_init();
+  NVIC_SetPriority(DMA1_Channel2_3_IRQn, 0);
+  NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
+#else
   // Enable the RXNE interrupt
   LL_USART_EnableIT_RXNE(USART2);
+#endif
+
+#if RTECOM_CRC_ENABLED == 1
+  __HAL_RCC_CRC_CLK_ENABLE();   // CRC peripheral used for the CRC-32 of messages
+#endif
 
   /* USER CODE END USART2_Init 2 */
 
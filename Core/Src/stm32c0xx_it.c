@@ -138,6 +138,11 @@ void USART2_IRQHandler(void)
 {
   /* USER CODE BEGIN USART2_IRQn 0 */
 
+#if RTECOM_DMA_RECEIVE == 1
+#if RTE_ENABLED != 0
+    rte_com_rx_process();   // Idle line or reception error - process the data received with DMA
+#endif
+#else
     // Read the data from the USART receive register
     uint32_t data = USART2->RDR;
 
@@ -150,6 +155,7 @@ void USART2_IRQHandler(void)
 #if RTE_ENABLED != 0
     rte_com_byte_received(data, errors);
 #endif
+#endif  // RTECOM_DMA_RECEIVE == 1
 
   /* USER CODE END USART2_IRQn 0 */
   /* USER CODE BEGIN USART2_IRQn 1 */
@@ -159,4 +165,26 @@ void USART2_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles DMA1 channel 1 interrupt (USART2 transmit complete).
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+#if RTE_ENABLED != 0
+    rte_com_tx_complete();  // Start the transfer of the next queued data block
+#endif
+}
+
+#if RTECOM_DMA_RECEIVE == 1
+/**
+  * @brief This function handles DMA1 channel 2 and 3 interrupts (USART2 reception half/complete).
+  */
+void DMA1_Channel2_3_IRQHandler(void)
+{
+#if RTE_ENABLED != 0
+    rte_com_rx_process();   // Process the data received with DMA
+#endif
+}
+#endif
+
 /* USER CODE END 1 */
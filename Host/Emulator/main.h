@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    main.h
+ * @author  Branko Premzel
+ * @brief   Host version of the project definitions for the rte_com emulator.
+ *          The RTEdbg and RTEcomLib files include the 'main.h'. This file
+ *          replaces the Core/Inc/main.h in a host build (RTE_HOST_BUILD).
+ *          The RTECOM_* values can be overridden on the compiler command line.
+ ******************************************************************************/
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define UNUSED(x) (void)(x)
+
+//***** RTEcom settings - see the Core/Inc/main.h for the description *****
+#if !defined RTECOM_SINGLE_WIRE
+#define RTECOM_SINGLE_WIRE           0
+#endif
+#if !defined RTECOM_STREAMING_ENABLED
+#define RTECOM_STREAMING_ENABLED     1
+#endif
+#if !defined RTE_LAP_COUNTER_ENABLED
+#define RTE_LAP_COUNTER_ENABLED      RTECOM_STREAMING_ENABLED   // Required by the RTECOM_READ_NEW
+#endif
+#if !defined RTECOM_BATCH_ENABLED
+#define RTECOM_BATCH_ENABLED         1
+#endif
+#if !defined RTECOM_COMPRESSION_ENABLED
+#define RTECOM_COMPRESSION_ENABLED   1
+#endif
+#if !defined RTECOM_CHUNKED_READ_ENABLED
+#define RTECOM_CHUNKED_READ_ENABLED  1
+#endif
+#if !defined RTECOM_CRC_ENABLED
+#define RTECOM_CRC_ENABLED           0
+#endif
+#define RTECOM_READ_ENABLED          0  // Host addresses are not target addresses
+#define RTECOM_READ_FROM_PERIPHERALS 0
+#define RTECOM_WRITE_ENABLED         0
+#if !defined RTECOM_DMA_RECEIVE
+#define RTECOM_DMA_RECEIVE           0
+#endif
+
+// Message reception timeout - the same as in the demo firmware
+extern volatile uint32_t uwTick;
+extern uint32_t uwTick_last_byte_received;
+#define RTECOM_LOG_TIME_LAST_DATA_RECEIVED()   uwTick_last_byte_received = uwTick
+#define RTECOM_TIMEOUT           100U   // Message reception timeout in ms
+
+#if defined RTE_STM32_MOCK
+/* The STM32 serial driver with the mock of the LL_DMA and LL_USART functions
+ * (see the rte_stm32_mock.h). The definitions are the same as in the Core/Inc/main.h. */
+#include "rte_stm32_mock.h"
+#define RTECOM_SERIAL_DRIVER "Portable/rte_com_STM32_driver.h"
+#define STM32_DMA_UNIT          DMA1
+#define STM32_LL_DMA_CHANNEL    LL_DMA_CHANNEL_1
+#define STM32_USART             USART2
+#define STM32_DMA_IS_ACTIVE_FLAG_TC(dma)  LL_DMA_IsActiveFlag_TC1(dma)
+#define STM32_DMA_CLEAR_FLAG_TC(dma)      LL_DMA_ClearFlag_TC1(dma)
+#define STM32_LL_DMA_RX_CHANNEL LL_DMA_CHANNEL_2
+#define STM32_LL_DMAMUX_REQ_RX  LL_DMAMUX_REQ_USART2_RX
+#define STM32_DMA_CLEAR_FLAG_RX(dma)      LL_DMA_ClearFlag_GI2(dma)
+#if RTECOM_CRC_ENABLED == 1
+#error "The CRC peripheral is not simulated - build without RTECOM_CRC_ENABLED."
+#endif
+#else
+#define RTECOM_SERIAL_DRIVER "rte_com_pty_driver.h"
+#endif
+
+#if defined RTE_SIMULATED_SYSTICK
+/* Simulated ARM Cortex-M SYSTICK registers for the host test of the rtedbg_timer_systick_ext.h
+ * driver. The test program sets the counter value and the pending bit (rte_tstamp_sim.c). */
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    volatile uint32_t ICSR;
+} SCB_Type;
+
+extern SysTick_Type rte_sim_systick;
+extern SCB_Type rte_sim_scb;
+
+#define SysTick                     (&rte_sim_systick)
+#define SCB                         (&rte_sim_scb)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << 2U)
+#define SysTick_CTRL_TICKINT_Msk    (1UL << 1U)
+#define SysTick_CTRL_ENABLE_Msk     1UL
+#define SCB_ICSR_PENDSTSET_Msk      (1UL << 26U)
+
+void SysTick_Handler(void);
+#endif // defined RTE_SIMULATED_SYSTICK
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
+
+/*==== End of file ====*/
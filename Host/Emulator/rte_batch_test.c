@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_batch_test.c
+ * @author  Branko Premzel
+ * @brief   Test of the batch logging (RTE_BATCH_MSG0() ... RTE_BATCH_MSG4() and
+ *          rte_batch_commit()) with the host decoder (rte_decoder.c).
+ *
+ *          Every round logs a batch of messages with zero to four DATA words -
+ *          including two and three RTE_BATCH_MSG4() with the same format ID in
+ *          a row, a message of a disabled message group and more messages than
+ *          fit in a batch (automatic commit). A message logged with RTE_MSG1()
+ *          follows the batch. The snapshot of the g_rtedbg is then decoded:
+ *          *) the format IDs, number of DATA words and the DATA words must be the
+ *             same as logged (two messages with the same format ID must not be
+ *             joined into one long message by the decoder),
+ *          *) the timestamps of the consecutive messages of a batch must differ
+ *             by one timestamp unit (2^RTE_TIMESTAMP_SHIFT timer counts).
+ *
+ *          The results are printed in the CSV format. The exit code is 1 if an
+ *          error has been found.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -IHost/Emulator -IHost -IRTEdbg/Inc -IRTEdbg/Fmt
+ *              -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c
+ *              Host/Emulator/rte_batch_test.c -o rte_batch_test
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+// Format IDs of the test messages (not used by the rte_com_demo_fmt.h)
+#define RTE_BATCH_TEST_MSG0_ID  64U
+#define RTE_BATCH_TEST_MSG1_ID  66U
+#define RTE_BATCH_TEST_MSG2_ID  68U
+#define RTE_BATCH_TEST_MSG3_ID  72U
+#define RTE_BATCH_TEST_MSG4_ID  80U
+#define RTE_BATCH_TEST_SINGLE_ID 96U    // Message logged with the RTE_MSG1() after the batch
+
+#define F_BATCH_TEST_DISABLED   2U      // Message group disabled by the filter
+#define RTE_BATCH_TEST_MAX_MSGS 1000U   // Max. number of logged messages
+#define RTE_BATCH_TEST_MAX_REPORTS 10U  // Max. number of reported errors
+
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+
+typedef struct
+{
+    uint32_t fmt_id;
+    uint32_t no_words;
+    uint32_t data[4];
+    uint32_t batch;             // 1 - message logged with the rte_batch_commit()
+    uint32_t first;             // 1 - first message of a commit
+} rte_batch_test_msg_t;
+
+static struct
+{
+    uint32_t errors;
+    uint32_t logged;            // Number of messages in the expected[]
+    uint32_t decoded;           // Number of decoded messages
+    uint32_t batches;           // Number of rte_batch_commit() calls (incl. automatic)
+    uint64_t last_timestamp;
+    uint32_t timestamp_unit;    // 2^RTE_TIMESTAMP_SHIFT
+    uint32_t batch_msgs;        // Number of messages in the batch (see the rte_batch_add())
+    uint32_t batch_first;       // 1 - the next logged message is the first of a commit
+    rte_batch_test_msg_t expected[RTE_BATCH_TEST_MAX_MSGS];
+} test;
+
+static rte_decoder_t decoder;
+
+
+/***
+ * @brief Report an error (only the first RTE_BATCH_TEST_MAX_REPORTS are printed).
+ */
+
+static void rte_batch_test_error(const char *p_text, uint32_t msg_no)
+{
+    if (test.errors++ < RTE_BATCH_TEST_MAX_REPORTS)
+    {
+        fprintf(stderr, "%s: message %u\n", p_text, msg_no);
+    }
+}
+
+
+/***
+ * @brief Add a message to the list of expected messages.
+ */
+
+static void rte_batch_test_expect(uint32_t fmt_id, uint32_t no_words, uint32_t seq,
+                                  uint32_t batch, uint32_t first)
+{
+    if (test.logged >= RTE_BATCH_TEST_MAX_MSGS)
+    {
+        return;
+    }
+
+    rte_batch_test_msg_t *p_msg = &test.expected[test.logged];
+    p_msg->fmt_id = fmt_id;
+    p_msg->no_words = no_words;
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        p_msg->data[i] = seq + i;
+    }
+    p_msg->batch = batch;
+    p_msg->first = first;
+    test.logged++;
+}
+
+
+/***
+ * @brief Count a message added to the batch and add it to the expected[] if it is logged.
+ *        The rte_batch_add() commits a full batch (RTE_BATCH_MAX_MSGS messages) before
+ *        the message is added.
+ */
+
+static void rte_batch_test_added(uint32_t fmt_id, uint32_t no_words, uint32_t seq,
+                                 uint32_t logged)
+{
+    if (test.batch_msgs == (uint32_t)(RTE_BATCH_MAX_MSGS))
+    {
+        test.batches++;         // Automatic commit of the full batch
+        test.batch_msgs = 0U;
+        test.batch_first = 1U;
+    }
+
+    test.batch_msgs++;
+    if (logged != 0U)
+    {
+        rte_batch_test_expect(fmt_id, no_words, seq, 1U, test.batch_first);
+        test.batch_first = 0U;
+    }
+}
+
+
+/***
+ * @brief Log a test round and add the enabled messages to the expected[].
+ *        The first messages are committed automatically if the RTE_BATCH_MAX_MSGS is
+ *        less than 11 (default 8).
+ */
+
+static void rte_batch_test_round(uint32_t seq)
+{
+    rte_batch_t batch;
+
+    rte_batch_init(&batch);
+    test.batch_msgs = 0U;
+    test.batch_first = 1U;
+
+    RTE_BATCH_MSG4(&batch, RTE_BATCH_TEST_MSG4_ID, F_COM_DEMO, seq, seq + 1U, seq + 2U, seq + 3U);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG4_ID, 4U, seq, 1U);
+    RTE_BATCH_MSG4(&batch, RTE_BATCH_TEST_MSG4_ID, F_COM_DEMO, seq, seq + 1U, seq + 2U, seq + 3U);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG4_ID, 4U, seq, 1U);
+    RTE_BATCH_MSG0(&batch, RTE_BATCH_TEST_MSG0_ID, F_COM_DEMO);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG0_ID, 0U, seq, 1U);
+    RTE_BATCH_MSG1(&batch, RTE_BATCH_TEST_MSG1_ID, F_COM_DEMO, seq);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG1_ID, 1U, seq, 1U);
+    RTE_BATCH_MSG1(&batch, RTE_BATCH_TEST_MSG1_ID, F_BATCH_TEST_DISABLED, seq);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG1_ID, 1U, seq, 0U);
+    RTE_BATCH_MSG2(&batch, RTE_BATCH_TEST_MSG2_ID, F_COM_DEMO, seq, seq + 1U);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG2_ID, 2U, seq, 1U);
+    RTE_BATCH_MSG3(&batch, RTE_BATCH_TEST_MSG3_ID, F_COM_DEMO, seq, seq + 1U, seq + 2U);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG3_ID, 3U, seq, 1U);
+
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        RTE_BATCH_MSG4(&batch, RTE_BATCH_TEST_MSG4_ID, F_COM_DEMO,
+                       seq, seq + 1U, seq + 2U, seq + 3U);
+        rte_batch_test_added(RTE_BATCH_TEST_MSG4_ID, 4U, seq, 1U);
+    }
+
+    RTE_BATCH_MSG0(&batch, RTE_BATCH_TEST_MSG0_ID, F_COM_DEMO);
+    rte_batch_test_added(RTE_BATCH_TEST_MSG0_ID, 0U, seq, 1U);
+
+    rte_batch_commit(&batch);
+    test.batches++;
+
+    RTE_MSG1(RTE_BATCH_TEST_SINGLE_ID, F_COM_DEMO, seq);
+    rte_batch_test_expect(RTE_BATCH_TEST_SINGLE_ID, 1U, seq, 0U, 1U);
+}
+
+
+/***
+ * @brief Compare a decoded message with the expected one - called by the decoder.
+ */
+
+static void rte_batch_test_check(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_user;
+    uint32_t msg_no = test.decoded++;
+
+    if (msg_no >= test.logged)
+    {
+        rte_batch_test_error("Too many messages", msg_no);
+        return;
+    }
+
+    const rte_batch_test_msg_t *p_exp = &test.expected[msg_no];
+    if ((p_msg->fmt_id != p_exp->fmt_id) || (p_msg->no_words != p_exp->no_words))
+    {
+        rte_batch_test_error("Wrong format ID or size", msg_no);
+    }
+    else
+    {
+        for (uint32_t i = 0U; i < p_exp->no_words; i++)
+        {
+            if (p_msg->data[i] != p_exp->data[i])
+            {
+                rte_batch_test_error("Wrong DATA word", msg_no);
+                break;
+            }
+        }
+    }
+
+    if ((p_exp->batch != 0U) && (p_exp->first == 0U)
+        && (p_msg->timestamp != (test.last_timestamp + test.timestamp_unit)))
+    {
+        rte_batch_test_error("Batch timestamps not consecutive", msg_no);
+    }
+
+    test.last_timestamp = p_msg->timestamp;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t no_rounds = 20U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                no_rounds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-n number_of_rounds]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    rte_set_filter(~(0x80000000U >> F_BATCH_TEST_DISABLED));
+    test.timestamp_unit = 1U << (uint32_t)(RTE_TIMESTAMP_SHIFT);
+
+    for (uint32_t round = 0U; round < no_rounds; round++)
+    {
+        // Bit 31 of the DATA words is set in every second round
+        rte_batch_test_round((round << 8U) | ((round & 1U) << 31U));
+        if ((g_rtedbg.buf_index + 64U) >= (uint32_t)(RTE_BUFFER_SIZE))
+        {
+            fprintf(stderr, "The messages of %u rounds do not fit in the buffer\n", no_rounds);
+            return 1;
+        }
+    }
+
+    if (rte_dec_snapshot(&decoder, (const uint8_t *)&g_rtedbg, sizeof(g_rtedbg),
+                         rte_batch_test_check, NULL) != RTE_DEC_OK)
+    {
+        rte_batch_test_error("Bad snapshot header", 0U);
+    }
+
+    if (test.decoded != test.logged)
+    {
+        rte_batch_test_error("Number of decoded messages not correct", test.decoded);
+    }
+
+    printf("# rounds,batches,messages,decoded,errors\n%u,%u,%u,%u,%u\n",
+           no_rounds, test.batches, test.logged, test.decoded, test.errors);
+
+    return (test.errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,608 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_bench.c
+ * @author  Branko Premzel
+ * @brief   Throughput and latency benchmark for the RTEcomLib protocol.
+ *
+ *          Scripted host sessions are replayed against the host build of the
+ *          rte_com.c. The serial line is emulated with a virtual clock - the
+ *          results do not depend on the host computer speed (except the CPU
+ *          time). Sessions:
+ *          *) snapshot - stop logging, read the header and the circular buffer
+ *             in blocks, restore the message filter,
+ *          *) polling  - persistent mode: the firmware logs messages between
+ *             the RTECOM_READ_NEW requests (RTECOM_STREAMING_ENABLED),
+ *          *) chunked  - the same as snapshot, but the g_rtedbg is read with
+ *             the RTECOM_READ_CHUNK command (RTECOM_CHUNKED_READ_ENABLED).
+ *             Errors can be injected into the responses of this session
+ *             (-e option) - chunks with a bad checksum are read again
+ *             (in smaller chunks after repeated failures). The simple chunk
+ *             checksum does not detect all multiple-bit errors - a high error
+ *             rate may cause a data mismatch unless the CRC-32 is enabled,
+ *          *) banks    - dual bank logging (RTE_DUAL_BANK_ENABLED): the banks
+ *             are swapped and the frozen bank is read in blocks while the
+ *             firmware continues logging to the other bank,
+ *          *) filter   - message filter writes only (command latency).
+ *          For every session, the effective payload throughput (circular
+ *          buffer data delivered to the host) is compared with the line rate.
+ *          The per-command latency (from the first command byte to the last
+ *          response byte) and the rte_com CPU time per received byte are reported.
+ *
+ *          The results are printed in the CSV format. The program returns 1 if
+ *          the snapshot efficiency is below the limit given with the -m option
+ *          or if the chunked read has been aborted after too many retries or
+ *          its data is not correct.
+ *          Build with -DRTECOM_SINGLE_WIRE=1 to include the single-wire echo
+ *          processing (skipping of the own data with g_rtecom.no_received).
+ *          Build with -DRTECOM_CRC_ENABLED=1 and add the Host/rte_com_crc.c
+ *          to benchmark the CRC-32 protected messages.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -IHost/Emulator -IHost -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib
+ *              RTEdbg/rtedbg.c RTEcomLib/rte_com.c Host/rte_com_chunk.c
+ *              Host/Emulator/rte_com_bench.c -o rte_com_bench
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com.h"
+#include "rte_com_demo_fmt.h"
+#if RTECOM_CRC_ENABLED == 1
+#include "rte_com_crc.h"
+#endif
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+#include "rte_com_chunk.h"
+#endif
+
+#define RTE_BENCH_BITS_PER_CHAR  10U     // Start bit + 8 data bits + stop bit
+#define RTE_BENCH_RESPONSE_SIZE  (sizeof(g_rtedbg) + 64U)
+
+volatile uint32_t uwTick;
+uint32_t uwTick_last_byte_received;
+
+typedef struct
+{
+    uint32_t count;             // Number of commands executed
+    uint64_t rx_bytes;          // Bytes received by the rte_com (commands)
+    uint64_t tx_bytes;          // Bytes sent by the rte_com (responses)
+    uint64_t latency_sum;       // Sum of command latencies [ns]
+    uint64_t latency_max;       // Max. command latency [ns]
+} rte_bench_cmd_t;
+
+typedef struct
+{
+    const char *p_name;
+    rte_bench_cmd_t cmd[RTECOM_LAST_COMMAND];
+    uint64_t line_time;         // Virtual serial line time [ns]
+    uint64_t payload;           // Circular buffer bytes delivered to the host
+    uint64_t cpu_time;          // rte_com execution time [ns]
+    uint64_t rx_processed;      // Bytes processed by the rte_com_byte_received() (incl. echo)
+    uint32_t crc_errors;        // Responses with a bad CRC-32
+    uint32_t retries;           // Chunks read again (bad checksum)
+} rte_bench_session_t;
+
+static struct
+{
+    uint32_t baud_rate;
+    uint32_t error_rate;        // One of 'error_rate' response bytes is corrupted (0 = none)
+    uint8_t response[RTE_BENCH_RESPONSE_SIZE];  // Data sent by the rte_com
+    uint32_t response_size;
+    rte_bench_session_t *p_session;
+} bench;
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_bench_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/***
+ * @brief Transfer time of data over the emulated serial line [ns].
+ */
+
+static uint64_t rte_bench_line_time(uint32_t no_bytes)
+{
+    return ((uint64_t)no_bytes * RTE_BENCH_BITS_PER_CHAR * 1000000000U) / bench.baud_rate;
+}
+
+
+/***
+ * @brief Store the data sent by the rte_com - called by the rte_com_send_data().
+ */
+
+void rte_emu_send(const uint8_t *p_data, uint32_t size)
+{
+    if (size > (RTE_BENCH_RESPONSE_SIZE - bench.response_size))
+    {
+        size = RTE_BENCH_RESPONSE_SIZE - bench.response_size;
+    }
+    memcpy(&bench.response[bench.response_size], p_data, size);
+    bench.response_size += size;
+}
+
+
+/***
+ * @brief Send a command to the rte_com and collect the response.
+ *
+ * @param command  Command code
+ * @param address  Address parameter
+ * @param data     Data parameter
+ *
+ * @return Pointer to the response data (size in bench.response_size)
+ */
+
+static const uint8_t *rte_bench_command(uint8_t command, uint32_t address, uint32_t data)
+{
+    rte_bench_session_t *p_session = bench.p_session;
+    uint8_t frame[RTECOM_RECV_PACKET_LEN];
+    uint8_t checksum = RTECOM_CHECKSUM;
+
+    frame[0] = command;
+    memcpy(&frame[2], &address, 4U);
+    memcpy(&frame[6], &data, 4U);
+    for (uint32_t i = 2U; i < (RTECOM_RECV_PACKET_LEN - RTECOM_CRC_SIZE); i++)
+    {
+        checksum ^= frame[i];
+    }
+    frame[1] = checksum;
+#if RTECOM_CRC_ENABLED == 1
+    rte_com_crc_message(frame);
+#endif
+
+    bench.response_size = 0U;
+    uint64_t start = rte_bench_time();
+    for (uint32_t i = 0U; i < RTECOM_RECV_PACKET_LEN; i++)
+    {
+        rte_com_byte_received(frame[i], 0U);
+    }
+#if RTECOM_SINGLE_WIRE == 1
+    // The rte_com receives its own response and skips it
+    for (uint32_t i = 0U; i < bench.response_size; i++)
+    {
+        rte_com_byte_received(bench.response[i], 0U);
+    }
+    p_session->rx_processed += bench.response_size;
+#endif
+    uint64_t cpu_time = rte_bench_time() - start;
+
+    // Latency = command transfer + execution + response transfer
+    uint64_t latency = rte_bench_line_time(RTECOM_RECV_PACKET_LEN + bench.response_size) + cpu_time;
+    rte_bench_cmd_t *p_cmd = &p_session->cmd[command];
+    p_cmd->count++;
+    p_cmd->rx_bytes += RTECOM_RECV_PACKET_LEN;
+    p_cmd->tx_bytes += bench.response_size;
+    p_cmd->latency_sum += latency;
+    if (latency > p_cmd->latency_max)
+    {
+        p_cmd->latency_max = latency;
+    }
+
+    p_session->line_time += latency;
+    p_session->cpu_time += cpu_time;
+    p_session->rx_processed += RTECOM_RECV_PACKET_LEN;
+
+    if (bench.error_rate != 0U)
+    {
+        // Transfer errors of the response (e.g. the chunked read session)
+        for (uint32_t i = 0U; i < bench.response_size; i++)
+        {
+            if (((uint32_t)rand() % bench.error_rate) == 0U)
+            {
+                bench.response[i] ^= (uint8_t)(1U << ((uint32_t)rand() & 7U));
+            }
+        }
+    }
+
+#if RTECOM_CRC_ENABLED == 1
+    // Check and remove the CRC-32 of the response (a response with a bad CRC is discarded)
+    if (bench.response_size >= RTECOM_CRC_SIZE)
+    {
+        uint32_t crc;
+        bench.response_size -= RTECOM_CRC_SIZE;
+        memcpy(&crc, &bench.response[bench.response_size], RTECOM_CRC_SIZE);
+        // The CRC of the RTECOM_READ_NEW response covers only the next index
+        size_t crc_size = bench.response_size;
+        if ((command == RTECOM_READ_NEW) && (crc_size > 4U))
+        {
+            crc_size = 4U;
+        }
+        if (crc != rte_com_crc32(RTE_COM_CRC_INIT, bench.response, crc_size))
+        {
+            p_session->crc_errors++;
+            bench.response_size = 0U;   // Discarded as if not received
+        }
+    }
+#endif
+    return bench.response;
+}
+
+
+/***
+ * @brief Log messages as the firmware does between the host requests.
+ */
+
+static void rte_bench_log(uint32_t no_messages)
+{
+    for (uint32_t i = 0U; i < no_messages; i++)
+    {
+        if ((i & 7U) == 0U)
+        {
+            RTE_MSG0(MSG0_IWDG_RELOAD, F_COM_DEMO);
+        }
+        else
+        {
+            RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i);
+        }
+    }
+}
+
+
+/***
+ * @brief Snapshot session - the same command sequence as used by the RTEgetData utility.
+ *
+ * @param repeat      Number of snapshots
+ * @param block_size  Size of the blocks in which the buffer is read [bytes]
+ */
+
+static void rte_bench_snapshot(uint32_t repeat, uint32_t block_size)
+{
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_bench_log(RTE_BUFFER_SIZE);     // Fill the buffer
+        uint32_t filter;
+        memcpy(&filter, rte_bench_command(RTECOM_READ_RTEDBG, 4U, 4U), 4U);
+        (void)rte_bench_command(RTECOM_WRITE_RTEDBG, 1U, 0U);   // Stop logging
+        (void)rte_bench_command(RTECOM_READ_RTEDBG, 0U, RTE_HEADER_SIZE);
+
+        for (uint32_t offset = 0U; offset < sizeof(g_rtedbg.buffer); offset += block_size)
+        {
+            uint32_t size = sizeof(g_rtedbg.buffer) - offset;
+            if (size > block_size)
+            {
+                size = block_size;
+            }
+            (void)rte_bench_command(RTECOM_READ_RTEDBG, RTE_HEADER_SIZE + offset, size);
+            bench.p_session->payload += bench.response_size;
+        }
+
+        (void)rte_bench_command(RTECOM_WRITE_RTEDBG, 1U, filter);  // Restore the filter
+    }
+}
+
+
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+/***
+ * @brief Chunked snapshot session - the complete g_rtedbg is read with the RTECOM_READ_CHUNK
+ *        command. Chunks with transfer errors are requested again.
+ *
+ * @param repeat      Number of snapshots
+ * @param chunk_size  Size of the chunks [bytes]
+ * @param error_rate  One of 'error_rate' response bytes is corrupted (0 = none)
+ *
+ * @return 0 - OK, 1 - transfer aborted (too many retries) or data not correct
+ */
+
+static uint32_t rte_bench_chunked(uint32_t repeat, uint32_t chunk_size, uint32_t error_rate)
+{
+    static rte_com_chunk_reader_t reader;
+    static uint32_t copy[sizeof(g_rtedbg) / 4U];
+
+    chunk_size &= ~3U;
+    if ((chunk_size == 0U) || (chunk_size > RTECOM_CHUNK_MAX_SIZE))
+    {
+        chunk_size = RTECOM_CHUNK_MAX_SIZE;
+    }
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_bench_log(RTE_BUFFER_SIZE);     // Fill the buffer
+        uint32_t filter;
+        memcpy(&filter, rte_bench_command(RTECOM_READ_RTEDBG, 4U, 4U), 4U);
+        (void)rte_bench_command(RTECOM_WRITE_RTEDBG, 1U, 0U);   // Stop logging
+
+        uint32_t address;
+        uint32_t data;
+        int result;
+        (void)rte_com_chunk_init(&reader, (uint8_t *)copy, 0U, sizeof(g_rtedbg), chunk_size);
+        bench.error_rate = error_rate;
+        while ((result = rte_com_chunk_request(&reader, &address, &data)) > 0)
+        {
+            const uint8_t *p_response = rte_bench_command(RTECOM_READ_CHUNK, address, data);
+            if (rte_com_chunk_response(&reader, p_response, bench.response_size) == RTECOM_CHUNK_OK)
+            {
+                bench.p_session->payload += data & RTECOM_CHUNK_SIZE_MASK;
+            }
+        }
+        bench.error_rate = 0U;
+        bench.p_session->retries += reader.retries;
+
+        uint32_t error = 1U;
+        if (result == RTECOM_CHUNK_TOO_MANY_RETRIES)
+        {
+            fprintf(stderr, "Chunked read: aborted after %u consecutive failures\n", reader.failures);
+        }
+        else if (memcmp(copy, &g_rtedbg, sizeof(g_rtedbg)) != 0)
+        {
+            fprintf(stderr, "Chunked read: data not equal to g_rtedbg\n");
+        }
+        else
+        {
+            error = 0U;
+        }
+
+        (void)rte_bench_command(RTECOM_WRITE_RTEDBG, 1U, filter);  // Restore the filter
+        if (error != 0U)
+        {
+            return 1U;
+        }
+    }
+
+    return 0U;
+}
+#endif
+
+
+#if RTE_DUAL_BANK_ENABLED == 1
+/***
+ * @brief Dual bank session - the logging is not stopped during the transfer. Messages
+ *        logged between the block reads must be in the bank read by the next snapshot.
+ *
+ * @param repeat      Number of snapshots
+ * @param block_size  Size of the blocks in which the buffer is read [bytes]
+ */
+
+static void rte_bench_banks(uint32_t repeat, uint32_t block_size)
+{
+    uint32_t lost = 0U;
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_bench_log(RTE_BUFFER_SIZE / 4U);
+        const uint8_t *p_response = rte_bench_command(RTECOM_SWAP_BANKS, 0U, 0U);
+        if (bench.response_size != 1U)
+        {
+            lost++;
+            continue;
+        }
+
+        uint32_t bank = (uint32_t)p_response[0] << RTECOM_CONTEXT_SHIFT;
+        const rtedbg_t *p_frozen = (p_response[0] == 0U) ? &g_rtedbg : &g_rtedbg_bank;
+        (void)rte_bench_command(RTECOM_READ_RTEDBG, bank, RTE_HEADER_SIZE);
+
+        // The buffer index of the frozen bank must not change while it is read
+        uint32_t buf_index = p_frozen->buf_index;
+        for (uint32_t offset = 0U; offset < sizeof(g_rtedbg.buffer); offset += block_size)
+        {
+            uint32_t size = sizeof(g_rtedbg.buffer) - offset;
+            if (size > block_size)
+            {
+                size = block_size;
+            }
+            (void)rte_bench_command(RTECOM_READ_RTEDBG, bank + RTE_HEADER_SIZE + offset, size);
+            bench.p_session->payload += bench.response_size;
+            rte_bench_log(8U);      // Logging continues during the transfer
+        }
+
+        if (p_frozen->buf_index != buf_index)
+        {
+            lost++;
+        }
+    }
+
+    if (lost != 0U)
+    {
+        fprintf(stderr, "Dual bank: %u frozen banks changed during the transfer\n", lost);
+    }
+}
+#endif
+
+
+#if RTECOM_STREAMING_ENABLED == 1
+/***
+ * @brief Persistent mode session - new buffer words are requested after every
+ *        group of messages logged by the firmware.
+ *
+ * @param repeat        Number of requests
+ * @param msgs_per_poll Number of messages logged between the requests
+ */
+
+static void rte_bench_polling(uint32_t repeat, uint32_t msgs_per_poll)
+{
+    uint32_t index = 0U;
+    uint32_t overruns = 0U;
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_bench_log(msgs_per_poll);
+        const uint8_t *p_response = rte_bench_command(RTECOM_READ_NEW, index, RTE_BUFFER_SIZE + 4U);
+        if (bench.response_size >= 4U)
+        {
+            memcpy(&index, p_response, 4U);
+            if ((index & RTECOM_STREAM_OVERRUN) != 0U)
+            {
+                overruns++;
+                index &= ~RTECOM_STREAM_OVERRUN;
+            }
+            bench.p_session->payload += bench.response_size - 4U;
+        }
+    }
+
+    if (overruns != 0U)
+    {
+        fprintf(stderr, "Polling: %u overruns (%u messages per request)\n", overruns, msgs_per_poll);
+    }
+}
+#endif
+
+
+/***
+ * @brief Message filter write session.
+ */
+
+static void rte_bench_filter(uint32_t repeat)
+{
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        (void)rte_bench_command(RTECOM_WRITE_RTEDBG, 1U, (n & 1U) ? 0xFFFFFFFFU : 0x7FFFFFFFU);
+    }
+}
+
+
+/***
+ * @brief Print the session results (CSV) and return the payload efficiency [%].
+ */
+
+static double rte_bench_report(const rte_bench_session_t *p_session)
+{
+    double line_rate = (double)bench.baud_rate / RTE_BENCH_BITS_PER_CHAR;   // [bytes/s]
+    double seconds = (double)p_session->line_time / 1e9;
+    double throughput = (seconds > 0.0) ? ((double)p_session->payload / seconds) : 0.0;
+    double efficiency = (100.0 * throughput) / line_rate;
+    double cpu_per_byte = (p_session->rx_processed != 0U)
+        ? ((double)p_session->cpu_time / (double)p_session->rx_processed) : 0.0;
+
+    for (uint32_t i = 0U; i < RTECOM_LAST_COMMAND; i++)
+    {
+        const rte_bench_cmd_t *p_cmd = &p_session->cmd[i];
+        if (p_cmd->count != 0U)
+        {
+            printf("command,%s,%u,%u,%llu,%llu,%.1f,%.1f\n", p_session->p_name, i, p_cmd->count,
+                   (unsigned long long)p_cmd->rx_bytes, (unsigned long long)p_cmd->tx_bytes,
+                   ((double)p_cmd->latency_sum / p_cmd->count) / 1e3,
+                   (double)p_cmd->latency_max / 1e3);
+        }
+    }
+
+    printf("session,%s,%llu,%.6f,%.0f,%.0f,%.2f,%.1f,%u,%u\n", p_session->p_name,
+           (unsigned long long)p_session->payload, seconds, throughput, line_rate,
+           efficiency, cpu_per_byte, p_session->crc_errors, p_session->retries);
+    return efficiency;
+}
+
+
+static void rte_bench_usage(const char *p_name)
+{
+    fprintf(stderr,
+            "Usage: %s [-b baud_rate] [-k block_size] [-n repeat] [-m min_efficiency] [-e error_rate]\n"
+            "  -b  Emulated baud rate (default 1500000)\n"
+            "  -k  Snapshot read block size [bytes] (default: complete buffer)\n"
+            "  -n  Number of repetitions of each session (default 20)\n"
+            "  -m  Min. snapshot payload efficiency [%%] - exit code 1 if lower\n"
+            "  -e  Corrupt one of 'error_rate' response bytes in the chunked session\n",
+            p_name);
+}
+
+
+int main(int argc, char *argv[])
+{
+    static rte_bench_session_t sessions[5];
+    uint32_t block_size = sizeof(g_rtedbg.buffer);
+    uint32_t repeat = 20U;
+    double min_efficiency = 0.0;
+    uint32_t error_rate = 0U;
+    uint32_t errors = 0U;
+    int opt;
+
+    bench.baud_rate = 1500000U;
+    while ((opt = getopt(argc, argv, "b:k:n:m:e:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                bench.baud_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'k':
+                block_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                repeat = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'm':
+                min_efficiency = strtod(optarg, NULL);
+                break;
+
+            case 'e':
+                error_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                rte_bench_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((bench.baud_rate == 0U) || (block_size == 0U))
+    {
+        rte_bench_usage(argv[0]);
+        return 1;
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    printf("# command,session,command_code,count,rx_bytes,tx_bytes,latency_avg_us,latency_max_us\n");
+    printf("# session,session,payload_bytes,line_time_s,payload_Bps,line_rate_Bps,efficiency_pct,cpu_ns_per_rx_byte,crc_errors,chunk_retries\n");
+
+    sessions[0].p_name = "snapshot";
+    bench.p_session = &sessions[0];
+    rte_bench_snapshot(repeat, block_size);
+    double efficiency = rte_bench_report(&sessions[0]);
+
+#if RTECOM_STREAMING_ENABLED == 1
+    sessions[1].p_name = "polling";
+    bench.p_session = &sessions[1];
+    rte_bench_polling(repeat * 50U, 100U);
+    (void)rte_bench_report(&sessions[1]);
+#endif
+
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+    sessions[2].p_name = "chunked";
+    bench.p_session = &sessions[2];
+    errors = rte_bench_chunked(repeat, block_size, error_rate);
+    (void)rte_bench_report(&sessions[2]);
+#else
+    UNUSED(error_rate);
+#endif
+
+#if RTE_DUAL_BANK_ENABLED == 1
+    sessions[3].p_name = "banks";
+    bench.p_session = &sessions[3];
+    rte_bench_banks(repeat, block_size);
+    (void)rte_bench_report(&sessions[3]);
+#endif
+
+    sessions[4].p_name = "filter";
+    bench.p_session = &sessions[4];
+    rte_bench_filter(repeat * 50U);
+    (void)rte_bench_report(&sessions[4]);
+
+    if (efficiency < min_efficiency)
+    {
+        fprintf(stderr, "Snapshot efficiency %.2f %% is below the limit %.2f %%\n",
+                efficiency, min_efficiency);
+        return 1;
+    }
+
+    return (errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_compress_bench.c
+ * @author  Branko Premzel
+ * @brief   Benchmark of the compressed read (RTECOM_READ_COMPRESSED) with
+ *          captured g_rtedbg snapshots.
+ *
+ *          Each input is loaded to the g_rtedbg and read with the
+ *          RTECOM_READ_COMPRESSED commands as by a host application. The data
+ *          is decoded with the rte_com_decompress() and compared with the
+ *          g_rtedbg. The inputs are the binary files given on the command line
+ *          (e.g. Data.bin files captured with the RTEgetData utility - the
+ *          g_rtedbg header followed by the circular buffer). Without files,
+ *          three typical snapshots are generated: an empty buffer, a half
+ *          full buffer and a full buffer. A file larger than the g_rtedbg is
+ *          truncated - build with a matching -DRTE_BUFFER_SIZE.
+ *
+ *          For each input, the number of commands, the size of the compressed
+ *          data compared with the uncompressed read (RTECOM_READ_RTEDBG), the
+ *          transfer time at the selected baud rate and the rte_com CPU time per
+ *          word are printed in the CSV format. The exit code is 1 if any input
+ *          has not been decoded correctly.
+ *          Build with -DRTECOM_CRC_ENABLED=1 and add the Host/rte_com_crc.c
+ *          to check the CRC-32 protected messages.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -IHost/Emulator -IHost -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib
+ *              RTEdbg/rtedbg.c RTEcomLib/rte_com.c Host/rte_com_decompress.c
+ *              Host/Emulator/rte_com_compress_bench.c -o rte_com_compress_bench
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_com_decompress.h"
+#if RTECOM_CRC_ENABLED == 1
+#include "rte_com_crc.h"
+#endif
+
+#if RTECOM_COMPRESSION_ENABLED != 1
+#error "Build with RTECOM_COMPRESSION_ENABLED = 1"
+#endif
+
+#define RTE_BENCH_BITS_PER_CHAR  10U     // Start bit + 8 data bits + stop bit
+#define RTE_BENCH_WORDS          (sizeof(g_rtedbg) / 4U)
+
+volatile uint32_t uwTick;
+uint32_t uwTick_last_byte_received;
+
+static struct
+{
+    uint32_t baud_rate;
+    uint32_t repeat;
+    uint8_t response[4U + (4U * RTECOM_COMPRESS_MAX_WORDS) + RTECOM_COMPRESS_BUFFER_SIZE + RTECOM_CRC_SIZE];
+    uint32_t response_size;
+    uint32_t copy[RTE_BENCH_WORDS];     // Decoded data
+    uint32_t errors;
+} bench;
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_bench_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/***
+ * @brief Store the data sent by the rte_com - called by the rte_com_send_data().
+ */
+
+void rte_emu_send(const uint8_t *p_data, uint32_t size)
+{
+    if (size > (sizeof(bench.response) - bench.response_size))
+    {
+        size = sizeof(bench.response) - bench.response_size;
+    }
+    memcpy(&bench.response[bench.response_size], p_data, size);
+    bench.response_size += size;
+}
+
+
+/***
+ * @brief Send a command to the rte_com. The response is in the bench.response.
+ */
+
+static void rte_bench_command(uint8_t command, uint32_t address, uint32_t data)
+{
+    uint8_t frame[RTECOM_RECV_PACKET_LEN];
+    uint8_t checksum = RTECOM_CHECKSUM;
+
+    frame[0] = command;
+    memcpy(&frame[2], &address, 4U);
+    memcpy(&frame[6], &data, 4U);
+    for (uint32_t i = 2U; i < (RTECOM_RECV_PACKET_LEN - RTECOM_CRC_SIZE); i++)
+    {
+        checksum ^= frame[i];
+    }
+    frame[1] = checksum;
+#if RTECOM_CRC_ENABLED == 1
+    rte_com_crc_message(frame);
+#endif
+
+    bench.response_size = 0U;
+    for (uint32_t i = 0U; i < RTECOM_RECV_PACKET_LEN; i++)
+    {
+        rte_com_byte_received(frame[i], 0U);
+    }
+
+#if RTECOM_CRC_ENABLED == 1
+    // Check and remove the CRC-32 of the response (a response with a bad CRC is discarded)
+    if (bench.response_size >= RTECOM_CRC_SIZE)
+    {
+        uint32_t crc;
+        bench.response_size -= RTECOM_CRC_SIZE;
+        memcpy(&crc, &bench.response[bench.response_size], RTECOM_CRC_SIZE);
+        if (crc != rte_com_crc32(RTE_COM_CRC_INIT, bench.response, bench.response_size))
+        {
+            bench.response_size = 0U;
+        }
+    }
+#endif
+}
+
+
+/***
+ * @brief Read the complete g_rtedbg with the RTECOM_READ_COMPRESSED commands.
+ *
+ * @param p_commands  Number of commands
+ * @param p_bytes     Number of response bytes
+ *
+ * @return 0 - data decoded, 1 - error
+ */
+
+static uint32_t rte_bench_read(uint32_t *p_commands, uint32_t *p_bytes)
+{
+    uint32_t index = 0U;        // Index of the next word
+    *p_commands = 0U;
+    *p_bytes = 0U;
+
+    while (index < RTE_BENCH_WORDS)
+    {
+        rte_bench_command(RTECOM_READ_COMPRESSED, index * 4U, RTE_BENCH_WORDS - index);
+        (*p_commands)++;
+        *p_bytes += bench.response_size + RTECOM_CRC_SIZE;
+
+        uint32_t no_words;
+        if ((rte_com_decompress_response(bench.response, bench.response_size, &bench.copy[index],
+                                         RTE_BENCH_WORDS - index, &no_words) != RTECOM_DECOMPRESS_OK)
+            || (no_words == 0U))
+        {
+            return 1U;
+        }
+        index += no_words;
+    }
+
+    return 0U;
+}
+
+
+/***
+ * @brief Read the g_rtedbg and print the results (CSV).
+ *
+ * @param p_name  Name of the input
+ */
+
+static void rte_bench_input(const char *p_name)
+{
+    uint32_t commands = 0U;
+    uint32_t bytes = 0U;
+    uint32_t errors = 0U;
+
+    uint64_t start = rte_bench_time();
+    for (uint32_t n = 0U; n < bench.repeat; n++)
+    {
+        memset(bench.copy, 0, sizeof(bench.copy));
+        errors |= rte_bench_read(&commands, &bytes);
+    }
+    uint64_t cpu_time = (rte_bench_time() - start) / bench.repeat;
+
+    if ((errors != 0U) || (memcmp(bench.copy, &g_rtedbg, sizeof(g_rtedbg)) != 0))
+    {
+        fprintf(stderr, "%s: the decoded data is not equal to the g_rtedbg\n", p_name);
+        errors = 1U;
+    }
+    bench.errors += errors;
+
+    // Line data: host messages and responses
+    uint32_t compressed = bytes + (commands * RTECOM_RECV_PACKET_LEN);
+    uint32_t raw = (uint32_t)sizeof(g_rtedbg) + RTECOM_CRC_SIZE + RTECOM_RECV_PACKET_LEN;
+    double ms_per_byte = (1e3 * RTE_BENCH_BITS_PER_CHAR) / bench.baud_rate;
+
+    printf("%s,%u,%u,%u,%u,%.1f,%.2f,%.2f,%.2f,%u\n", p_name, (unsigned)RTE_BENCH_WORDS,
+           commands, compressed, raw, (100.0 * compressed) / raw, compressed * ms_per_byte,
+           raw * ms_per_byte, (double)cpu_time / RTE_BENCH_WORDS, errors);
+}
+
+
+/***
+ * @brief Load a binary snapshot file to the g_rtedbg.
+ *
+ * @return 0 - OK, 1 - file not found
+ */
+
+static uint32_t rte_bench_load(const char *p_file)
+{
+    FILE *p_in = fopen(p_file, "rb");
+    if (p_in == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", p_file);
+        return 1U;
+    }
+
+    memset(&g_rtedbg, 0xFF, sizeof(g_rtedbg));
+    size_t size = fread(&g_rtedbg, 1U, sizeof(g_rtedbg), p_in);
+    if (fgetc(p_in) != EOF)
+    {
+        fprintf(stderr, "%s: truncated to %u bytes - build with a larger RTE_BUFFER_SIZE\n",
+                p_file, (unsigned)sizeof(g_rtedbg));
+    }
+    else if (size < sizeof(g_rtedbg))
+    {
+        fprintf(stderr, "%s: %u bytes - the rest of g_rtedbg is erased\n", p_file, (unsigned)size);
+    }
+    fclose(p_in);
+    return 0U;
+}
+
+
+/***
+ * @brief Log messages similar to the demo firmware.
+ *
+ * @param no_words  Number of circular buffer words to be written
+ */
+
+static void rte_bench_log(uint32_t no_words)
+{
+    uint32_t words = 0U;
+
+    for (uint32_t i = 0U; words < no_words; i++)
+    {
+        if ((i & 7U) == 0U)
+        {
+            RTE_MSG0(MSG0_IWDG_RELOAD, F_COM_DEMO);
+            words += 1U;
+        }
+        else
+        {
+            RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i * 13U);
+            words += 2U;
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    bench.baud_rate = 1500000U;
+    bench.repeat = 20U;
+    while ((opt = getopt(argc, argv, "b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                bench.baud_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                bench.repeat = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-b baud_rate] [-n repeat] [Data.bin ...]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((bench.baud_rate == 0U) || (bench.repeat == 0U))
+    {
+        return 1;
+    }
+
+    printf("# RTE_BUFFER_SIZE=%u RTECOM_COMPRESS_BUFFER_SIZE=%u baud_rate=%u\n",
+           (unsigned)RTE_BUFFER_SIZE, (unsigned)RTECOM_COMPRESS_BUFFER_SIZE, bench.baud_rate);
+    printf("# input,words,commands,compressed_bytes,raw_bytes,compressed_pct,"
+           "compressed_ms,raw_ms,cpu_ns_per_word,errors\n");
+
+    if (optind < argc)
+    {
+        for (int i = optind; i < argc; i++)
+        {
+            if (rte_bench_load(argv[i]) != 0U)
+            {
+                bench.errors++;
+                continue;
+            }
+            rte_bench_input(argv[i]);
+        }
+    }
+    else
+    {
+        rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+        rte_bench_input("empty");
+        rte_bench_log(RTE_BUFFER_SIZE / 2U);
+        rte_bench_input("half_full");
+        rte_bench_log(RTE_BUFFER_SIZE + (RTE_BUFFER_SIZE / 4U));
+        rte_bench_input("full");
+    }
+
+    return (bench.errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_dma_test.c
+ * @author  Branko Premzel
+ * @brief   Test of the DMA transmit queue of the STM32 serial driver.
+ *
+ *          The RTEcomLib/Portable/rte_com_STM32_driver.h is compiled with the
+ *          mock of the LL_DMA and LL_USART functions (rte_stm32_mock.c). The
+ *          host commands are processed by the rte_com_byte_received() and the
+ *          DMA transfers are completed after the command has been executed -
+ *          as on the target, where the response is sent after the interrupt
+ *          handler returns. For every case the response is compared with the
+ *          g_rtedbg data and the number of DMA transfers is checked:
+ *          *) the transfer of a block must not be restarted before it is complete,
+ *          *) the longest responses (RTECOM_READ_CHUNK, RTECOM_BATCH with the max.
+ *             number of long and short sub-commands) must fit into the queue,
+ *          *) every word is received once by the RTECOM_READ_NEW requests while the
+ *             logging wraps around, and an overrun of the host is reported,
+ *          *) a RTECOM_WRITE_RTEDBG after a block sent directly from the g_rtedbg in
+ *             the same batch must be executed only after the block has been sent,
+ *          *) RTECOM_SWAP_BANKS (build with -DRTE_DUAL_BANK_ENABLED=1) must return
+ *             NACK while the frozen bank is still being sent - by the previous
+ *             response or by a block of the same batch - since it would be erased,
+ *          *) if the host sends a command before it has received the response
+ *             to the previous one, the driver must not wait for the DMA (the
+ *             test would hang) - the blocks that do not fit are discarded.
+ *
+ *          The results are printed in the CSV format. The exit code is 1 if
+ *          any error has been found.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -no-pie -DRTE_HOST_BUILD -DRTE_STM32_MOCK -IHost/Emulator -IHost
+ *              -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c RTEcomLib/rte_com.c
+ *              Host/rte_com_chunk.c Host/Emulator/rte_stm32_mock.c
+ *              Host/Emulator/rte_com_dma_test.c -o rte_com_dma_test
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com.h"
+#include "rte_com_demo_fmt.h"
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+#include "rte_com_chunk.h"
+#endif
+
+#define RTE_TEST_RESPONSE_SIZE  (2U * sizeof(g_rtedbg) + 256U)
+#define RTE_TEST_LONG_READ      256U    // Size of the long reads (larger than the RTECOM_BATCH_COPY_SIZE)
+#define RTE_TEST_MSG4_ID        16U     // Format ID of the five-word messages (not decoded)
+
+volatile uint32_t uwTick;
+uint32_t uwTick_last_byte_received;
+
+static uint8_t response[RTE_TEST_RESPONSE_SIZE];    // Data sent by the DMA
+static uint8_t expected[RTE_TEST_RESPONSE_SIZE];
+static uint32_t expected_size;
+static uint32_t errors;
+
+
+/***
+ * @brief Send a 10-byte message to the rte_com (byte received interrupt for each byte).
+ */
+
+static void rte_test_message(uint8_t command, uint32_t address, uint32_t data)
+{
+    uint8_t frame[RTECOM_RECV_PACKET_LEN];
+    uint8_t checksum = RTECOM_CHECKSUM;
+
+    frame[0] = command;
+    memcpy(&frame[2], &address, 4U);
+    memcpy(&frame[6], &data, 4U);
+    for (uint32_t i = 2U; i < RTECOM_RECV_PACKET_LEN; i++)
+    {
+        checksum ^= frame[i];
+    }
+    frame[1] = checksum;
+
+    for (uint32_t i = 0U; i < RTECOM_RECV_PACKET_LEN; i++)
+    {
+        rte_com_byte_received(frame[i], 0U);
+    }
+}
+
+
+/***
+ * @brief Complete all queued DMA transfers.
+ *
+ * @return Number of DMA transfers
+ */
+
+static uint32_t rte_test_run_dma(void)
+{
+    uint32_t no_blocks = 0U;
+
+    while (rte_mock_tx_run() != 0U)
+    {
+        no_blocks++;
+    }
+
+    return no_blocks;
+}
+
+
+/***
+ * @brief Add data to the expected response.
+ */
+
+static void rte_test_expect(const void *p_data, uint32_t size)
+{
+    memcpy(&expected[expected_size], p_data, size);
+    expected_size += size;
+}
+
+
+/***
+ * @brief Compare the response with the expected one and print the result (CSV).
+ *
+ * @param p_name      Name of the test case
+ * @param no_blocks   Number of DMA transfers of the response
+ * @param max_blocks  Max. allowed number of DMA transfers
+ */
+
+static void rte_test_check(const char *p_name, uint32_t no_blocks, uint32_t max_blocks)
+{
+    uint32_t case_errors = 0U;
+
+    if ((g_rte_mock.tx_size != expected_size) || (memcmp(response, expected, expected_size) != 0))
+    {
+        fprintf(stderr, "%s: response not OK (%u bytes instead of %u)\n",
+                p_name, g_rte_mock.tx_size, expected_size);
+        case_errors++;
+    }
+
+    if (no_blocks > max_blocks)
+    {
+        fprintf(stderr, "%s: %u DMA transfers (max. %u)\n", p_name, no_blocks, max_blocks);
+        case_errors++;
+    }
+
+    if (g_rte_mock.tx_restarts != 0U)
+    {
+        fprintf(stderr, "%s: %u transfers restarted before they were complete\n",
+                p_name, g_rte_mock.tx_restarts);
+        case_errors++;
+    }
+
+    printf("%s,%u,%u,%u,%u\n", p_name, no_blocks, max_blocks, g_rte_mock.tx_size, case_errors);
+    errors += case_errors;
+    g_rte_mock.tx_size = 0U;
+    g_rte_mock.tx_restarts = 0U;
+    expected_size = 0U;
+}
+
+
+/***
+ * @brief Log messages to fill the circular buffer with data.
+ */
+
+static void rte_test_log(uint32_t no_messages)
+{
+    for (uint32_t i = 0U; i < no_messages; i++)
+    {
+        RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i * 0x10001U);
+    }
+}
+
+
+static void rte_test_read(void)
+{
+    const uint8_t ack = RTECOM_CHECKSUM;
+
+    rte_test_message(RTECOM_WRITE_RTEDBG, 1U, 0U);      // Stop logging
+    rte_test_expect(&ack, 1U);
+    rte_test_check("write_rtedbg", rte_test_run_dma(), 1U);
+
+    rte_test_message(RTECOM_READ_RTEDBG, 0U, sizeof(g_rtedbg));
+    rte_test_expect(&g_rtedbg, sizeof(g_rtedbg));
+    rte_test_check("read_rtedbg", rte_test_run_dma(), 1U);
+}
+
+
+#if RTECOM_STREAMING_ENABLED == 1
+static void rte_test_read_new(void)
+{
+    uint32_t next_index = g_rtedbg.buf_index;
+    RTE_LIMIT_INDEX(next_index)
+
+    rte_test_message(RTECOM_READ_NEW, 0U, RTE_BUFFER_SIZE + 4U);
+    rte_test_expect(&next_index, 4U);
+    rte_test_expect(g_rtedbg.buffer, next_index * 4U);
+    rte_test_check("read_new", rte_test_run_dma(), 2U);
+}
+
+
+static uint32_t poll_blocks;        // Number of DMA transfers of the RTECOM_READ_NEW responses
+static uint32_t poll_bytes;         // Number of bytes received
+static uint32_t no_polls;
+
+/***
+ * @brief Send the RTECOM_READ_NEW request and return the next index from the response.
+ *
+ * @param index       Index of the first word not yet received
+ * @param p_received  Number of words received is added to it
+ */
+
+static uint32_t rte_test_poll(uint32_t index, uint32_t *p_received)
+{
+    uint32_t next_index = 0U;
+
+    rte_test_message(RTECOM_READ_NEW, index, RTE_BUFFER_SIZE + 4U);
+    poll_blocks += rte_test_run_dma();
+    poll_bytes += g_rte_mock.tx_size;
+    no_polls++;
+    if (g_rte_mock.tx_size >= 4U)
+    {
+        memcpy(&next_index, response, 4U);
+        *p_received += (g_rte_mock.tx_size - 4U) / 4U;
+    }
+    g_rte_mock.tx_size = 0U;
+
+    return next_index;
+}
+
+
+/***
+ * @brief Stream the data with the RTECOM_READ_NEW while the logging wraps around several
+ *        times. Messages with two and five words are logged, so that the subpackets spill
+ *        into the trailer at different positions. Every logged word must be received
+ *        exactly once. Then more than a buffer lap is logged between two requests -
+ *        the overrun must be reported.
+ */
+
+static void rte_test_read_new_wrap(void)
+{
+    uint32_t case_errors = 0U;
+    uint32_t received = 0U;
+    uint32_t logged = 0U;
+    uint32_t overruns = 0U;
+
+    g_rtedbg.filter = 0xFFFFFFFFU;
+    uint32_t index = rte_test_poll(0U, &received);     // Start at the current buffer index
+    received = 0U;
+
+    for (uint32_t n = 0U; n < 200U; n++)
+    {
+        for (uint32_t i = 0U; i <= (n % 7U); i++)
+        {
+            RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i);
+            RTE_MSG4(RTE_TEST_MSG4_ID, F_COM_DEMO, i, n, i, n);
+            logged += 7U;
+        }
+        index = rte_test_poll(index, &received);
+        overruns += index >> 31U;
+        index &= ~RTECOM_STREAM_OVERRUN;
+    }
+    for (uint32_t n = 0U; n < 2U; n++)
+    {
+        index = rte_test_poll(index, &received);    // Rest of the words after a wrap-around
+    }
+
+    if ((received != logged) || (overruns != 0U))
+    {
+        fprintf(stderr, "read_new_wrap: %u words received, %u logged, %u overruns\n",
+                received, logged, overruns);
+        case_errors++;
+    }
+
+    // Overrun - log more than one buffer lap between two requests
+    rte_test_log(((uint32_t)(RTE_BUFFER_SIZE) / 2U) + 10U);
+    uint32_t next_index = rte_test_poll(index, &received);
+    if ((next_index & RTECOM_STREAM_OVERRUN) == 0U)
+    {
+        fprintf(stderr, "read_new_wrap: overrun not reported\n");
+        case_errors++;
+    }
+    else if ((next_index & ~RTECOM_STREAM_OVERRUN) > 4U)
+    {
+        // The oldest data up to the end of the buffer lap must have been sent
+        fprintf(stderr, "read_new_wrap: next index 0x%08X after the overrun\n", next_index);
+        case_errors++;
+    }
+
+    g_rtedbg.filter = 0U;
+    printf("read_new_wrap,%u,%u,%u,%u\n", poll_blocks, 2U * no_polls, poll_bytes, case_errors);
+    errors += case_errors;
+}
+#endif
+
+
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+static void rte_test_read_chunk(void)
+{
+    const uint32_t offset = RTE_HEADER_SIZE;
+    const uint32_t size = RTE_TEST_LONG_READ;
+    const uint32_t sequence = 7U;
+    uint32_t header[2] = {offset, sequence | (size << 16U)};  // rtecom_chunk_t
+
+    rte_test_message(RTECOM_READ_CHUNK, offset, (sequence << 16U) | size);
+    rte_test_expect(header, sizeof(header));
+    rte_test_expect(((const uint8_t *)&g_rtedbg) + offset, size);
+    uint32_t checksum = rte_com_chunk_checksum(0U, (const uint8_t *)header, sizeof(header));
+    checksum = rte_com_chunk_checksum(checksum, ((const uint8_t *)&g_rtedbg) + offset, size);
+    rte_test_expect(&checksum, 4U);
+    rte_test_check("read_chunk", rte_test_run_dma(), 3U);
+}
+#endif
+
+
+#if RTECOM_BATCH_ENABLED == 1
+/***
+ * @brief Batch with the max. number of sub-commands - short (copied) and long (sent directly
+ *        from the g_rtedbg) reads alternate. This is the response with the most DMA blocks.
+ */
+
+static void rte_test_batch(void)
+{
+    uint8_t commands[RTECOM_BATCH_MAX_COMMANDS * RTECOM_BATCH_CMD_LEN];
+    uint8_t checksum = 0U;
+
+    for (uint32_t i = 0U; i < RTECOM_BATCH_MAX_COMMANDS; i++)
+    {
+        uint32_t address = (i & 1U) ? (RTE_HEADER_SIZE + (i * 4U)) : 4U;
+        uint32_t size = (i & 1U) ? RTE_TEST_LONG_READ : 4U;
+        uint8_t *p_cmd = &commands[i * RTECOM_BATCH_CMD_LEN];
+        p_cmd[0] = RTECOM_READ_RTEDBG;
+        memcpy(&p_cmd[1], &address, 4U);
+        memcpy(&p_cmd[5], &size, 4U);
+        rte_test_expect(((const uint8_t *)&g_rtedbg) + address, size);
+    }
+
+    for (uint32_t i = 0U; i < sizeof(commands); i++)
+    {
+        checksum ^= commands[i];
+    }
+
+    rte_test_message(RTECOM_BATCH, RTECOM_BATCH_MAX_COMMANDS, checksum);
+    for (uint32_t i = 0U; i < sizeof(commands); i++)
+    {
+        rte_com_byte_received(commands[i], 0U);
+    }
+    rte_test_check("batch", rte_test_run_dma(), RTECOM_BATCH_MAX_COMMANDS + 1U);
+}
+
+
+/***
+ * @brief Snapshot batch: read filter, stop logging, read header and buffer, restore filter.
+ *        The filter must be restored only after the buffer has been sent, since it is sent
+ *        after the batch has been executed.
+ */
+
+static void rte_test_batch_restore(void)
+{
+    static const uint32_t sub_commands[][3] =
+    {
+        {RTECOM_READ_RTEDBG, 4U, 4U},
+        {RTECOM_WRITE_RTEDBG, 1U, 0U},
+        {RTECOM_READ_RTEDBG, 0U, RTE_HEADER_SIZE},
+        {RTECOM_READ_RTEDBG, RTE_HEADER_SIZE, sizeof(g_rtedbg.buffer)},
+        {RTECOM_WRITE_RTEDBG, 1U, 0xFFFFFFFFU},
+    };
+    const uint32_t no_commands = sizeof(sub_commands) / sizeof(sub_commands[0]);
+    uint8_t commands[sizeof(sub_commands) / sizeof(sub_commands[0]) * RTECOM_BATCH_CMD_LEN];
+    const uint8_t ack = RTECOM_CHECKSUM;
+    const uint32_t filter = 0x12345678U;
+    uint8_t checksum = 0U;
+
+    g_rtedbg.filter = 0U;
+    rte_test_expect(&filter, 4U);
+    rte_test_expect(&ack, 1U);
+    rte_test_expect(&g_rtedbg, RTE_HEADER_SIZE);
+    g_rtedbg.filter = filter;
+    rte_test_expect(g_rtedbg.buffer, sizeof(g_rtedbg.buffer));
+    rte_test_expect(&ack, 1U);
+
+    for (uint32_t i = 0U; i < no_commands; i++)
+    {
+        uint8_t *p_cmd = &commands[i * RTECOM_BATCH_CMD_LEN];
+        p_cmd[0] = (uint8_t)sub_commands[i][0];
+        memcpy(&p_cmd[1], &sub_commands[i][1], 4U);
+        memcpy(&p_cmd[5], &sub_commands[i][2], 4U);
+    }
+    for (uint32_t i = 0U; i < sizeof(commands); i++)
+    {
+        checksum ^= commands[i];
+    }
+
+    rte_test_message(RTECOM_BATCH, no_commands, checksum);
+    for (uint32_t i = 0U; i < sizeof(commands); i++)
+    {
+        rte_com_byte_received(commands[i], 0U);
+    }
+
+    if (g_rtedbg.filter != 0U)
+    {
+        fprintf(stderr, "batch_restore: filter restored before the buffer has been sent\n");
+        errors++;
+    }
+    rte_test_check("batch_restore", rte_test_run_dma(), 3U);
+    if (g_rtedbg.filter != 0xFFFFFFFFU)
+    {
+        fprintf(stderr, "batch_restore: filter not restored after the buffer has been sent\n");
+        errors++;
+    }
+    g_rtedbg.filter = 0U;
+}
+#endif
+
+
+#if RTE_DUAL_BANK_ENABLED == 1
+/***
+ * @brief Send a batch of sub-commands (command, address, data).
+ */
+
+static void rte_test_send_batch(const uint32_t (*p_sub_commands)[3], uint32_t no_commands)
+{
+    uint8_t commands[RTECOM_BATCH_MAX_COMMANDS * RTECOM_BATCH_CMD_LEN];
+    uint8_t checksum = 0U;
+
+    for (uint32_t i = 0U; i < no_commands; i++)
+    {
+        uint8_t *p_cmd = &commands[i * RTECOM_BATCH_CMD_LEN];
+        p_cmd[0] = (uint8_t)p_sub_commands[i][0];
+        memcpy(&p_cmd[1], &p_sub_commands[i][1], 4U);
+        memcpy(&p_cmd[5], &p_sub_commands[i][2], 4U);
+    }
+    for (uint32_t i = 0U; i < (no_commands * RTECOM_BATCH_CMD_LEN); i++)
+    {
+        checksum ^= commands[i];
+    }
+
+    rte_test_message(RTECOM_BATCH, no_commands, checksum);
+    for (uint32_t i = 0U; i < (no_commands * RTECOM_BATCH_CMD_LEN); i++)
+    {
+        rte_com_byte_received(commands[i], 0U);
+    }
+}
+
+
+/***
+ * @brief The bank frozen by the swap is read while the logging continues. The next swap
+ *        would erase it - NACK is expected until its transfer is complete.
+ */
+
+static void rte_test_swap_banks(void)
+{
+    const uint8_t nack = RTECOM_SWAP_BANKS;
+    uint8_t frozen = (g_rte_active_bank == &g_rtedbg) ? 0U : 1U;
+
+    rte_test_message(RTECOM_SWAP_BANKS, 0U, 0U);
+    rte_test_expect(&frozen, 1U);
+    rte_test_check("swap_banks", rte_test_run_dma(), 1U);
+    rte_test_log(RTE_BUFFER_SIZE / 8U);     // Logged to the other bank
+
+    // The next swap arrives before the frozen bank has been sent
+    const rtedbg_t *p_frozen = rte_context(frozen);
+    uint32_t address = ((uint32_t)frozen << 24U) + RTE_HEADER_SIZE;
+    rte_test_expect(p_frozen->buffer, sizeof(p_frozen->buffer));
+    rte_test_message(RTECOM_READ_RTEDBG, address, sizeof(p_frozen->buffer));
+    rte_test_message(RTECOM_SWAP_BANKS, 0U, 0U);
+    rte_test_expect(&nack, 1U);
+    rte_test_check("swap_banks_busy", rte_test_run_dma(), 2U);
+
+#if RTECOM_BATCH_ENABLED == 1
+    // Read the frozen bank and swap in the same batch
+    const uint32_t sub_commands[][3] =
+    {
+        {RTECOM_READ_RTEDBG, address, sizeof(p_frozen->buffer)},
+        {RTECOM_SWAP_BANKS, 0U, 0U},
+    };
+    rte_test_expect(p_frozen->buffer, sizeof(p_frozen->buffer));
+    rte_test_expect(&nack, 1U);
+    rte_test_send_batch(sub_commands, sizeof(sub_commands) / sizeof(sub_commands[0]));
+    rte_test_check("swap_banks_batch", rte_test_run_dma(), 2U);
+#endif
+
+    // The swap is executed after the transfer is complete
+    rte_test_message(RTECOM_SWAP_BANKS, 0U, 0U);
+    frozen ^= 1U;
+    rte_test_expect(&frozen, 1U);
+    rte_test_check("swap_banks_idle", rte_test_run_dma(), 1U);
+}
+#endif
+
+
+/***
+ * @brief The host sends commands without waiting for the responses. The driver must not
+ *        wait for the end of the DMA transfers. The first response must be complete.
+ */
+
+static void rte_test_no_wait(void)
+{
+    for (uint32_t i = 0U; i < 256U; i++)
+    {
+        rte_test_message(RTECOM_READ_RTEDBG, 0U, RTE_TEST_LONG_READ);
+    }
+
+    rte_test_expect(&g_rtedbg, RTE_TEST_LONG_READ);
+    uint32_t no_blocks = rte_test_run_dma();
+    if ((g_rte_mock.tx_size >= expected_size) && (g_rte_mock.tx_size <= (256U * RTE_TEST_LONG_READ)))
+    {
+        g_rte_mock.tx_size = expected_size;     // Check only the first response
+    }
+    rte_test_check("no_wait", no_blocks, 256U);
+}
+
+
+int main(void)
+{
+    g_rte_mock.p_tx_data = response;
+    g_rte_mock.tx_data_size = sizeof(response);
+
+    if ((uintptr_t)&g_rtedbg > 0xFFFFFFFFU)
+    {
+        fprintf(stderr, "The data is not in the lower 4 GB - link with -no-pie\n");
+        return 1;
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    rte_test_log(RTE_BUFFER_SIZE / 8U);
+
+    printf("# case,dma_transfers,max_transfers,response_bytes,errors\n");
+    rte_test_read();
+#if RTECOM_STREAMING_ENABLED == 1
+    rte_test_read_new();
+    rte_test_read_new_wrap();
+#endif
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+    rte_test_read_chunk();
+#endif
+#if RTECOM_BATCH_ENABLED == 1
+    rte_test_batch();
+    rte_test_batch_restore();
+#endif
+#if RTE_DUAL_BANK_ENABLED == 1
+    rte_test_swap_banks();
+#endif
+    rte_test_no_wait();
+
+    return (errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
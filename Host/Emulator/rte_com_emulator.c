@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_emulator.c
+ * @author  Branko Premzel
+ * @brief   Emulator of an embedded system with the RTEcomLib serial interface.
+ *
+ *          The real rte_com.c state machine and the RTEdbg library are executed
+ *          on the host (Linux) behind a pseudo-terminal. Host applications open
+ *          the pseudo-terminal (path printed at startup) as a serial port.
+ *          *) The transfer time of the emulated serial channel is added for
+ *             the received and transmitted data (-b baud rate option).
+ *          *) Reception errors (framing/parity) can be injected (-e option).
+ *          *) Build with -DRTECOM_SINGLE_WIRE=1 to emulate the single-wire
+ *             mode. The host then receives its own data (echo) and the
+ *             rte_com receives the data it sends, as on a real single-wire line.
+ *          The demo messages are logged periodically (see rte_com_demo_fmt.h).
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -IHost/Emulator -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib
+ *              RTEdbg/rtedbg.c RTEcomLib/rte_com.c Host/Emulator/rte_com_emulator.c
+ *              -o rte_com_emulator
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg.h"
+#include "rte_com.h"
+#include "rte_com_demo_fmt.h"
+
+#define RTE_EMU_BITS_PER_CHAR   10U     // Start bit + 8 data bits + stop bit
+#define RTE_EMU_ECHO_SIZE       65536U  // Size of the buffer for the single-wire echo data
+
+volatile uint32_t uwTick;               // Time [ms]
+uint32_t uwTick_last_byte_received;     // Time of the last byte received from host
+
+typedef struct
+{
+    int fd;                     // Pseudo-terminal master file descriptor
+    uint32_t baud_rate;         // Emulated baud rate (0 = no transfer time)
+    uint32_t error_rate;        // One of 'error_rate' received bytes has an error (0 = none)
+    uint64_t line_free;         // Time when the emulated line becomes free [ns]
+    uint32_t bytes_received;    // Statistics
+    uint32_t bytes_sent;
+    uint32_t errors_injected;
+#if RTECOM_SINGLE_WIRE == 1
+    uint8_t echo[RTE_EMU_ECHO_SIZE];    // Data sent by rte_com - received by itself
+    uint32_t echo_size;
+#endif
+} rte_emu_t;
+
+static rte_emu_t emu;
+static volatile sig_atomic_t emu_exit;
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_emu_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/***
+ * @brief Wait for the transfer of data over the emulated serial line.
+ *
+ * @param no_bytes  Number of bytes transferred
+ */
+
+static void rte_emu_line_transfer(uint32_t no_bytes)
+{
+    if (emu.baud_rate == 0U)
+    {
+        return;
+    }
+
+    uint64_t now = rte_emu_time();
+    if (emu.line_free < now)
+    {
+        emu.line_free = now;
+    }
+
+    emu.line_free += ((uint64_t)no_bytes * RTE_EMU_BITS_PER_CHAR * 1000000000U) / emu.baud_rate;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(emu.line_free / 1000000000U);
+    ts.tv_nsec = (long)(emu.line_free % 1000000000U);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+        if (emu_exit)
+        {
+            break;
+        }
+    }
+}
+
+
+/***
+ * @brief Write all data to the pseudo-terminal.
+ */
+
+static void rte_emu_write(const uint8_t *p_data, uint32_t size)
+{
+    while (size > 0U)
+    {
+        ssize_t written = write(emu.fd, p_data, size);
+        if (written < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EINTR))
+            {
+                struct pollfd pfd = { emu.fd, POLLOUT, 0 };
+                (void)poll(&pfd, 1, 10);
+                continue;
+            }
+            perror("write");
+            return;
+        }
+        p_data += written;
+        size -= (uint32_t)written;
+    }
+}
+
+
+/***
+ * @brief Send data to the host - called by the rte_com_send_data().
+ *
+ * @param p_data  Pointer to the data to be sent
+ * @param size    Number of bytes to send
+ */
+
+void rte_emu_send(const uint8_t *p_data, uint32_t size)
+{
+    rte_emu_line_transfer(size);
+    rte_emu_write(p_data, size);
+    emu.bytes_sent += size;
+
+#if RTECOM_SINGLE_WIRE == 1
+    // The data sent is received after the command execution is finished (g_rtecom.no_received set)
+    if (size > (RTE_EMU_ECHO_SIZE - emu.echo_size))
+    {
+        size = RTE_EMU_ECHO_SIZE - emu.echo_size;
+    }
+    memcpy(&emu.echo[emu.echo_size], p_data, size);
+    emu.echo_size += size;
+#endif
+}
+
+
+/***
+ * @brief Pass the data received from the host to the rte_com and inject reception errors.
+ */
+
+static void rte_emu_receive(const uint8_t *p_data, uint32_t size)
+{
+    rte_emu_line_transfer(size);
+    emu.bytes_received += size;
+
+#if RTECOM_SINGLE_WIRE == 1
+    rte_emu_write(p_data, size);        // The host receives its own data
+#endif
+
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        uint8_t data = p_data[i];
+        uint32_t errors = 0U;
+
+        if ((emu.error_rate != 0U) && (((uint32_t)rand() % emu.error_rate) == 0U))
+        {
+            data ^= (uint8_t)(1U << ((uint32_t)rand() & 7U));   // Corrupted data
+            errors = 1U;                                        // Framing or parity error
+            emu.errors_injected++;
+        }
+
+        rte_com_byte_received(data, errors);
+
+#if RTECOM_SINGLE_WIRE == 1
+        uint32_t echo_size = emu.echo_size;
+        emu.echo_size = 0U;
+        for (uint32_t j = 0U; j < echo_size; j++)
+        {
+            rte_com_byte_received(emu.echo[j], 0U);
+        }
+#endif
+    }
+}
+
+
+/***
+ * @brief Open the pseudo-terminal and set the raw mode for the slave side.
+ *
+ * @param p_slave_fd  Slave side file descriptor (kept open, so that the master side
+ *                    does not report a hang-up when the host application closes the port)
+ *
+ * @return Master side file descriptor or -1 in case of an error
+ */
+
+static int rte_emu_open_pty(int *p_slave_fd)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0))
+    {
+        perror("posix_openpt");
+        return -1;
+    }
+
+    const char *p_name = ptsname(fd);
+    *p_slave_fd = open(p_name, O_RDWR | O_NOCTTY);
+    if (*p_slave_fd < 0)
+    {
+        perror(p_name);
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(*p_slave_fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        (void)tcsetattr(*p_slave_fd, TCSANOW, &tio);
+    }
+
+    (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    printf("rte_com emulator - serial port: %s\n", p_name);
+    fflush(stdout);
+    return fd;
+}
+
+
+static void rte_emu_signal(int sig)
+{
+    (void)sig;
+    emu_exit = 1;
+}
+
+
+static void rte_emu_usage(const char *p_name)
+{
+    fprintf(stderr,
+            "Usage: %s [-b baud_rate] [-e error_rate]\n"
+            "  -b  Emulated baud rate (default 1500000, 0 = no transfer time)\n"
+            "  -e  Inject a framing/parity error in one of 'error_rate' received bytes\n",
+            p_name);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    int slave_fd;
+
+    emu.baud_rate = 1500000U;
+    while ((opt = getopt(argc, argv, "b:e:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                emu.baud_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                emu.error_rate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                rte_emu_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    emu.fd = rte_emu_open_pty(&slave_fd);
+    if (emu.fd < 0)
+    {
+        return 1;
+    }
+
+    (void)signal(SIGINT, rte_emu_signal);
+    (void)signal(SIGTERM, rte_emu_signal);
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    uint64_t start_time = rte_emu_time();
+    uint32_t last_tick = 0U;
+    uint32_t count = 0U;
+
+    while (!emu_exit)
+    {
+        struct pollfd pfd = { emu.fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 1) > 0)
+        {
+            uint8_t data[256];
+            ssize_t size = read(emu.fd, data, sizeof(data));
+            if (size > 0)
+            {
+                rte_emu_receive(data, (uint32_t)size);
+            }
+        }
+
+        uwTick = (uint32_t)((rte_emu_time() - start_time) / 1000000U);
+        if (uwTick == last_tick)
+        {
+            continue;
+        }
+        last_tick = uwTick;
+
+        if ((uwTick & 0x3FU) == 0U)         // Every 64 ms
+        {
+            RTE_MSG0(MSG0_IWDG_RELOAD, F_COM_DEMO);
+        }
+
+        if ((uwTick % 1000U) == 0U)         // Every second
+        {
+            count++;
+            RTE_EXT_MSG0_8(EXT_MSG0_8_PUSHBUTTON_PRESSED, F_COM_DEMO, count);
+        }
+
+        // Restart the command reception from host after a timeout - see the main.c
+        if (((uwTick - uwTick_last_byte_received) > RTECOM_TIMEOUT)
+             && (g_rtecom.no_received != 0U))
+        {
+            g_rtecom.no_received = 0U;
+        }
+#if RTECOM_BATCH_ENABLED == 1
+        if (((uwTick - uwTick_last_byte_received) > RTECOM_TIMEOUT)
+             && (g_rtecom_batch.size != 0U))
+        {
+            g_rtecom_batch.size = 0U;
+        }
+#endif
+    }
+
+    printf("Received %u bytes, sent %u bytes, %u errors injected\n",
+           emu.bytes_received, emu.bytes_sent, emu.errors_injected);
+    close(slave_fd);
+    close(emu.fd);
+    return 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_pty_driver.h
+ * @author  Branko Premzel
+ * @brief   Serial driver for the rte_com emulator. The data is sent to the
+ *          pseudo-terminal with the transfer time of the emulated serial
+ *          channel - see the rte_com_emulator.c.
+ ******************************************************************************/
+
+#ifndef RTE_COM_PTY_DRIVER_H
+#define RTE_COM_PTY_DRIVER_H
+
+void rte_emu_send(const uint8_t *p_data, uint32_t size);
+
+
+/***
+ * @brief Send data to the host. The function returns after the data has been
+ *        transferred (the transfer time of the emulated serial channel).
+ *
+ * @param p_data  Pointer to the data to be sent
+ * @param size    Number of bytes to send
+ */
+
+static inline void rte_com_send_data(const uint8_t *p_data, uint32_t size)
+{
+    rte_emu_send(p_data, size);
+}
+
+
+
+/***
+ * @brief Check if the data is still being sent - never, since the rte_com_send_data()
+ *        returns after the transfer.
+ */
+
+static inline uint32_t rte_com_tx_busy(void)
+{
+    return 0U;
+}
+
+#endif  // RTE_COM_PTY_DRIVER_H
+
+/*==== End of file ====*/
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_rx_sim.c
+ * @author  Branko Premzel
+ * @brief   Comparison of the rte_com receive paths: byte received interrupt
+ *          (rte_com_byte_received() for each byte) and DMA reception into a
+ *          circular buffer (RTECOM_DMA_RECEIVE - rte_com_rx_process() called
+ *          at the idle line, half transfer and transfer complete events).
+ *
+ *          The same host sessions are replayed with both paths. The STM32 serial
+ *          driver is compiled with the mock of the LL_DMA and LL_USART functions
+ *          (rte_stm32_mock.c). Sessions:
+ *          *) snapshot - read the filter, stop logging, read the header and the
+ *             circular buffer in blocks, restore the filter,
+ *          *) polling  - RTECOM_READ_NEW requests (RTECOM_STREAMING_ENABLED),
+ *          *) batch    - the snapshot commands in a single RTECOM_BATCH message
+ *             (RTECOM_BATCH_ENABLED),
+ *          *) filter   - message filter writes only.
+ *          For each session and path, the number of receive interrupts and the
+ *          CPU time of the reception and command processing are printed in the
+ *          CSV format. The CPU time does not include the interrupt entry and exit
+ *          of the target (e.g. about 30 CPU cycles on a Cortex-M0+) - multiply it
+ *          with the number of interrupts to compare the paths. Build with -DRTECOM_SINGLE_WIRE=1 for the single-wire mode
+ *          - the own response is also received and skipped. The responses of both
+ *          paths must be of equal size - the exit code is 1 otherwise.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -no-pie -DRTE_HOST_BUILD -DRTE_STM32_MOCK -DRTECOM_DMA_RECEIVE=1
+ *              -IHost/Emulator -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c
+ *              RTEcomLib/rte_com.c Host/Emulator/rte_stm32_mock.c
+ *              Host/Emulator/rte_com_rx_sim.c -o rte_com_rx_sim
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com.h"
+#include "rte_com_demo_fmt.h"
+
+#if RTECOM_DMA_RECEIVE != 1
+#error "Build with -DRTECOM_DMA_RECEIVE=1"
+#endif
+
+#define RTE_SIM_RESPONSE_SIZE  (sizeof(g_rtedbg) + 256U)
+#define RTE_SIM_BYTE_PATH      0U  // rte_com_byte_received() for each byte
+#define RTE_SIM_DMA_PATH       1U  // Circular DMA buffer and rte_com_rx_process()
+
+volatile uint32_t uwTick;
+uint32_t uwTick_last_byte_received;
+
+typedef struct
+{
+    uint32_t messages;          // Number of host messages (commands and batch sub-commands)
+    uint64_t rx_bytes;          // Bytes received (host messages and single-wire echo)
+    uint64_t interrupts;        // Number of receive interrupts
+    uint64_t cpu_time;          // Reception and command processing time [ns]
+    uint64_t tx_bytes;          // Number of response bytes (comparison of the paths)
+} rte_sim_result_t;
+
+static struct
+{
+    uint32_t path;              // RTE_SIM_BYTE_PATH or RTE_SIM_DMA_PATH
+    uint32_t block_size;        // Size of the blocks in which the snapshot is read [bytes]
+    rte_sim_result_t *p_result;
+    uint8_t response[RTE_SIM_RESPONSE_SIZE];
+} sim;
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_sim_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/***
+ * @brief Pass received data to the rte_com with the selected path.
+ *
+ * @param p_data Received data
+ * @param size   Number of bytes
+ */
+
+static void rte_sim_receive(const uint8_t *p_data, uint32_t size)
+{
+    rte_sim_result_t *p_result = sim.p_result;
+    uint64_t start = rte_sim_time();
+
+    if (sim.path == RTE_SIM_BYTE_PATH)
+    {
+        for (uint32_t i = 0U; i < size; i++)
+        {
+            rte_com_byte_received(p_data[i], 0U);
+        }
+        p_result->interrupts += size;
+    }
+    else
+    {
+        uint32_t interrupts = g_rte_mock.rx_interrupts;
+        rte_mock_rx_data(p_data, size, 1U);     // Idle line after the data
+        p_result->interrupts += g_rte_mock.rx_interrupts - interrupts;
+    }
+
+    p_result->cpu_time += rte_sim_time() - start;
+    p_result->rx_bytes += size;
+}
+
+
+/***
+ * @brief Send a host message (and the batch sub-commands that follow it) and complete
+ *        the response transfer. In the single-wire mode, the response is also received.
+ *
+ * @param p_message Message data
+ * @param size      Message size
+ */
+
+static void rte_sim_message(const uint8_t *p_message, uint32_t size)
+{
+    rte_sim_result_t *p_result = sim.p_result;
+
+    p_result->messages++;
+    g_rte_mock.tx_size = 0U;
+    rte_sim_receive(p_message, size);
+    while (rte_mock_tx_run() != 0U)
+    {
+    }
+
+#if RTECOM_SINGLE_WIRE == 1
+    if (g_rte_mock.tx_size != 0U)
+    {
+        rte_sim_receive(sim.response, g_rte_mock.tx_size);  // Echo of the own response
+    }
+#endif
+
+    p_result->tx_bytes += g_rte_mock.tx_size;
+}
+
+
+/***
+ * @brief Prepare a 10-byte host message.
+ */
+
+static void rte_sim_frame(uint8_t *p_frame, uint8_t command, uint32_t address, uint32_t data)
+{
+    uint8_t checksum = RTECOM_CHECKSUM;
+
+    p_frame[0] = command;
+    memcpy(&p_frame[2], &address, 4U);
+    memcpy(&p_frame[6], &data, 4U);
+    for (uint32_t i = 2U; i < RTECOM_RECV_PACKET_LEN; i++)
+    {
+        checksum ^= p_frame[i];
+    }
+    p_frame[1] = checksum;
+}
+
+
+static void rte_sim_command(uint8_t command, uint32_t address, uint32_t data)
+{
+    uint8_t frame[RTECOM_RECV_PACKET_LEN];
+    rte_sim_frame(frame, command, address, data);
+    rte_sim_message(frame, sizeof(frame));
+}
+
+
+/***
+ * @brief Log messages as the firmware does between the host requests.
+ */
+
+static void rte_sim_log(uint32_t no_messages)
+{
+    for (uint32_t i = 0U; i < no_messages; i++)
+    {
+        RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i);
+    }
+}
+
+
+static void rte_sim_snapshot(uint32_t repeat)
+{
+    const uint32_t block_size = sim.block_size;
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_sim_log(RTE_BUFFER_SIZE / 2U);
+        rte_sim_command(RTECOM_READ_RTEDBG, 4U, 4U);
+        rte_sim_command(RTECOM_WRITE_RTEDBG, 1U, 0U);
+        rte_sim_command(RTECOM_READ_RTEDBG, 0U, RTE_HEADER_SIZE);
+        for (uint32_t offset = 0U; offset < sizeof(g_rtedbg.buffer); offset += block_size)
+        {
+            uint32_t size = sizeof(g_rtedbg.buffer) - offset;
+            rte_sim_command(RTECOM_READ_RTEDBG, RTE_HEADER_SIZE + offset,
+                            (size > block_size) ? block_size : size);
+        }
+        rte_sim_command(RTECOM_WRITE_RTEDBG, 1U, 0xFFFFFFFFU);
+    }
+}
+
+
+#if RTECOM_STREAMING_ENABLED == 1
+static void rte_sim_polling(uint32_t repeat)
+{
+    uint32_t index = 0U;
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_sim_log(16U);
+        rte_sim_command(RTECOM_READ_NEW, index, RTE_BUFFER_SIZE + 4U);
+        if (g_rte_mock.tx_size >= 4U)
+        {
+            memcpy(&index, sim.response, 4U);
+            index &= ~RTECOM_STREAM_OVERRUN;
+        }
+    }
+}
+#endif
+
+
+#if RTECOM_BATCH_ENABLED == 1
+static void rte_sim_batch(uint32_t repeat)
+{
+    static const uint32_t sub_commands[][3] =
+    {
+        {RTECOM_READ_RTEDBG, 4U, 4U},
+        {RTECOM_WRITE_RTEDBG, 1U, 0U},
+        {RTECOM_READ_RTEDBG, 0U, RTE_HEADER_SIZE},
+        {RTECOM_READ_RTEDBG, RTE_HEADER_SIZE, sizeof(g_rtedbg.buffer)},
+        {RTECOM_WRITE_RTEDBG, 1U, 0xFFFFFFFFU},
+    };
+    const uint32_t no_commands = sizeof(sub_commands) / sizeof(sub_commands[0]);
+    uint8_t message[RTECOM_RECV_PACKET_LEN + (sizeof(sub_commands) / sizeof(sub_commands[0])) * RTECOM_BATCH_CMD_LEN];
+    uint8_t checksum = 0U;
+
+    for (uint32_t i = 0U; i < no_commands; i++)
+    {
+        uint8_t *p_cmd = &message[RTECOM_RECV_PACKET_LEN + (i * RTECOM_BATCH_CMD_LEN)];
+        p_cmd[0] = (uint8_t)sub_commands[i][0];
+        memcpy(&p_cmd[1], &sub_commands[i][1], 4U);
+        memcpy(&p_cmd[5], &sub_commands[i][2], 4U);
+        for (uint32_t j = 0U; j < RTECOM_BATCH_CMD_LEN; j++)
+        {
+            checksum ^= p_cmd[j];
+        }
+    }
+    rte_sim_frame(message, RTECOM_BATCH, no_commands, checksum);
+
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_sim_log(RTE_BUFFER_SIZE / 2U);
+        rte_sim_message(message, sizeof(message));
+        sim.p_result->messages += no_commands;
+    }
+}
+#endif
+
+
+static void rte_sim_filter(uint32_t repeat)
+{
+    for (uint32_t n = 0U; n < repeat; n++)
+    {
+        rte_sim_command(RTECOM_WRITE_RTEDBG, 1U, (n & 1U) ? 0xFFFFFFFFU : 0x7FFFFFFFU);
+    }
+}
+
+
+/***
+ * @brief Run a session with both receive paths, print the results and compare the responses.
+ *
+ * @return 1 - the responses are not equal, 0 - OK
+ */
+
+static uint32_t rte_sim_session(const char *p_name, void (*session)(uint32_t), uint32_t repeat)
+{
+    static const char * const path_name[] = {"byte_isr", "dma_rx"};
+    rte_sim_result_t result[2];
+
+    for (uint32_t path = 0U; path < 2U; path++)
+    {
+        memset(&result[path], 0, sizeof(result[path]));
+        sim.path = path;
+        sim.p_result = &result[path];
+        rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+        session(repeat);
+
+        printf("%s,%s,%u,%llu,%llu,%llu,%.2f,%.1f\n", p_name, path_name[path], result[path].messages,
+               (unsigned long long)result[path].rx_bytes, (unsigned long long)result[path].tx_bytes,
+               (unsigned long long)result[path].interrupts,
+               (double)result[path].interrupts / result[path].messages,
+               (double)result[path].cpu_time / result[path].messages);
+    }
+
+    // The logged data (timestamps) differs - only the response sizes are compared
+    if (result[0].tx_bytes != result[1].tx_bytes)
+    {
+        fprintf(stderr, "%s: the responses of the receive paths are not equal\n", p_name);
+        return 1U;
+    }
+    return 0U;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t repeat = 100U;
+    uint32_t errors = 0U;
+    int opt;
+
+    sim.block_size = 1024U;
+    while ((opt = getopt(argc, argv, "k:n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'k':
+                sim.block_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                repeat = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-k snapshot_block_size] [-n repeat]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((sim.block_size == 0U) || (repeat == 0U) || ((uintptr_t)&g_rtedbg > 0xFFFFFFFFU))
+    {
+        fprintf(stderr, "Bad parameters or the data is not in the lower 4 GB (link with -no-pie)\n");
+        return 1;
+    }
+
+    g_rte_mock.p_tx_data = sim.response;
+    g_rte_mock.tx_data_size = sizeof(sim.response);
+    rte_com_rx_init();
+
+    printf("# RTECOM_SINGLE_WIRE=%u RTECOM_RX_BUFFER_SIZE=%u\n",
+           (unsigned)RTECOM_SINGLE_WIRE, (unsigned)g_rte_mock.rx_size);
+    printf("# session,path,messages,rx_bytes,tx_bytes,interrupts,interrupts_per_message,cpu_ns_per_message\n");
+    errors += rte_sim_session("snapshot", rte_sim_snapshot, repeat);
+#if RTECOM_STREAMING_ENABLED == 1
+    errors += rte_sim_session("polling", rte_sim_polling, repeat * 10U);
+#endif
+#if RTECOM_BATCH_ENABLED == 1
+    errors += rte_sim_session("batch", rte_sim_batch, repeat);
+#endif
+    errors += rte_sim_session("filter", rte_sim_filter, repeat * 10U);
+
+    return (errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
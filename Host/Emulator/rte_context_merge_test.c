@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_context_merge_test.c
+ * @author  Branko Premzel
+ * @brief   Test of the logging contexts (RTE_NO_OF_CONTEXTS) and the merging of
+ *          their messages by the host decoder (rte_dec_contexts_merged()).
+ *
+ *          Messages with a sequence number are logged to randomly selected
+ *          contexts (see the rte_host_context). The rte_long_timestamp() is
+ *          called from context 0 only - the long timestamp message must be
+ *          copied to the other contexts by the library. All circular buffers
+ *          are overwritten several times (post-mortem logging). The snapshots
+ *          of all contexts are then decoded and merged:
+ *          *) the merged timestamps must not decrease,
+ *          *) the sequence numbers must increase (except for messages with
+ *             the same timestamp),
+ *          *) every context must contain the long timestamp messages and the
+ *             number of merged messages must be equal to the sum of the messages
+ *             decoded from the individual snapshots.
+ *
+ *          The results are printed in the CSV format. The exit code is 1 if an
+ *          error has been found.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -DRTE_NO_OF_CONTEXTS=3 -IHost/Emulator -IHost
+ *              -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c
+ *              Host/Emulator/rte_context_merge_test.c -o rte_context_merge_test
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+#if ((RTE_NO_OF_CONTEXTS) < 2) || (RTE_USE_LONG_TIMESTAMP == 0)
+#error "Build with -DRTE_NO_OF_CONTEXTS=2 (or more) and RTE_USE_LONG_TIMESTAMP = 1"
+#endif
+
+#define RTE_MERGE_MAX_MSGS      ((RTE_NO_OF_CONTEXTS) * (RTE_BUFFER_SIZE))
+#define RTE_MERGE_MAX_REPORTS   10U     // Max. number of reported errors
+
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+uint32_t rte_host_context;      // Context selected for the next message (RTE_CONTEXT_INDEX())
+
+static struct
+{
+    uint32_t errors;
+    uint32_t messages;          // Number of merged messages
+    uint32_t context_msgs[RTE_NO_OF_CONTEXTS];      // Messages per context
+    uint32_t long_timestamps[RTE_NO_OF_CONTEXTS];   // Long timestamp messages per context
+    uint32_t last_seq;
+    uint64_t last_timestamp;
+    uint32_t separate;          // Number of messages decoded from the individual snapshots
+} test;
+
+static rte_decoder_t decoder;
+static rte_dec_context_msg_t merged_msgs[RTE_MERGE_MAX_MSGS];
+static uint32_t merged_data[RTE_MERGE_MAX_MSGS];
+static rte_dec_contexts_t contexts =
+{
+    merged_msgs, RTE_MERGE_MAX_MSGS, merged_data, RTE_MERGE_MAX_MSGS, 0U, 0U, 0U, 0U, 0U, 0U, 0U
+};
+
+
+/***
+ * @brief Report an error (only the first RTE_MERGE_MAX_REPORTS are printed).
+ */
+
+static void rte_merge_error(const char *p_text, uint32_t seq, uint32_t context)
+{
+    if (test.errors++ < RTE_MERGE_MAX_REPORTS)
+    {
+        fprintf(stderr, "%s: sequence %u, context %u\n", p_text, seq, context);
+    }
+}
+
+
+/***
+ * @brief Check the merged messages - called by the decoder.
+ */
+
+static void rte_merge_check(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_user;
+
+    if (p_msg->context >= (uint32_t)(RTE_NO_OF_CONTEXTS))
+    {
+        rte_merge_error("Bad context index", 0U, p_msg->context);
+        return;
+    }
+
+    test.messages++;
+    test.context_msgs[p_msg->context]++;
+    if (p_msg->timestamp < test.last_timestamp)
+    {
+        rte_merge_error("Timestamp decreased", 0U, p_msg->context);
+    }
+
+    if (p_msg->fmt_id == RTE_DEC_LONG_TIMESTAMP_ID)
+    {
+        test.long_timestamps[p_msg->context]++;
+    }
+    else if ((p_msg->fmt_id != MSG1_RESET_CAUSE) || (p_msg->no_words != 1U))
+    {
+        rte_merge_error("Unknown message", 0U, p_msg->context);
+    }
+    else
+    {
+        uint32_t seq = p_msg->data[0];
+        if ((test.last_seq != 0U) && (seq <= test.last_seq)
+            && (p_msg->timestamp != test.last_timestamp))
+        {
+            rte_merge_error("Message out of order", seq, p_msg->context);
+        }
+        test.last_seq = seq;
+    }
+
+    test.last_timestamp = p_msg->timestamp;
+}
+
+
+/***
+ * @brief Count the messages of an individual snapshot - called by the decoder.
+ */
+
+static void rte_merge_count(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_msg;
+    (void)p_user;
+    test.separate++;
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t no_messages = 8U * (uint32_t)(RTE_BUFFER_SIZE);
+    uint32_t interval = 200U;   // Number of messages between the long timestamps
+    uint32_t seed = 1U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                no_messages = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'i':
+                interval = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-n messages] [-i long_timestamp_interval] [-s random_seed]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    if (interval == 0U)
+    {
+        return 1;
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    srand(seed);
+
+    for (uint32_t seq = 1U; seq <= no_messages; seq++)
+    {
+        if ((seq % interval) == 0U)
+        {
+            rte_host_context = 0U;
+            rte_long_timestamp();
+        }
+
+        rte_host_context = (uint32_t)rand() % (uint32_t)(RTE_NO_OF_CONTEXTS);
+        RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, seq);
+    }
+
+    const uint8_t *p_data[RTE_NO_OF_CONTEXTS];
+    size_t size[RTE_NO_OF_CONTEXTS];
+    for (uint32_t context = 0U; context < (uint32_t)(RTE_NO_OF_CONTEXTS); context++)
+    {
+        p_data[context] = (const uint8_t *)rte_context(context);
+        size[context] = sizeof(rtedbg_t);
+        (void)rte_dec_snapshot(&decoder, p_data[context], size[context], rte_merge_count, NULL);
+    }
+
+    if (rte_dec_contexts_merged(&decoder, &contexts, p_data, size, RTE_NO_OF_CONTEXTS,
+                                rte_merge_check, NULL) != RTE_DEC_OK)
+    {
+        rte_merge_error("Bad snapshot header", 0U, 0U);
+    }
+
+    if ((test.messages != test.separate) || (contexts.dropped != 0U))
+    {
+        rte_merge_error("Number of merged messages not correct", test.messages, 0U);
+    }
+
+    printf("# context,messages,long_timestamps\n");
+    for (uint32_t context = 0U; context < (uint32_t)(RTE_NO_OF_CONTEXTS); context++)
+    {
+        printf("%u,%u,%u\n", context, test.context_msgs[context], test.long_timestamps[context]);
+        if ((no_messages >= interval) && (test.long_timestamps[context] == 0U))
+        {
+            rte_merge_error("No long timestamp", 0U, context);
+        }
+    }
+    printf("# messages,errors\n%u,%u\n", test.messages, test.errors);
+
+    return (test.errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_decoder_bench.c
+ * @author  Branko Premzel
+ * @brief   Throughput benchmark of the host decoder (rte_decoder.c).
+ *
+ *          The input is a g_rtedbg snapshot - a binary file given on the command
+ *          line (e.g. a Data.bin file captured with the RTEgetData utility) or
+ *          a full circular buffer generated with a mix of short messages, long
+ *          messages (several subpackets) and strings. The snapshot is decoded
+ *          repeatedly and the fastest repetition is reported:
+ *          *) snapshot  - rte_dec_snapshot() (complete snapshot),
+ *          *) stream_N  - rte_dec_push() with N-byte blocks (as when the data is
+ *             decoded while it is received), followed by the rte_dec_flush().
+ *             The buffer is decoded from its start (not from the oldest data),
+ *             so the number of messages may differ from the snapshot case.
+ *          The number of messages and words decoded, the time per word and the
+ *          throughput [MB/s and messages/s] are printed in the CSV format. The
+ *          throughput should be well above the serial line rate (e.g. 0.15 MB/s
+ *          at 1.5 Mbaud). The exit code is 1 if the number of messages decoded
+ *          by the stream cases depends on the block size or if the throughput is
+ *          lower than the -m limit [MB/s].
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -DRTE_BUFFER_SIZE=65536 -IHost/Emulator -IHost
+ *              -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c
+ *              Host/Emulator/rte_decoder_bench.c -o rte_decoder_bench
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+#define RTE_BENCH_REPEAT    7U      // Number of repetitions of each case (the fastest is reported)
+#define RTE_BENCH_FMT_ID    16U     // Any format ID (the decoder does not use the definitions)
+
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+
+static struct
+{
+    const uint8_t *p_data;      // Snapshot data
+    size_t size;                // Snapshot size [bytes]
+    uint8_t *p_file;            // Snapshot loaded from a file
+    uint32_t repeat;            // Number of decodings per repetition
+    uint32_t messages;          // Messages decoded in the last repetition
+    uint32_t reference;         // Messages decoded by the first stream case
+    double min_throughput;      // Min. throughput [MB/s] (-m)
+    uint32_t errors;
+} bench;
+
+static rte_decoder_t decoder;
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_bench_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+/***
+ * @brief Count the decoded messages - called by the decoder.
+ */
+
+static void rte_bench_callback(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_msg;
+    (void)p_user;
+    bench.messages++;
+}
+
+
+/***
+ * @brief Decode the snapshot with the rte_dec_snapshot().
+ */
+
+static void rte_bench_snapshot(size_t block)
+{
+    (void)block;
+    (void)rte_dec_snapshot(&decoder, bench.p_data, bench.size, rte_bench_callback, NULL);
+}
+
+
+/***
+ * @brief Decode the circular buffer of the snapshot with the rte_dec_push() in blocks.
+ *        The buffer is decoded from the start - as when it is streamed to the host.
+ *
+ * @param block  Block size [bytes]
+ */
+
+static void rte_bench_stream(size_t block)
+{
+    rte_dec_header_t hdr;
+    if (rte_dec_parse_header(&hdr, bench.p_data, bench.size) != RTE_DEC_OK)
+    {
+        return;
+    }
+
+    size_t offset = (size_t)hdr.header_words * 4U;
+    rte_dec_init(&decoder, &hdr, rte_bench_callback, NULL);
+    while (offset < bench.size)
+    {
+        size_t size = ((bench.size - offset) < block) ? (bench.size - offset) : block;
+        rte_dec_push(&decoder, bench.p_data + offset, size);
+        offset += size;
+    }
+    rte_dec_flush(&decoder);
+}
+
+
+/***
+ * @brief Run a case and print the results (CSV).
+ *
+ * @param p_name  Case name
+ * @param decode  Function that decodes the snapshot
+ * @param block   Block size for the decode function [bytes]
+ */
+
+static void rte_bench_run(const char *p_name, void (*decode)(size_t block), size_t block)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t i = 0U; i < RTE_BENCH_REPEAT; i++)
+    {
+        uint64_t start = rte_bench_time();
+        for (uint32_t n = 0U; n < bench.repeat; n++)
+        {
+            bench.messages = 0U;
+            decode(block);
+        }
+        uint64_t time = (rte_bench_time() - start) / bench.repeat;
+        if (time < best)
+        {
+            best = time;
+        }
+    }
+
+    uint32_t words = (uint32_t)(bench.size / 4U);
+    double seconds = (best != 0U) ? ((double)best * 1e-9) : 1e-9;
+    double throughput = ((double)bench.size / seconds) / 1e6;
+    uint32_t errors = 0U;
+
+    // All block sizes must give the same result as the first stream case
+    if (block != 0U)
+    {
+        if (bench.reference == UINT32_MAX)
+        {
+            bench.reference = bench.messages;
+        }
+        else if (bench.messages != bench.reference)
+        {
+            errors = 1U;
+        }
+    }
+
+    if (throughput < bench.min_throughput)
+    {
+        errors = 1U;
+    }
+    bench.errors += errors;
+
+    printf("%s,%u,%u,%.2f,%.1f,%.0f,%u\n", p_name, words, bench.messages,
+           (double)best / words, throughput, (double)bench.messages / seconds, errors);
+}
+
+
+/***
+ * @brief Fill the g_rtedbg with typical messages. The buffer is overwritten once and
+ *        the logging stops in the middle of the buffer (post-mortem snapshot).
+ */
+
+static void rte_bench_log(void)
+{
+    static const char text[] = "Decoder benchmark - string message";
+    uint32_t data[16];
+    uint32_t wrapped = 0U;
+
+    for (uint32_t i = 0U; i < 16U; i++)
+    {
+        data[i] = (i * 0x9E3779B9U) ^ 0x80000001U;  // Also DATA words with the bit 31 set
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    for (uint32_t i = 0U; (wrapped == 0U) || (g_rtedbg.buf_index < ((uint32_t)(RTE_BUFFER_SIZE) / 2U)); i++)
+    {
+        uint32_t index = g_rtedbg.buf_index;
+
+        switch (i & 7U)
+        {
+            case 0U:
+                RTE_MSG0(MSG0_IWDG_RELOAD, F_COM_DEMO);
+                break;
+
+            case 1U:
+            case 2U:
+                RTE_MSG1(MSG1_RESET_CAUSE, F_COM_DEMO, i);
+                break;
+
+            case 3U:
+                RTE_MSG4(RTE_BENCH_FMT_ID, F_COM_DEMO, i, data[1], data[2], data[3]);
+                break;
+
+            case 4U:
+                RTE_MSGN(RTE_BENCH_FMT_ID, F_COM_DEMO, data, (4U * (i % 16U)) + 4U);
+                break;
+
+            case 5U:
+                RTE_STRING(RTE_BENCH_FMT_ID, F_COM_DEMO, text);
+                break;
+
+            case 6U:
+                rte_long_timestamp();
+                break;
+
+            default:
+                RTE_MSG2(RTE_BENCH_FMT_ID, F_COM_DEMO, i, data[i & 15U]);
+                break;
+        }
+
+        if (g_rtedbg.buf_index < index)
+        {
+            wrapped = 1U;
+        }
+    }
+
+    bench.p_data = (const uint8_t *)&g_rtedbg;
+    bench.size = sizeof(g_rtedbg);
+}
+
+
+/***
+ * @brief Load a binary snapshot file.
+ *
+ * @return 0 - OK, 1 - error
+ */
+
+static uint32_t rte_bench_load(const char *p_file)
+{
+    FILE *p_in = fopen(p_file, "rb");
+    if (p_in == NULL)
+    {
+        fprintf(stderr, "Cannot open %s\n", p_file);
+        return 1U;
+    }
+
+    (void)fseek(p_in, 0L, SEEK_END);
+    long size = ftell(p_in);
+    (void)fseek(p_in, 0L, SEEK_SET);
+    if (size > 0L)
+    {
+        bench.p_file = malloc((size_t)size);
+    }
+    if ((bench.p_file == NULL) || (fread(bench.p_file, 1U, (size_t)size, p_in) != (size_t)size))
+    {
+        fprintf(stderr, "Cannot read %s\n", p_file);
+        fclose(p_in);
+        return 1U;
+    }
+
+    fclose(p_in);
+    bench.p_data = bench.p_file;
+    bench.size = (size_t)size;
+    return 0U;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    bench.repeat = 20U;
+    while ((opt = getopt(argc, argv, "n:m:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                bench.repeat = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'm':
+                bench.min_throughput = strtod(optarg, NULL);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-n repeat] [-m min_MB_per_s] [Data.bin]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (bench.repeat == 0U)
+    {
+        return 1;
+    }
+
+    const char *p_input = "generated";
+    if (optind < argc)
+    {
+        p_input = argv[optind];
+        if (rte_bench_load(p_input) != 0U)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        rte_bench_log();
+    }
+
+    rte_dec_header_t hdr;
+    if (rte_dec_parse_header(&hdr, bench.p_data, bench.size) != RTE_DEC_OK)
+    {
+        fprintf(stderr, "%s: invalid g_rtedbg header\n", p_input);
+        free(bench.p_file);
+        return 1;
+    }
+
+    printf("# input=%s size=%u bytes RTE_FMT_ID_BITS=%u\n", p_input, (unsigned)bench.size,
+           hdr.fmt_id_bits);
+    printf("# case,words,messages,ns_per_word,mb_per_s,messages_per_s,errors\n");
+
+    bench.reference = UINT32_MAX;
+    rte_bench_run("snapshot", rte_bench_snapshot, 0U);
+
+    static const uint16_t blocks[] = {1U, 16U, 256U, 4096U};
+    for (uint32_t i = 0U; i < (sizeof(blocks) / sizeof(blocks[0])); i++)
+    {
+        char name[40];
+        snprintf(name, sizeof(name), "stream_%u", blocks[i]);
+        rte_bench_run(name, rte_bench_stream, blocks[i]);
+    }
+
+    free(bench.p_file);
+    return (bench.errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_lock_free_stress.c
+ * @author  Branko Premzel
+ * @brief   Multithreaded stress test of the circular buffer space reservation.
+ *
+ *          Several threads log messages to the g_rtedbg at the same time. Every
+ *          message contains the thread number, a sequence number and data words
+ *          calculated from them. After each round, the circular buffer is decoded
+ *          with the host decoder (rte_decoder.c) and every message is checked:
+ *          *) all DATA words must have the expected values - a message overwritten
+ *             partly by another writer (overlapping reservations) is detected,
+ *          *) every message of every thread must be found exactly once,
+ *          *) the buf_index must have advanced by the total size of the messages,
+ *          *) with the priority region (-DRTE_PRIORITY_BUFFER_SIZE=256), the test
+ *             messages are also copied to it and the priority_index must have
+ *             advanced by the same number of words (no reservation lost).
+ *          Each round starts at a random position near the end of the buffer, so
+ *          the wrap-around of the buffer index is also tested (if the buffer size
+ *          is a power of 2). The buffer is not overwritten within a round (the
+ *          number of messages is limited).
+ *
+ *          Build with -DRTE_HOST_LOCK_FREE to test the rtedbg_generic_lock_free.h
+ *          driver (atomic compare-and-swap). Without it, the spin lock of the
+ *          rtedbg_host_irq_disable.h is used. A larger buffer (e.g.
+ *          -DRTE_BUFFER_SIZE=65536) allows more messages per round.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -pthread -DRTE_HOST_BUILD -DRTE_HOST_LOCK_FREE -IHost/Emulator -IHost
+ *              -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c
+ *              Host/Emulator/rte_lock_free_stress.c -o rte_lock_free_stress
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+#define RTE_STRESS_FMT_ID       16U     // Format ID of the test messages (MSGN)
+#define RTE_STRESS_MAX_THREADS  16U
+#define RTE_STRESS_MAX_WORDS    14U     // Max. number of words of a test message (DATA + FMT)
+
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+
+/* The message lengths are not divisible by four - the last subpacket of every message
+ * is shorter than four words and the decoder cannot join two messages. */
+static const uint8_t rte_stress_lengths[] = {1U, 2U, 3U, 5U, 6U, 7U, 9U, 10U, 11U};
+#define RTE_STRESS_NO_LENGTHS  (sizeof(rte_stress_lengths) / sizeof(rte_stress_lengths[0]))
+
+static uint32_t no_threads = 4U;
+static uint32_t no_messages;                // Number of messages per thread and round
+static pthread_barrier_t start_barrier;     // Start of a round
+static pthread_barrier_t end_barrier;       // End of a round
+static volatile uint32_t stop;              // 1 - the threads exit
+
+static uint8_t *p_seen;                     // Messages found by the decoder [thread][sequence]
+static uint32_t errors;
+static rte_decoder_t decoder;
+
+
+/***
+ * @brief Calculate the DATA words of a test message.
+ *
+ * @param p_data    Buffer for the data words
+ * @param thread    Thread number
+ * @param sequence  Sequence number of the message
+ *
+ * @return Number of DATA words
+ */
+
+static uint32_t rte_stress_message(uint32_t *p_data, uint32_t thread, uint32_t sequence)
+{
+    uint32_t length = rte_stress_lengths[(sequence + thread) % RTE_STRESS_NO_LENGTHS];
+
+    p_data[0] = (thread << 24U) | sequence;
+    for (uint32_t i = 1U; i < length; i++)
+    {
+        // Also sets the bit 31 - moved to the FMT word
+        p_data[i] = (p_data[0] * 0x9E3779B1U) ^ (i * 0x85EBCA77U);
+    }
+
+    return length;
+}
+
+
+/***
+ * @brief Number of circular buffer words of a test message.
+ */
+
+static uint32_t rte_stress_words(uint32_t thread, uint32_t sequence)
+{
+    uint32_t length = rte_stress_lengths[(sequence + thread) % RTE_STRESS_NO_LENGTHS];
+    return length + ((length + 3U) / 4U);
+}
+
+
+static void *rte_stress_thread(void *p_arg)
+{
+    const uint32_t thread = (uint32_t)(uintptr_t)p_arg;
+    uint32_t data[RTE_STRESS_MAX_WORDS];
+
+    for (;;)
+    {
+        (void)pthread_barrier_wait(&start_barrier);
+        if (stop != 0U)
+        {
+            break;
+        }
+
+        for (uint32_t seq = 0U; seq < no_messages; seq++)
+        {
+            uint32_t length = rte_stress_message(data, thread, seq);
+            RTE_MSGN(RTE_STRESS_FMT_ID, F_COM_DEMO, data, length * 4U);
+        }
+
+        (void)pthread_barrier_wait(&end_barrier);
+    }
+
+    return NULL;
+}
+
+
+/***
+ * @brief Check a decoded message - called by the decoder.
+ */
+
+static void rte_stress_check(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    uint32_t data[RTE_STRESS_MAX_WORDS];
+    (void)p_user;
+
+    uint32_t thread = p_msg->data[0] >> 24U;
+    uint32_t seq = p_msg->data[0] & 0x00FFFFFFU;
+
+    if ((p_msg->fmt_id != RTE_STRESS_FMT_ID) || (p_msg->no_words == 0U)
+        || (thread >= no_threads) || (seq >= no_messages))
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "Unknown message: fmt_id %u, %u words, data[0] 0x%08X\n",
+                    p_msg->fmt_id, p_msg->no_words, p_msg->data[0]);
+        }
+        return;
+    }
+
+    uint32_t length = rte_stress_message(data, thread, seq);
+    if ((length != p_msg->no_words) || (memcmp(data, p_msg->data, length * 4U) != 0))
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "Corrupted message: thread %u, sequence %u\n", thread, seq);
+        }
+        return;
+    }
+
+    if (p_seen[(thread * no_messages) + seq]++ != 0U)
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "Duplicated message: thread %u, sequence %u\n", thread, seq);
+        }
+    }
+}
+
+
+/***
+ * @brief Decode the buffer after a round and check that all messages are there.
+ *
+ * @param start  Buffer index at the start of the round
+ * @param words  Number of words logged in the round
+ */
+
+static void rte_stress_check_round(uint32_t start, uint32_t words)
+{
+    memset(p_seen, 0, (size_t)no_threads * no_messages);
+    (void)rte_dec_snapshot(&decoder, (const uint8_t *)&g_rtedbg, sizeof(g_rtedbg),
+                           rte_stress_check, NULL);
+
+    if (decoder.stats.discarded_words != 0U)
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "%u words discarded by the decoder\n", decoder.stats.discarded_words);
+        }
+    }
+
+    for (uint32_t i = 0U; i < (no_threads * no_messages); i++)
+    {
+        if (p_seen[i] == 0U)
+        {
+            if (errors++ < 10U)
+            {
+                fprintf(stderr, "Missing message: thread %u, sequence %u\n",
+                        i / no_messages, i % no_messages);
+            }
+        }
+    }
+
+    // The buf_index is not limited after the last reservation (see RTE_RESERVE_SPACE)
+    uint32_t end = g_rtedbg.buf_index;
+    RTE_LIMIT_INDEX(end)
+    uint32_t expected = start + words;
+    RTE_LIMIT_INDEX(expected)
+    if (end != expected)
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "Buffer index %u instead of %u\n", end, expected);
+        }
+    }
+
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    if (g_rtedbg.priority_index != words)
+    {
+        if (errors++ < 10U)
+        {
+            fprintf(stderr, "Priority index %u instead of %u\n", g_rtedbg.priority_index, words);
+        }
+    }
+#endif
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t no_rounds = 10000U;
+    uint32_t seed = 1U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:r:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                no_threads = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                no_rounds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-t threads] [-r rounds] [-s random_seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if ((no_threads == 0U) || (no_threads > RTE_STRESS_MAX_THREADS))
+    {
+        fprintf(stderr, "1 ... %u threads\n", RTE_STRESS_MAX_THREADS);
+        return 1;
+    }
+
+    // Leave some free space - the buffer must not be overwritten within a round
+    no_messages = ((uint32_t)(RTE_BUFFER_SIZE) - 64U) / (RTE_STRESS_MAX_WORDS * no_threads);
+    p_seen = calloc((size_t)no_threads * no_messages, 1U);
+    if ((no_messages == 0U) || (p_seen == NULL))
+    {
+        return 1;
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    g_rtedbg.priority_filter = 0x80000000U >> F_COM_DEMO;   // Copy the test messages
+#endif
+    srand(seed);
+
+    uint32_t words = 0U;    // Number of words logged in a round
+    for (uint32_t thread = 0U; thread < no_threads; thread++)
+    {
+        for (uint32_t seq = 0U; seq < no_messages; seq++)
+        {
+            words += rte_stress_words(thread, seq);
+        }
+    }
+
+    (void)pthread_barrier_init(&start_barrier, NULL, no_threads + 1U);
+    (void)pthread_barrier_init(&end_barrier, NULL, no_threads + 1U);
+    pthread_t threads[RTE_STRESS_MAX_THREADS];
+    for (uint32_t i = 0U; i < no_threads; i++)
+    {
+        (void)pthread_create(&threads[i], NULL, rte_stress_thread, (void *)(uintptr_t)i);
+    }
+
+    for (uint32_t round = 0U; round < no_rounds; round++)
+    {
+#if RTE_BUFF_SIZE_IS_POWER_OF_2 == 1U
+        // Start near the end of the buffer - the index wraps around during the round
+        uint32_t start = (uint32_t)(RTE_BUFFER_SIZE) - ((uint32_t)rand() % (words + 1U));
+#else
+        /* The subpackets after the trailer continue at the buffer start, where the next
+         * message is written too (see RTE_LIMIT_INDEX()) - test without wrap-around only. */
+        uint32_t start = (uint32_t)rand() % ((uint32_t)(RTE_BUFFER_SIZE) - words + 1U);
+#endif
+        memset(g_rtedbg.buffer, 0xFF, sizeof(g_rtedbg.buffer));
+        g_rtedbg.buf_index = start;
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+        g_rtedbg.priority_index = 0U;
+#endif
+
+        (void)pthread_barrier_wait(&start_barrier);
+        (void)pthread_barrier_wait(&end_barrier);
+
+        rte_stress_check_round(start, words);
+        if (errors != 0U)
+        {
+            fprintf(stderr, "Errors found in round %u\n", round);
+            break;
+        }
+    }
+
+    stop = 1U;
+    (void)pthread_barrier_wait(&start_barrier);
+    for (uint32_t i = 0U; i < no_threads; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+
+    printf("# driver,threads,rounds,messages_per_round,errors\n");
+    printf("%s,%u,%u,%u,%u\n", RTE_CPU_DRIVER, no_threads, no_rounds,
+           no_threads * no_messages, errors);
+    free(p_seen);
+    return (errors != 0U) ? 1 : 0;
+}
+
+/*==== End of file ====*/
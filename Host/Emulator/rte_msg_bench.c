@@ -0,0 +1,757 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_msg_bench.c
+ * @author  Branko Premzel
+ * @brief   Execution time benchmark for the RTEdbg data logging functions.
+ *
+ *          The logging functions of the host build of the rtedbg.c are called
+ *          in a loop and the average execution time per call is measured. Each
+ *          case is repeated several times and the fastest repetition is reported
+ *          to reduce the influence of the other processes running on the host.
+ *          Compare the results of builds with different settings (e.g. with and
+ *          without -DRTE_RATE_LIMIT_ENABLED=1) to find the cost of an option.
+ *          The number of circular buffer words written by one call is also
+ *          reported (0 if the message is discarded). The configuration is printed
+ *          in the first line - build the benchmark with -DRTE_MINIMIZED_CODE_SIZE=0,
+ *          1 and 2 to compare the code size optimization levels.
+ *          Cases:
+ *          *) msg0 ... msg4 - __rte_msg0() ... __rte_msg4() with all filters enabled,
+ *          *) msg0_limited - the rate limiter is enabled for the message group,
+ *             but the limit is not reached (RTE_RATE_LIMIT_ENABLED),
+ *          *) msg0_shed    - all messages are discarded by the rate limiter (the
+ *             rate_shed counter must stop at 0xFFFF),
+ *          *) msg0_filtered - the message group is disabled by the filter,
+ *          *) msgx_N       - __rte_msgx() with an N-byte payload (word aligned),
+ *          *) msgx_N_unaligned - the same with an unaligned payload address,
+ *          *) msgx_old_N   - reference copy of the previous __rte_msgx() that
+ *             assembles all DATA words byte by byte (word aligned payload).
+ *          *) msgn_N       - __rte_msgn() with an N-byte payload (word aligned),
+ *          *) msgn_N_unaligned - the same with an unaligned payload address. Compare
+ *             the builds with -DRTE_HANDLE_UNALIGNED_MEMORY_ACCESS=0 and 1.
+ *          *) msgn_const_N - RTE_MSGN() with a constant size of N = 4, 12 and 16 bytes
+ *             logged with the __rte_msg1() ... __rte_msg4() if RTE_MINIMIZED_CODE_SIZE
+ *             is 0 and unaligned addresses are not handled. Larger constant sizes use
+ *             the __rte_msgn() - see the msgn_N cases,
+ *          *) msgn_generic_N - the same data logged with the generic __rte_msgn().
+ *             The benchmark checks first that both write the same data to the buffer.
+ *          *) frame_copy   - a computed 16-word frame is prepared in a local array
+ *             and logged with the RTE_MSGN(),
+ *          *) frame_writer - the same frame is written directly to the circular buffer
+ *             (RTE_MSG_RESERVE(), rte_writer_put() and rte_msg_commit()),
+ *          *) loop_single  - six messages (RTE_MSG0() ... RTE_MSG4()) logged one by one,
+ *          *) loop_batch   - the same messages logged as a batch (RTE_BATCH_MSG0() ...
+ *             RTE_BATCH_MSG4() and rte_batch_commit()). The benchmark checks first that
+ *             the rte_decoder.c decodes the same messages for both loops,
+ *          *) string_N     - __rte_stringn() with an N-character string (word
+ *             aligned). Compare the builds with -DRTE_SINGLE_PASS_STRINGS=0 and 1.
+ *          The msgx cases are run for selected payload sizes or for all sizes
+ *          from 1 to 255 bytes (option -x). Build without the optional trigger,
+ *          statistics, rate limiter and priority region for a fair comparison
+ *          with the reference copy (it does not contain them).
+ *
+ *          The results are printed in the CSV format.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -IHost/Emulator -IHost -IRTEdbg/Inc -IRTEdbg/Fmt
+ *              -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c Host/Emulator/rte_msg_bench.c
+ *              -o rte_msg_bench
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+// Timer and CPU drivers for the reference copy of the __rte_msgx() - only the inline
+// functions and macros (the library functions and variables are in the rtedbg.c).
+#define RTE_USE_INLINE_FUNCTIONS
+#include RTE_TIMER_DRIVER
+#include RTE_CPU_DRIVER
+
+#define RTE_BENCH_REPEAT  7U    // Number of repetitions of each case (the fastest is reported)
+#define RTE_BENCH_MSGX_ID 16U   // Any format ID for the msgx cases
+
+// Format IDs of the loop_single and loop_batch messages
+#define RTE_BENCH_MSG0_ID 64U
+#define RTE_BENCH_MSG1_ID 66U
+#define RTE_BENCH_MSG2_ID 68U
+#define RTE_BENCH_MSG3_ID 72U
+#define RTE_BENCH_MSG4_ID 80U
+#define RTE_BENCH_LOOP_MSGS 6U  // Number of messages logged per loop iteration
+
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+
+typedef void (*rte_bench_case_t)(uint32_t no_calls);
+
+static uint32_t rte_bench_payload[(RTE_MAX_MSGX_SIZE / 4U) + 1U];  // Payload for the msgx cases
+typedef struct
+{
+    uint32_t no_msgs;           // Number of decoded messages
+    uint32_t fmt_id[RTE_BENCH_LOOP_MSGS];
+    uint32_t no_words[RTE_BENCH_LOOP_MSGS];
+    uint32_t data[RTE_BENCH_LOOP_MSGS][4];
+} rte_bench_loop_t;             // Messages of a loop iteration decoded by the rte_decoder.c
+
+static volatile const uint8_t *rte_bench_address;   // Payload address for the msgx cases
+static uint32_t rte_bench_size;                     // Payload size for the msgx cases
+
+
+/***
+ * @brief Return the monotonic clock time [ns].
+ */
+
+static uint64_t rte_bench_time(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void rte_bench_msg0(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG0(MSG0_IWDG_RELOAD, F_COM_DEMO);
+    }
+}
+
+
+static void rte_bench_msg1(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG1(RTE_BENCH_MSGX_ID, F_COM_DEMO, i);
+    }
+}
+
+
+static void rte_bench_msg2(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG2(RTE_BENCH_MSGX_ID, F_COM_DEMO, i, i + 1U);
+    }
+}
+
+
+static void rte_bench_msg3(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG3(RTE_BENCH_MSGX_ID, F_COM_DEMO, i, i + 1U, i + 2U);
+    }
+}
+
+
+static void rte_bench_msg4(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG4(RTE_BENCH_MSGX_ID, F_COM_DEMO, i, i + 1U, i + 2U, i + 3U);
+    }
+}
+
+
+static void rte_bench_msgn(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSGN(RTE_BENCH_MSGX_ID, F_COM_DEMO, rte_bench_address, rte_bench_size);
+    }
+}
+
+
+/* RTE_MSGN() with a size known at compile time (constant-size specialization) and
+ * the __rte_msgn() called directly with the same size (generic path). */
+#define RTE_BENCH_MSGN_CONST(size)                                                  \
+static void rte_bench_msgn_const_##size(uint32_t no_calls)                          \
+{                                                                                   \
+    for (uint32_t i = 0U; i < no_calls; i++)                                        \
+    {                                                                               \
+        RTE_MSGN(RTE_BENCH_MSGX_ID, F_COM_DEMO, rte_bench_payload, size##U);        \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static void rte_bench_msgn_generic_##size(uint32_t no_calls)                        \
+{                                                                                   \
+    for (uint32_t i = 0U; i < no_calls; i++)                                        \
+    {                                                                               \
+        __rte_msgn(RTE_PACK(F_COM_DEMO, RTE_BENCH_MSGX_ID, 4U), rte_bench_payload, size##U); \
+    }                                                                               \
+}
+
+RTE_BENCH_MSGN_CONST(4)
+RTE_BENCH_MSGN_CONST(12)
+RTE_BENCH_MSGN_CONST(16)
+
+static const struct
+{
+    uint32_t size;
+    rte_bench_case_t p_const;
+    rte_bench_case_t p_generic;
+} rte_bench_msgn_const[] =
+{
+    {  4U, rte_bench_msgn_const_4,  rte_bench_msgn_generic_4 },
+    { 12U, rte_bench_msgn_const_12, rte_bench_msgn_generic_12 },
+    { 16U, rte_bench_msgn_const_16, rte_bench_msgn_generic_16 }
+};
+#define RTE_BENCH_MSGN_CONST_CASES  (sizeof(rte_bench_msgn_const) / sizeof(rte_bench_msgn_const[0]))
+
+
+#define RTE_BENCH_FRAME_WORDS 16U
+
+static void rte_bench_frame_copy(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        uint32_t frame[RTE_BENCH_FRAME_WORDS];
+        for (uint32_t j = 0U; j < RTE_BENCH_FRAME_WORDS; j++)
+        {
+            frame[j] = (i * 0x9E3779B9U) + j;
+        }
+        RTE_MSGN(RTE_BENCH_MSGX_ID, F_COM_DEMO, frame, sizeof(frame));
+    }
+}
+
+
+static void rte_bench_frame_writer(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        rte_writer_t writer;
+        RTE_MSG_RESERVE(&writer, RTE_BENCH_MSGX_ID, F_COM_DEMO, RTE_BENCH_FRAME_WORDS);
+        if (rte_writer_active(&writer))
+        {
+            for (uint32_t j = 0U; j < RTE_BENCH_FRAME_WORDS; j++)
+            {
+                rte_writer_put(&writer, (i * 0x9E3779B9U) + j);
+            }
+            rte_msg_commit(&writer);
+        }
+    }
+}
+
+
+// Six messages per iteration of a control loop - logged one by one or as a batch
+static void rte_bench_loop_single(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSG0(RTE_BENCH_MSG0_ID, F_COM_DEMO);
+        RTE_MSG1(RTE_BENCH_MSG1_ID, F_COM_DEMO, i);
+        RTE_MSG2(RTE_BENCH_MSG2_ID, F_COM_DEMO, i, i + 1U);
+        RTE_MSG3(RTE_BENCH_MSG3_ID, F_COM_DEMO, i, i + 1U, i + 2U);
+        RTE_MSG4(RTE_BENCH_MSG4_ID, F_COM_DEMO, i, i + 1U, i + 2U, i + 3U);
+        RTE_MSG0(RTE_BENCH_MSG0_ID, F_COM_DEMO);
+    }
+}
+
+
+static void rte_bench_loop_batch(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        rte_batch_t batch;
+        rte_batch_init(&batch);
+        RTE_BATCH_MSG0(&batch, RTE_BENCH_MSG0_ID, F_COM_DEMO);
+        RTE_BATCH_MSG1(&batch, RTE_BENCH_MSG1_ID, F_COM_DEMO, i);
+        RTE_BATCH_MSG2(&batch, RTE_BENCH_MSG2_ID, F_COM_DEMO, i, i + 1U);
+        RTE_BATCH_MSG3(&batch, RTE_BENCH_MSG3_ID, F_COM_DEMO, i, i + 1U, i + 2U);
+        RTE_BATCH_MSG4(&batch, RTE_BENCH_MSG4_ID, F_COM_DEMO, i, i + 1U, i + 2U, i + 3U);
+        RTE_BATCH_MSG0(&batch, RTE_BENCH_MSG0_ID, F_COM_DEMO);
+        rte_batch_commit(&batch);
+    }
+}
+
+
+static void rte_bench_string(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_STRING(RTE_BENCH_MSGX_ID, F_COM_DEMO, (const char *)rte_bench_address);
+    }
+}
+
+
+static void rte_bench_msgx(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        RTE_MSGX(RTE_BENCH_MSGX_ID, F_COM_DEMO, rte_bench_address, rte_bench_size);
+    }
+}
+
+
+/***
+ * @brief Reference copy of the __rte_msgx() before the word-wide fast path was added.
+ *        The DATA words are assembled byte by byte. The optional trigger, statistics,
+ *        rate limiter and priority region hooks are not included. The copy is not inlined
+ *        or specialized for the constant format ID - it is called the same way as the
+ *        __rte_msgx() from the rtedbg.c.
+ */
+
+__attribute__((noipa)) static void rte_bench_msgx_old_fn(const uint32_t fmt_id,
+                                  volatile const void *const address, const uint32_t data_length)
+{
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
+    uint32_t length = data_length;
+
+#if RTE_DELAYED_TSTAMP_READ != 1
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 4U))
+    {
+        return;
+    }
+
+    if (length > (RTE_MAX_MSGX_SIZE - 1U))
+    {
+        length = RTE_MAX_MSGX_SIZE - 1U;
+    }
+
+    uint32_t no_words = 2U + (length / 4U) + (length / 16U);
+    uint32_t buf_index;
+    RTE_RESERVE_SPACE(p_rtedbg, buf_index, no_words);
+
+#if RTE_DELAYED_TSTAMP_READ != 0
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+    timestamp |= (fmt_id << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U))) | 1U;
+    rte_pack_data_t data;
+    volatile const uint8_t *addr = (volatile const uint8_t *)address;
+    int32_t remaining_bytes = (int32_t)length;
+
+    do
+    {
+        data.w32.bits31 = 0U;
+        no_words = 4U;
+        uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
+
+        do
+        {
+            data.w32.data = 0U;
+            switch (remaining_bytes)
+            {
+                default:
+                    data.w32.data = ((uint32_t)addr[3U]) << 24U;
+                    RTE_FALLTHROUGH; /* fallthrough */
+                case 3:
+                    data.w32.data |= ((uint32_t)addr[2U]) << 16U;
+                    RTE_FALLTHROUGH; /* fallthrough */
+                case 2:
+                    data.w32.data |= ((uint32_t)addr[1U]) << 8U;
+                    RTE_FALLTHROUGH; /* fallthrough */
+                case 1:
+                    data.w32.data |= (uint32_t)*addr;
+                    break;
+                case 0:
+                    break;
+            }
+
+            addr += 4U;
+            remaining_bytes -= 4;
+            if (remaining_bytes < 0)
+            {
+                data.w32.data |= (length << 24U);
+                no_words = 1U;
+            }
+
+            data.w64 <<= 1U;
+            *data_packet = data.w32.data;
+            data_packet++;
+            no_words--;
+        }
+        while (no_words != 0U);
+
+        *data_packet = timestamp | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+        buf_index += 5U;
+        RTE_LIMIT_INDEX(buf_index)
+    }
+    while (remaining_bytes >= 0);
+}
+
+
+static void rte_bench_msgx_old(uint32_t no_calls)
+{
+    for (uint32_t i = 0U; i < no_calls; i++)
+    {
+        rte_bench_msgx_old_fn(RTE_PACK_MSGX(F_COM_DEMO, RTE_BENCH_MSGX_ID),
+                              rte_bench_address, rte_bench_size);
+    }
+}
+
+
+/***
+ * @brief Run a benchmark case and print the average time per call and the number
+ *        of circular buffer words written per call.
+ *
+ * @param p_name    Case name
+ * @param bench     Function with the logging calls
+ * @param no_calls  Number of logging calls in one repetition
+ */
+
+static void rte_bench_run(const char *p_name, rte_bench_case_t bench, uint32_t no_calls)
+{
+    uint64_t best = UINT64_MAX;
+
+    // A single call from the start of the buffer - the buf_index is the number of words
+    g_rtedbg.buf_index = 0U;
+    bench(1U);
+    const uint32_t words = g_rtedbg.buf_index;
+
+    for (uint32_t i = 0U; i < RTE_BENCH_REPEAT; i++)
+    {
+        uint64_t start = rte_bench_time();
+        bench(no_calls);
+        uint64_t time = rte_bench_time() - start;
+        if (time < best)
+        {
+            best = time;
+        }
+    }
+
+    printf("%s,%u,%.2f,%u\n", p_name, no_calls, (double)best / no_calls, words);
+}
+
+
+/***
+ * @brief Check that the __rte_msgx() and its reference copy write the same DATA words
+ *        for all payload sizes and alignments.
+ *
+ * @return 0 - OK, 1 - the words are not the same
+ */
+
+static uint32_t rte_bench_msgx_check(void)
+{
+    static uint32_t words[RTE_MAX_MSGX_SIZE / 2U];
+    uint8_t *p_payload = (uint8_t *)rte_bench_payload;
+
+    for (uint32_t size = 0U; size < RTE_MAX_MSGX_SIZE; size++)
+    {
+        for (uint32_t offset = 0U; offset < 4U; offset++)
+        {
+            uint32_t no_words = 2U + (size / 4U) + (size / 16U);
+
+            g_rtedbg.buf_index = 0U;
+            rte_bench_msgx_old_fn(RTE_PACK_MSGX(F_COM_DEMO, RTE_BENCH_MSGX_ID),
+                                  &p_payload[offset], size);
+            memcpy(words, g_rtedbg.buffer, no_words * sizeof(uint32_t));
+
+            g_rtedbg.buf_index = 0U;
+            RTE_MSGX(RTE_BENCH_MSGX_ID, F_COM_DEMO, &p_payload[offset], size);
+
+            for (uint32_t i = 0U; i < no_words; i++)
+            {
+                // Compare without the timestamps (bits 1 ... 31 - RTE_FMT_ID_BITS of the FMT words)
+                uint32_t mask = ((i % 5U) == 4U) || (i == (no_words - 1U)) ? ~(RTE_TIMESTAMP_MASK & ~1U) : 0xFFFFFFFFU;
+                if (((words[i] ^ g_rtedbg.buffer[i]) & mask) != 0U)
+                {
+                    fprintf(stderr, "msgx: different data (size %u, offset %u, word %u)\n", size, offset, i);
+                    return 1U;
+                }
+            }
+        }
+    }
+
+    return 0U;
+}
+
+
+/***
+ * @brief Check that the constant-size RTE_MSGN() and the generic __rte_msgn() write
+ *        the same words to the circular buffer.
+ *
+ * @return 0 - OK, 1 - the words are not the same
+ */
+
+static uint32_t rte_bench_msgn_const_check(void)
+{
+    uint32_t words[RTE_MAX_MSG_SIZE / 2U];
+
+    for (uint32_t n = 0U; n < RTE_BENCH_MSGN_CONST_CASES; n++)
+    {
+        uint32_t size = rte_bench_msgn_const[n].size;
+        uint32_t no_words = (size / 4U) + ((size + 15U) / 16U);
+
+        g_rtedbg.buf_index = 0U;
+        rte_bench_msgn_const[n].p_generic(1U);
+        memcpy(words, g_rtedbg.buffer, no_words * sizeof(uint32_t));
+
+        g_rtedbg.buf_index = 0U;
+        rte_bench_msgn_const[n].p_const(1U);
+
+        if (g_rtedbg.buf_index != no_words)
+        {
+            fprintf(stderr, "msgn_const_%u: %u words instead of %u\n", size, g_rtedbg.buf_index, no_words);
+            return 1U;
+        }
+
+        for (uint32_t i = 0U; i < no_words; i++)
+        {
+            // Compare without the timestamps of the FMT words
+            uint32_t mask = ((i % 5U) == 4U) || (i == (no_words - 1U)) ? ~(RTE_TIMESTAMP_MASK & ~1U) : 0xFFFFFFFFU;
+            if (((words[i] ^ g_rtedbg.buffer[i]) & mask) != 0U)
+            {
+                fprintf(stderr, "msgn_const_%u: different data (word %u)\n", size, i);
+                return 1U;
+            }
+        }
+    }
+
+    return 0U;
+}
+
+
+/***
+ * @brief Store a message decoded by the rte_bench_loop_decode() - decoder callback.
+ */
+
+static void rte_bench_loop_msg(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    rte_bench_loop_t *p_loop = (rte_bench_loop_t *)p_user;
+
+    if ((p_loop->no_msgs < RTE_BENCH_LOOP_MSGS) && (p_msg->no_words <= 4U))
+    {
+        p_loop->fmt_id[p_loop->no_msgs] = p_msg->fmt_id;
+        p_loop->no_words[p_loop->no_msgs] = p_msg->no_words;
+        memcpy(p_loop->data[p_loop->no_msgs], p_msg->data, p_msg->no_words * sizeof(uint32_t));
+    }
+    p_loop->no_msgs++;
+}
+
+
+/***
+ * @brief Log one loop iteration from the start of the buffer and decode it.
+ */
+
+static void rte_bench_loop_decode(rte_bench_case_t bench, rte_bench_loop_t *p_loop)
+{
+    rte_dec_header_t hdr;
+    static rte_decoder_t decoder;
+
+    memset(p_loop, 0, sizeof(rte_bench_loop_t));
+    g_rtedbg.buf_index = 0U;
+    bench(1U);
+
+    (void)rte_dec_parse_header(&hdr, (const uint8_t *)&g_rtedbg, sizeof(g_rtedbg));
+    rte_dec_init(&decoder, &hdr, rte_bench_loop_msg, p_loop);
+    rte_dec_push(&decoder, (const uint8_t *)g_rtedbg.buffer, g_rtedbg.buf_index * sizeof(uint32_t));
+    rte_dec_flush(&decoder);
+}
+
+
+/***
+ * @brief Check that the messages of the loop_batch are decoded the same as the
+ *        messages of the loop_single (format IDs, sizes and DATA words).
+ *
+ * @return 0 - OK, 1 - the decoded messages are not the same
+ */
+
+static uint32_t rte_bench_loop_check(void)
+{
+    static rte_bench_loop_t single;
+    static rte_bench_loop_t batch;
+
+    rte_bench_loop_decode(rte_bench_loop_single, &single);
+    rte_bench_loop_decode(rte_bench_loop_batch, &batch);
+
+    if ((single.no_msgs != RTE_BENCH_LOOP_MSGS) || (batch.no_msgs != RTE_BENCH_LOOP_MSGS))
+    {
+        fprintf(stderr, "loop: %u and %u messages decoded instead of %u\n",
+                single.no_msgs, batch.no_msgs, RTE_BENCH_LOOP_MSGS);
+        return 1U;
+    }
+
+    if (memcmp(&single, &batch, sizeof(rte_bench_loop_t)) != 0)
+    {
+        fprintf(stderr, "loop: the batch messages are decoded differently\n");
+        return 1U;
+    }
+
+    return 0U;
+}
+
+
+/***
+ * @brief Run the msgx cases for a payload size.
+ */
+
+static void rte_bench_msgx_size(uint32_t size, uint32_t no_calls)
+{
+    char name[40];
+
+    rte_bench_size = size;
+    rte_bench_address = (volatile const uint8_t *)rte_bench_payload;
+    snprintf(name, sizeof(name), "msgx_%u", size);
+    rte_bench_run(name, rte_bench_msgx, no_calls);
+
+    snprintf(name, sizeof(name), "msgx_old_%u", size);
+    rte_bench_run(name, rte_bench_msgx_old, no_calls);
+
+    rte_bench_address = (volatile const uint8_t *)rte_bench_payload + 1U;
+    snprintf(name, sizeof(name), "msgx_%u_unaligned", size);
+    rte_bench_run(name, rte_bench_msgx, no_calls);
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint32_t no_calls = 10000000U;
+    uint32_t all_sizes = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:xh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                no_calls = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'x':
+                all_sizes = 1U;     // Run the msgx cases for all payload sizes
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-n number_of_calls] [-x]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (no_calls == 0U)
+    {
+        return 1;
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    printf("# RTE_MINIMIZED_CODE_SIZE=%u RTE_DELAYED_TSTAMP_READ=%u RTE_BUFFER_SIZE=%u\n",
+           (unsigned)(RTE_MINIMIZED_CODE_SIZE), (unsigned)(RTE_DELAYED_TSTAMP_READ),
+           (unsigned)(RTE_BUFFER_SIZE));
+    printf("# case,calls,ns_per_call,words_per_call\n");
+
+    rte_bench_run("msg0", rte_bench_msg0, no_calls);
+    rte_bench_run("msg1", rte_bench_msg1, no_calls);
+    rte_bench_run("msg2", rte_bench_msg2, no_calls);
+    rte_bench_run("msg3", rte_bench_msg3, no_calls);
+    rte_bench_run("msg4", rte_bench_msg4, no_calls);
+
+#if RTE_RATE_LIMIT_ENABLED == 1
+    // Limit not reached - one token per timestamp unit
+    g_rtedbg.rate_limit[F_COM_DEMO] = RTE_RATE_LIMIT_CONFIG(1U, 255U);
+    g_rtedbg.rate_limit_mask = 0x80000000U >> F_COM_DEMO;
+    rte_bench_run("msg0_limited", rte_bench_msg0, no_calls);
+
+    // No tokens - all messages are discarded
+    g_rtedbg.rate_limit[F_COM_DEMO] = RTE_RATE_LIMIT_CONFIG(0x00FFFFFFU, 0U);
+    rte_bench_run("msg0_shed", rte_bench_msg0, no_calls);
+    g_rtedbg.rate_limit_mask = 0U;
+    if ((no_calls >= 0xFFFFU) && (g_rtedbg.rate_shed[F_COM_DEMO] != 0xFFFFU))
+    {
+        fprintf(stderr, "rate_shed: %u instead of the saturated value 65535\n",
+                (unsigned)g_rtedbg.rate_shed[F_COM_DEMO]);
+        return 1;
+    }
+#endif
+
+    rte_set_filter(~(0x80000000U >> F_COM_DEMO));
+    rte_bench_run("msg0_filtered", rte_bench_msg0, no_calls);
+    rte_set_filter(RTE_FORCE_ENABLE_ALL_FILTERS);
+
+    for (uint32_t i = 0U; i < sizeof(rte_bench_payload); i++)
+    {
+        ((uint8_t *)rte_bench_payload)[i] = (uint8_t)(((i * 37U) % 255U) + 1U);   // No zero bytes (strings)
+    }
+
+    if ((rte_bench_msgx_check() != 0U) || (rte_bench_msgn_const_check() != 0U)
+        || (rte_bench_loop_check() != 0U))
+    {
+        return 1;
+    }
+
+    // The longer messages take more time - fewer calls
+    uint32_t msgx_calls = (no_calls / 10U) + 1U;
+
+    static const uint16_t msgn_sizes[] = {16U, 64U, 256U};
+    for (uint32_t i = 0U; i < (sizeof(msgn_sizes) / sizeof(msgn_sizes[0])); i++)
+    {
+        char name[40];
+
+        rte_bench_size = (msgn_sizes[i] > RTE_MAX_MSG_SIZE) ? RTE_MAX_MSG_SIZE : msgn_sizes[i];
+        rte_bench_address = (volatile const uint8_t *)rte_bench_payload;
+        snprintf(name, sizeof(name), "msgn_%u", rte_bench_size);
+        rte_bench_run(name, rte_bench_msgn, msgx_calls);
+
+        rte_bench_address = (volatile const uint8_t *)rte_bench_payload + 1U;
+        snprintf(name, sizeof(name), "msgn_%u_unaligned", rte_bench_size);
+        rte_bench_run(name, rte_bench_msgn, msgx_calls);
+    }
+
+    for (uint32_t i = 0U; i < RTE_BENCH_MSGN_CONST_CASES; i++)
+    {
+        char name[40];
+
+        if (rte_bench_msgn_const[i].size <= RTE_MAX_MSG_SIZE)
+        {
+            snprintf(name, sizeof(name), "msgn_const_%u", rte_bench_msgn_const[i].size);
+            rte_bench_run(name, rte_bench_msgn_const[i].p_const, msgx_calls);
+            snprintf(name, sizeof(name), "msgn_generic_%u", rte_bench_msgn_const[i].size);
+            rte_bench_run(name, rte_bench_msgn_const[i].p_generic, msgx_calls);
+        }
+    }
+
+    rte_bench_run("frame_copy", rte_bench_frame_copy, msgx_calls);
+    rte_bench_run("frame_writer", rte_bench_frame_writer, msgx_calls);
+    rte_bench_run("loop_single", rte_bench_loop_single, msgx_calls);
+    rte_bench_run("loop_batch", rte_bench_loop_batch, msgx_calls);
+
+    static const uint16_t string_sizes[] = {7U, 31U, 100U, 250U};
+    for (uint32_t i = 0U; i < (sizeof(string_sizes) / sizeof(string_sizes[0])); i++)
+    {
+        char name[40];
+        uint8_t *p_payload = (uint8_t *)rte_bench_payload;
+        uint8_t last = p_payload[string_sizes[i]];
+
+        p_payload[string_sizes[i]] = 0U;    // Terminate the string
+        rte_bench_address = (volatile const uint8_t *)rte_bench_payload;
+        snprintf(name, sizeof(name), "string_%u", string_sizes[i]);
+        rte_bench_run(name, rte_bench_string, msgx_calls);
+        p_payload[string_sizes[i]] = last;
+    }
+    if (all_sizes != 0U)
+    {
+        for (uint32_t size = 1U; size < RTE_MAX_MSGX_SIZE; size++)
+        {
+            rte_bench_msgx_size(size, msgx_calls);
+        }
+    }
+    else
+    {
+        static const uint16_t sizes[] = {1U, 3U, 4U, 8U, 15U, 16U, 31U, 32U, 64U, 127U, 128U, 255U};
+        for (uint32_t i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+        {
+            if (sizes[i] < RTE_MAX_MSGX_SIZE)
+            {
+                rte_bench_msgx_size(sizes[i], msgx_calls);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_stm32_mock.c
+ * @author  Branko Premzel
+ * @brief   Host mock of the STM32 DMA and USART - see the rte_stm32_mock.h.
+ ******************************************************************************/
+
+#include <string.h>
+#include "main.h"
+#include "rte_com.h"
+
+rte_stm32_mock_t g_rte_mock;
+DMA_TypeDef rte_mock_dma;
+USART_TypeDef rte_mock_usart;
+
+
+void LL_DMA_DisableChannel(DMA_TypeDef *p_dma, uint32_t channel)
+{
+    (void)p_dma;
+    if (channel == STM32_LL_DMA_CHANNEL)
+    {
+        if ((g_rte_mock.tx_enabled != 0U) && (g_rte_mock.tx_length != 0U))
+        {
+            g_rte_mock.tx_restarts++;   // The data of an active transfer would be lost
+        }
+        g_rte_mock.tx_enabled = 0U;
+    }
+}
+
+
+void LL_DMA_EnableChannel(DMA_TypeDef *p_dma, uint32_t channel)
+{
+    (void)p_dma;
+    if (channel == STM32_LL_DMA_CHANNEL)
+    {
+        g_rte_mock.tx_enabled = 1U;
+        g_rte_mock.tx_starts++;
+    }
+}
+
+
+void LL_DMA_ConfigAddresses(DMA_TypeDef *p_dma, uint32_t channel, uint32_t src, uint32_t dst,
+                            uint32_t direction)
+{
+    (void)p_dma;
+    (void)direction;
+    if (channel == STM32_LL_DMA_CHANNEL)
+    {
+        g_rte_mock.tx_address = src;
+    }
+    else
+    {
+        g_rte_mock.rx_address = dst;
+    }
+}
+
+
+void LL_DMA_SetDataLength(DMA_TypeDef *p_dma, uint32_t channel, uint32_t length)
+{
+    (void)p_dma;
+    if (channel == STM32_LL_DMA_CHANNEL)
+    {
+        g_rte_mock.tx_length = length;
+    }
+    else
+    {
+        g_rte_mock.rx_size = length;
+        g_rte_mock.rx_index = 0U;
+    }
+}
+
+
+uint32_t LL_DMA_GetDataLength(DMA_TypeDef *p_dma, uint32_t channel)
+{
+    (void)p_dma;
+    if (channel == STM32_LL_DMA_CHANNEL)
+    {
+        return g_rte_mock.tx_length;
+    }
+    return g_rte_mock.rx_size - g_rte_mock.rx_index;
+}
+
+
+uint32_t LL_DMA_IsActiveFlag_TC1(DMA_TypeDef *p_dma)
+{
+    (void)p_dma;
+    return g_rte_mock.tx_tc_flag;
+}
+
+
+void LL_DMA_ClearFlag_TC1(DMA_TypeDef *p_dma)
+{
+    (void)p_dma;
+    g_rte_mock.tx_tc_flag = 0U;
+}
+
+
+/***
+ * @brief Complete the active transmit transfer. The data is copied to the p_tx_data buffer
+ *        and the transfer complete interrupt handler is called (if interrupts are enabled).
+ *
+ * @return 1 - a transfer has been completed, 0 - the transmit DMA channel is idle
+ */
+
+uint32_t rte_mock_tx_run(void)
+{
+    uint32_t length = g_rte_mock.tx_length;
+
+    if ((g_rte_mock.tx_enabled == 0U) || (length == 0U))
+    {
+        return 0U;
+    }
+
+    const uint8_t *p_data = (const uint8_t *)(uintptr_t)g_rte_mock.tx_address;
+    if (length > (g_rte_mock.tx_data_size - g_rte_mock.tx_size))
+    {
+        length = g_rte_mock.tx_data_size - g_rte_mock.tx_size;
+    }
+    memcpy(&g_rte_mock.p_tx_data[g_rte_mock.tx_size], p_data, length);
+    g_rte_mock.tx_size += length;
+    g_rte_mock.tx_length = 0U;
+    g_rte_mock.tx_tc_flag = 1U;
+
+    if (g_rte_mock.primask == 0U)
+    {
+        rte_com_tx_complete();
+    }
+    return 1U;
+}
+
+
+#if RTECOM_DMA_RECEIVE == 1
+/***
+ * @brief Call the receive interrupt handler as the interrupt controller does.
+ *        The USART flags written to the ICR register are cleared after it returns.
+ */
+
+static void rte_mock_rx_interrupt(void)
+{
+    g_rte_mock.rx_interrupts++;
+    rte_com_rx_process();
+    rte_mock_usart.ISR &= ~rte_mock_usart.ICR;
+    rte_mock_usart.ICR = 0U;
+}
+
+
+/***
+ * @brief Write received bytes to the circular receive buffer as the DMA does. The half
+ *        transfer and transfer complete interrupts are generated at the middle and at
+ *        the end of the buffer.
+ *
+ * @param p_data Received data
+ * @param size   Number of bytes
+ * @param idle   1 - the idle line interrupt follows the data (end of the host message)
+ */
+
+void rte_mock_rx_data(const uint8_t *p_data, uint32_t size, uint32_t idle)
+{
+    uint8_t *p_buffer = (uint8_t *)(uintptr_t)g_rte_mock.rx_address;
+
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        p_buffer[g_rte_mock.rx_index] = p_data[i];
+        g_rte_mock.rx_index++;
+        if (g_rte_mock.rx_index == g_rte_mock.rx_size)
+        {
+            g_rte_mock.rx_index = 0U;
+            rte_mock_rx_interrupt();    // Transfer complete
+        }
+        else if (g_rte_mock.rx_index == (g_rte_mock.rx_size / 2U))
+        {
+            rte_mock_rx_interrupt();    // Half transfer
+        }
+    }
+
+    if (idle != 0U)
+    {
+        rte_mock_usart.ISR |= USART_ISR_IDLE;
+        rte_mock_rx_interrupt();
+    }
+}
+#endif // RTECOM_DMA_RECEIVE == 1
+
+/*==== End of file ====*/
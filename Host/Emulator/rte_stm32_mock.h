@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_stm32_mock.h
+ * @author  Branko Premzel
+ * @brief   Host mock of the STM32 LL_DMA and LL_USART functions used by the
+ *          RTEcomLib/Portable/rte_com_STM32_driver.h.
+ *
+ *          The DMA channels do not run by themselves. The test program calls
+ *          rte_mock_tx_run() to complete the active transmit transfer (the data
+ *          is read at that time - as by a real DMA after the rte_com_send_data()
+ *          returns) and rte_mock_rx_data() to write received bytes to the receive
+ *          DMA buffer. The transfer complete interrupt handler rte_com_tx_complete()
+ *          and the receive interrupt handler rte_com_rx_process() are called by
+ *          the mock as by the interrupt controller.
+ *
+ *          The mock is enabled with RTE_STM32_MOCK - see the Host/Emulator/main.h.
+ *          The DMA addresses are 32-bit: the programs must be linked with -no-pie
+ *          so that the static data is in the lower 4 GB of the address space.
+ ******************************************************************************/
+
+#ifndef RTE_STM32_MOCK_H
+#define RTE_STM32_MOCK_H
+
+#include <stdint.h>
+
+// The driver casts the data addresses to 32-bit DMA register values (see the -no-pie note above)
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+
+#define __IO  volatile
+
+typedef struct
+{
+    uint32_t dummy;
+} DMA_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t ISR;
+    volatile uint32_t ICR;
+} USART_TypeDef;
+
+// Mock state
+typedef struct
+{
+    uint32_t primask;           // 1 - interrupts disabled
+    uint32_t tx_enabled;        // Transmit channel enabled
+    uint32_t tx_address;        // Memory address of the transmit transfer
+    uint32_t tx_length;         // Number of bytes of the transmit transfer
+    uint32_t tx_tc_flag;        // Transmit transfer complete flag
+    uint32_t tx_starts;         // Number of transmit transfers started
+    uint32_t tx_restarts;       // Transfers reconfigured before they were complete (error)
+    uint32_t rx_address;        // Memory address of the circular receive buffer
+    uint32_t rx_size;           // Size of the circular receive buffer
+    uint32_t rx_index;          // DMA write index in the receive buffer
+    uint32_t rx_interrupts;     // Number of calls of the rte_com_rx_process()
+    uint8_t *p_tx_data;         // Buffer for the data sent by the DMA (set by the test program)
+    uint32_t tx_data_size;      // Size of the buffer
+    uint32_t tx_size;           // Number of bytes sent
+} rte_stm32_mock_t;
+
+extern rte_stm32_mock_t g_rte_mock;
+extern DMA_TypeDef rte_mock_dma;
+extern USART_TypeDef rte_mock_usart;
+
+uint32_t rte_mock_tx_run(void);
+void rte_mock_rx_data(const uint8_t *p_data, uint32_t size, uint32_t idle);
+
+// Cortex-M core functions
+#define __get_PRIMASK()     (g_rte_mock.primask)
+#define __disable_irq()     (g_rte_mock.primask = 1U)
+#define __enable_irq()      (g_rte_mock.primask = 0U)
+
+#define DMA1                (&rte_mock_dma)
+#define USART2              (&rte_mock_usart)
+
+#define LL_DMA_CHANNEL_1    1U
+#define LL_DMA_CHANNEL_2    2U
+#define LL_DMAMUX_REQ_USART2_RX           53U
+#define LL_DMA_DIRECTION_MEMORY_TO_PERIPH 0x10U
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY 0U
+#define LL_DMA_MODE_CIRCULAR              0x20U
+#define LL_DMA_PERIPH_NOINCREMENT         0U
+#define LL_DMA_MEMORY_INCREMENT           0x80U
+#define LL_DMA_PDATAALIGN_BYTE            0U
+#define LL_DMA_MDATAALIGN_BYTE            0U
+#define LL_DMA_PRIORITY_HIGH              0x2000U
+#define LL_USART_DMA_REG_DATA_TRANSMIT    0U
+#define LL_USART_DMA_REG_DATA_RECEIVE     1U
+
+#define USART_ISR_PE        (1UL << 0U)
+#define USART_ISR_FE        (1UL << 1U)
+#define USART_ISR_NE        (1UL << 2U)
+#define USART_ISR_ORE       (1UL << 3U)
+#define USART_ISR_IDLE      (1UL << 4U)
+#define USART_ICR_IDLECF    USART_ISR_IDLE
+
+void LL_DMA_DisableChannel(DMA_TypeDef *p_dma, uint32_t channel);
+void LL_DMA_EnableChannel(DMA_TypeDef *p_dma, uint32_t channel);
+void LL_DMA_ConfigAddresses(DMA_TypeDef *p_dma, uint32_t channel, uint32_t src, uint32_t dst,
+                            uint32_t direction);
+void LL_DMA_SetDataLength(DMA_TypeDef *p_dma, uint32_t channel, uint32_t length);
+uint32_t LL_DMA_GetDataLength(DMA_TypeDef *p_dma, uint32_t channel);
+uint32_t LL_DMA_IsActiveFlag_TC1(DMA_TypeDef *p_dma);
+void LL_DMA_ClearFlag_TC1(DMA_TypeDef *p_dma);
+#define LL_DMA_SetPeriphRequest(p_dma, channel, request)  (void)(request)
+#define LL_DMA_ConfigTransfer(p_dma, channel, config)     (void)(config)
+#define LL_DMA_EnableIT_TC(p_dma, channel)
+#define LL_DMA_EnableIT_HT(p_dma, channel)
+#define LL_DMA_ClearFlag_GI2(p_dma)
+#define LL_USART_DMA_GetRegAddr(p_usart, reg)             (reg)
+#define LL_USART_EnableDMAReq_TX(p_usart)
+#define LL_USART_EnableDMAReq_RX(p_usart)
+#define LL_USART_ClearFlag_IDLE(p_usart)                  ((p_usart)->ISR &= ~USART_ISR_IDLE)
+#define LL_USART_EnableIT_IDLE(p_usart)
+#define LL_USART_EnableIT_ERROR(p_usart)
+
+#endif  // RTE_STM32_MOCK_H
+
+/*==== End of file ====*/
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_tstamp_sim.c
+ * @author  Branko Premzel
+ * @brief   Long run test of the extended SYSTICK timestamp driver
+ *          (rtedbg_timer_systick_ext.h) and the host decoder (rte_decoder.c).
+ *
+ *          The SYSTICK registers are simulated (see the main.h). The simulated
+ *          CPU clock advances from message to message - hours of run time are
+ *          simulated in seconds. The SYSTICK interrupt is executed at every
+ *          counter reload with a random latency. Messages logged during the
+ *          latency test the detection of the overflow that has not been processed
+ *          yet. The workload alternates between busy periods, sparse logging and
+ *          long pauses without any message.
+ *          Each message contains the simulated time at which it was logged.
+ *          *) The data logged is decoded continuously (as when streaming) and the
+ *             decoded absolute time of every message is compared with the logged one.
+ *          *) A post-mortem snapshot of g_rtedbg is decoded every simulated minute.
+ *             Messages after the first long timestamp in the snapshot are checked.
+ *             The messages before it can not be decoded - they must not occupy more
+ *             than 3/4 of the circular buffer (see RTE_TSTAMP_ANCHOR_WORDS).
+ *          The number of long timestamp messages is printed together with the number
+ *          of periodic rte_long_timestamp() calls required with the rtedbg_timer_systick.h
+ *          driver. The extended driver logs the long timestamps only during pauses in
+ *          logging and periodically for the post-mortem snapshots.
+ *
+ *          The results are printed in the CSV format. The exit code is 1 if the
+ *          time of any message has not been decoded correctly or if a snapshot
+ *          contains too many messages without a preceding long timestamp.
+ *
+ *          Build (from the repository root folder):
+ *          gcc -O2 -DRTE_HOST_BUILD -DRTE_SIMULATED_SYSTICK -IHost/Emulator -IHost
+ *              -IRTEdbg/Inc -IRTEdbg/Fmt -IRTEcomLib RTEdbg/rtedbg.c Host/rte_decoder.c
+ *              Host/Emulator/rte_tstamp_sim.c -o rte_tstamp_sim
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "main.h"
+#include "rtedbg_int.h"
+#include "rte_com_demo_fmt.h"
+#include "rte_decoder.h"
+
+#define RTE_SIM_CLOCK          48000000U   // Simulated CPU clock [Hz]
+#define RTE_SIM_MAX_LATENCY    5000U       // Max. SYSTICK interrupt latency [CPU clock cycles]
+#define RTE_SIM_SNAPSHOT_TIME  (60ULL * RTE_SIM_CLOCK)  // Post-mortem check interval
+#define RTE_SIM_MAX_REPORTS    10U         // Max. number of reported errors
+#define RTE_SIM_MAX_UNANCHORED ((3U * (RTE_BUFFER_SIZE)) / 4U)  // Max. unanchored words in a snapshot
+#define MSG2_SIM_TIME          16U         // Any format ID (the decoder does not use the definitions)
+
+SysTick_Type rte_sim_systick;   // Simulated SYSTICK registers
+SCB_Type rte_sim_scb;
+volatile uint32_t uwTick;       // Required by the host main.h
+uint32_t uwTick_last_byte_received;
+
+typedef struct
+{
+    uint64_t time;              // Simulated time [CPU clock cycles]
+    uint64_t overflows;         // Number of SYSTICK interrupts executed
+    uint64_t next_snapshot;     // Time of the next post-mortem check
+    uint32_t read_index;        // Circular buffer index of the next word to decode
+    uint32_t random;            // State of the random number generator
+    uint32_t anchored;          // 1 - a long timestamp has been decoded in the snapshot
+    uint64_t messages;          // Number of messages logged
+    uint64_t checked;           // Number of messages checked (stream)
+    uint64_t long_timestamps;   // Number of long timestamp messages decoded (stream)
+    uint64_t pending_logged;    // Number of messages logged while the overflow was pending
+    uint64_t snapshots;         // Number of post-mortem checks
+    uint64_t snapshot_checked;  // Number of messages checked in the snapshots
+    uint64_t unanchored;        // Snapshot messages without a preceding long timestamp
+    uint32_t snapshot_unanchored;   // Words of the unanchored messages in the current snapshot
+    uint32_t max_unanchored;    // Max. number of unanchored words in a snapshot
+    uint64_t unanchored_errors; // Snapshots with more than RTE_SIM_MAX_UNANCHORED unanchored words
+    uint64_t errors;            // Number of messages with an incorrect timestamp
+} rte_sim_t;
+
+static rte_sim_t sim;
+static rte_decoder_t stream_dec;
+static rte_decoder_t snapshot_dec;
+
+
+/***
+ * @brief Return a pseudo-random number in the range 0 ... limit - 1 (xorshift32).
+ */
+
+static uint32_t rte_sim_random(uint32_t limit)
+{
+    uint32_t x = sim.random;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    sim.random = x;
+    return x % limit;
+}
+
+
+/***
+ * @brief Set the simulated SYSTICK registers for the current time. The counter period
+ *        is defined by the reload value set by the driver. The pending bit is set if
+ *        the counter has been reloaded, but the interrupt has not been executed yet.
+ */
+
+static void rte_sim_set_time(uint64_t time)
+{
+    uint64_t period = (uint64_t)rte_sim_systick.LOAD + 1U;
+    sim.time = time;
+    rte_sim_systick.VAL = rte_sim_systick.LOAD - (uint32_t)(time % period);
+
+    if ((time / period) > sim.overflows)
+    {
+        rte_sim_scb.ICSR |= SCB_ICSR_PENDSTSET_Msk;
+    }
+    else
+    {
+        rte_sim_scb.ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+    }
+}
+
+
+/***
+ * @brief Pass the words of the last logged message to the streaming decoder.
+ *        Called after every message since the message size is known only to
+ *        the logging function (the last one may continue in the buffer trailer).
+ */
+
+static void rte_sim_read(void)
+{
+    uint32_t end = g_rtedbg.buf_index;
+    if (end == sim.read_index)
+    {
+        return;
+    }
+
+    uint32_t index = sim.read_index;
+    RTE_LIMIT_INDEX(index)
+    rte_dec_push(&stream_dec, (const uint8_t *)&g_rtedbg.buffer[index], (end - index) * 4U);
+    sim.read_index = end;
+}
+
+
+/***
+ * @brief Advance the simulated time. The SYSTICK interrupt routine is executed for
+ *        every counter reload (with a random latency) that occurs before this time.
+ */
+
+static void rte_sim_advance(uint64_t time)
+{
+    for (;;)
+    {
+        uint64_t reload = (sim.overflows + 1U) * ((uint64_t)rte_sim_systick.LOAD + 1U);
+        uint64_t irq_time = reload + rte_sim_random(RTE_SIM_MAX_LATENCY);
+        if (irq_time > time)
+        {
+            break;
+        }
+
+        sim.overflows++;        // The pending bit is cleared at the interrupt entry
+        rte_sim_set_time(irq_time);
+        SysTick_Handler();
+        rte_sim_read();
+    }
+
+    rte_sim_set_time(time);
+}
+
+
+/***
+ * @brief Check the decoded time of a message logged by the rte_sim_log().
+ *
+ * @return 1 - long timestamp message, 0 - other message
+ */
+
+static uint32_t rte_sim_check(const rte_dec_msg_t *p_msg, const char *p_name)
+{
+    if ((p_msg->fmt_id == RTE_DEC_LONG_TIMESTAMP_ID) && (p_msg->no_words == 1U))
+    {
+        return 1U;
+    }
+
+    uint64_t logged = (uint64_t)p_msg->data[0] | ((uint64_t)p_msg->data[1] << 32U);
+    uint64_t expected = (logged >> RTE_TIMESTAMP_SHIFT) << RTE_TIMESTAMP_SHIFT;
+
+    if ((p_msg->fmt_id != MSG2_SIM_TIME) || (p_msg->no_words != 2U) || (p_msg->timestamp != expected))
+    {
+        if (sim.errors < RTE_SIM_MAX_REPORTS)
+        {
+            fprintf(stderr, "%s: message logged at %.6f s decoded at %.6f s\n", p_name,
+                    (double)logged / RTE_SIM_CLOCK, (double)p_msg->timestamp / RTE_SIM_CLOCK);
+        }
+        sim.errors++;
+    }
+
+    return 0U;
+}
+
+
+static void rte_sim_stream_callback(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_user;
+
+    if (rte_sim_check(p_msg, "stream") != 0U)
+    {
+        sim.long_timestamps++;
+    }
+    else
+    {
+        sim.checked++;
+    }
+}
+
+
+static void rte_sim_snapshot_callback(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    (void)p_user;
+
+    if ((p_msg->fmt_id == RTE_DEC_LONG_TIMESTAMP_ID) && (p_msg->no_words == 1U))
+    {
+        sim.anchored = 1U;
+    }
+    else if (sim.anchored == 0U)
+    {
+        sim.unanchored++;       // The absolute time is not known yet
+        sim.snapshot_unanchored += p_msg->no_words + 1U;    // DATA words and the FMT word
+    }
+    else
+    {
+        (void)rte_sim_check(p_msg, "snapshot");
+        sim.snapshot_checked++;
+    }
+}
+
+
+/***
+ * @brief Log a message with the current simulated time and decode it.
+ */
+
+static void rte_sim_log(uint64_t time)
+{
+    rte_sim_advance(time);
+
+    if ((rte_sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U)
+    {
+        sim.pending_logged++;
+    }
+
+    RTE_MSG2(MSG2_SIM_TIME, F_COM_DEMO, (uint32_t)time, (uint32_t)(time >> 32U));
+    rte_sim_read();
+    sim.messages++;
+
+    if (time >= sim.next_snapshot)
+    {
+        sim.next_snapshot = time + RTE_SIM_SNAPSHOT_TIME;
+        sim.anchored = 0U;
+        sim.snapshot_unanchored = 0U;
+        sim.snapshots++;
+        (void)rte_dec_snapshot(&snapshot_dec, (const uint8_t *)&g_rtedbg, sizeof(g_rtedbg),
+                               rte_sim_snapshot_callback, NULL);
+        if (sim.snapshot_unanchored > sim.max_unanchored)
+        {
+            sim.max_unanchored = sim.snapshot_unanchored;
+        }
+        if (sim.snapshot_unanchored > RTE_SIM_MAX_UNANCHORED)
+        {
+            sim.unanchored_errors++;
+        }
+    }
+}
+
+
+/***
+ * @brief Log messages with random intervals during the time period.
+ *
+ * @param duration      Length of the period [CPU clock cycles]
+ * @param max_interval  Max. time between two messages [CPU clock cycles]
+ */
+
+static void rte_sim_period(uint64_t duration, uint32_t max_interval)
+{
+    uint64_t end = sim.time + duration;
+
+    for (;;)
+    {
+        uint64_t time = sim.time + 1U + rte_sim_random(max_interval);
+        if (time > end)
+        {
+            break;
+        }
+        rte_sim_log(time);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    double hours = 4.0;
+    int opt;
+
+    sim.random = 12345U;
+
+    while ((opt = getopt(argc, argv, "t:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                hours = strtod(optarg, NULL);
+                break;
+
+            case 's':
+                sim.random = (uint32_t)strtoul(optarg, NULL, 0) | 1U;
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-t simulated_hours] [-s random_seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    rte_init(RTE_FORCE_ENABLE_ALL_FILTERS, RTE_RESTART_LOGGING);
+    rte_sim_set_time(0U);
+
+    rte_dec_header_t hdr;
+    if (rte_dec_parse_header(&hdr, (const uint8_t *)&g_rtedbg, sizeof(g_rtedbg)) != RTE_DEC_OK)
+    {
+        fprintf(stderr, "Bad g_rtedbg header\n");
+        return 1;
+    }
+    rte_dec_init(&stream_dec, &hdr, rte_sim_stream_callback, NULL);
+    sim.next_snapshot = RTE_SIM_SNAPSHOT_TIME;
+
+    uint64_t end = (uint64_t)(hours * 3600.0 * RTE_SIM_CLOCK);
+    while (sim.time < end)
+    {
+        switch (rte_sim_random(4U))
+        {
+            case 0U:    // Busy - up to 5 s, messages every 0 ... 100 us
+                rte_sim_period(rte_sim_random(5U * RTE_SIM_CLOCK), RTE_SIM_CLOCK / 10000U);
+                break;
+
+            case 1U:    // Sparse - up to 1 min, messages every 0 ... 500 ms
+                rte_sim_period(rte_sim_random(60U * RTE_SIM_CLOCK), RTE_SIM_CLOCK / 2U);
+                break;
+
+            case 2U:    // Around the SYSTICK period - up to 10 s, messages every 0 ... 4 periods
+                rte_sim_period(rte_sim_random(10U * RTE_SIM_CLOCK), 4U * (rte_sim_systick.LOAD + 1U));
+                break;
+
+            default:    // Pause - up to 10 min without messages
+                rte_sim_log(sim.time + ((uint64_t)rte_sim_random(600U) * RTE_SIM_CLOCK)
+                            + rte_sim_random(RTE_SIM_CLOCK));
+                break;
+        }
+    }
+
+    rte_dec_flush(&stream_dec);
+
+    // With the rtedbg_timer_systick.h, the rte_long_timestamp() must be called at least
+    // once per half short timestamp period (2^23 CPU clock cycles) - see rte_dec_emit().
+    double periodic = (double)sim.time / (double)(1UL << 23U);
+    printf("# result,value\n");
+    printf("simulated_hours,%.2f\n", (double)sim.time / RTE_SIM_CLOCK / 3600.0);
+    printf("messages,%llu\n", (unsigned long long)sim.messages);
+    printf("messages_checked,%llu\n", (unsigned long long)sim.checked);
+    printf("logged_with_pending_overflow,%llu\n", (unsigned long long)sim.pending_logged);
+    printf("systick_interrupts,%llu\n", (unsigned long long)sim.overflows);
+    printf("long_timestamps,%llu\n", (unsigned long long)sim.long_timestamps);
+    printf("long_timestamps_periodic,%.0f\n", periodic);
+    printf("snapshots,%llu\n", (unsigned long long)sim.snapshots);
+    printf("snapshot_messages_checked,%llu\n", (unsigned long long)sim.snapshot_checked);
+    printf("snapshot_messages_unanchored,%llu\n", (unsigned long long)sim.unanchored);
+    printf("snapshot_max_unanchored_words,%u\n", sim.max_unanchored);
+    printf("snapshots_over_unanchored_limit,%llu\n", (unsigned long long)sim.unanchored_errors);
+    printf("errors,%llu\n", (unsigned long long)sim.errors);
+
+    if ((sim.errors != 0U) || (sim.checked != sim.messages) || (sim.unanchored_errors != 0U))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*==== End of file ====*/
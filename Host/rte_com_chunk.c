@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_chunk.c
+ * @author  Branko Premzel
+ * @brief   Host side reader for the data transferred with the RTECOM_READ_CHUNK
+ *          command. Typical use:
+ *          rte_com_chunk_init(&reader, p_buffer, offset, size, chunk_size);
+ *          while ((result = rte_com_chunk_request(&reader, &address, &data)) > 0)
+ *          {
+ *              send the RTECOM_READ_CHUNK command with address and data,
+ *              receive the response (or timeout) and pass it to
+ *              rte_com_chunk_response(&reader, p_response, response_size);
+ *          }
+ *          The result is RTECOM_CHUNK_TOO_MANY_RETRIES if the transfer has been
+ *          aborted (no correct response after reader.max_retries attempts).
+ *          The chunk size must not be larger than the RTECOM_CHUNK_MAX_SIZE
+ *          of the embedded system (the response is not accepted otherwise).
+ *          It is halved after every RTECOM_CHUNK_HALVE_RETRIES consecutive
+ *          failures (down to RTECOM_CHUNK_MIN_SIZE), so that a transfer can
+ *          also be completed over a noisy serial line.
+ ******************************************************************************/
+
+#include <string.h>
+#include "rte_com_chunk.h"
+
+
+/***
+ * @brief Calculate the checksum of the chunk header or data (little-endian words).
+ *        The checksum is rotated left by one bit before each word is added.
+ *
+ * @param checksum Initial checksum value (0 for the start of the chunk header)
+ * @param p_data   Pointer to the data
+ * @param size     Number of bytes (multiple of 4)
+ *
+ * @return Checksum value
+ */
+
+uint32_t rte_com_chunk_checksum(uint32_t checksum, const uint8_t *p_data, uint32_t size)
+{
+    for (uint32_t i = 0U; (i + 4U) <= size; i += 4U)
+    {
+        uint32_t word = (uint32_t)p_data[i] | ((uint32_t)p_data[i + 1U] << 8U)
+                        | ((uint32_t)p_data[i + 2U] << 16U) | ((uint32_t)p_data[i + 3U] << 24U);
+        checksum = ((checksum << 1U) | (checksum >> 31U)) + word;
+    }
+
+    return checksum;
+}
+
+
+/***
+ * @brief Prepare the chunked read of a g_rtedbg block.
+ *
+ * @param p_reader   Pointer to the reader state
+ * @param p_dest     Buffer for the data (at least 'size' bytes)
+ * @param offset     Offset from the start of g_rtedbg (multiple of 4) - the top byte
+ *                   selects the logging context (see RTECOM_CONTEXT_SHIFT)
+ * @param size       Number of bytes to read (multiple of 4)
+ * @param chunk_size Size of a chunk (multiple of 4, max. RTECOM_CHUNK_MAX_SIZE)
+ *
+ * @return RTECOM_CHUNK_OK or RTECOM_CHUNK_BAD_PARAMETER
+ */
+
+int rte_com_chunk_init(rte_com_chunk_reader_t *p_reader, uint8_t *p_dest,
+                       uint32_t offset, uint32_t size, uint32_t chunk_size)
+{
+    memset(p_reader, 0, sizeof(*p_reader));
+
+    if ((((offset | size | chunk_size) & 3U) != 0U) || (chunk_size == 0U)
+        || (chunk_size > RTECOM_CHUNK_SIZE_MASK))
+    {
+        return RTECOM_CHUNK_BAD_PARAMETER;
+    }
+
+    uint32_t no_chunks = (size + chunk_size - 1U) / chunk_size;
+    if (no_chunks > RTECOM_CHUNK_MAX_CHUNKS)
+    {
+        return RTECOM_CHUNK_BAD_PARAMETER;
+    }
+
+    p_reader->p_dest = p_dest;
+    p_reader->offset = offset;
+    p_reader->size = size;
+    p_reader->chunk_size = chunk_size;
+    p_reader->no_chunks = no_chunks;
+    p_reader->no_pending = no_chunks;
+    p_reader->max_retries = RTECOM_CHUNK_MAX_RETRIES;
+    return RTECOM_CHUNK_OK;
+}
+
+
+/***
+ * @brief Halve the chunk size after repeated failures (the size is rounded down to a
+ *        multiple of 4). A new chunk is pending if it overlaps a pending old chunk.
+ *        The size is not changed if it would be smaller than RTECOM_CHUNK_MIN_SIZE
+ *        or if there would be too many chunks.
+ *
+ * @param p_reader  Pointer to the reader state
+ */
+
+static void rte_com_chunk_halve(rte_com_chunk_reader_t *p_reader)
+{
+    uint32_t old_size = p_reader->chunk_size;
+    uint32_t chunk_size = (old_size / 2U) & ~3U;
+    if (chunk_size < RTECOM_CHUNK_MIN_SIZE)
+    {
+        return;
+    }
+
+    uint32_t no_chunks = (p_reader->size + chunk_size - 1U) / chunk_size;
+    if (no_chunks > RTECOM_CHUNK_MAX_CHUNKS)
+    {
+        return;
+    }
+
+    uint8_t received[RTECOM_CHUNK_MAX_CHUNKS];
+    memcpy(received, p_reader->received, p_reader->no_chunks);
+
+    uint32_t no_pending = 0U;
+    for (uint32_t i = 0U; i < no_chunks; i++)
+    {
+        uint32_t end = (i + 1U) * chunk_size;
+        if (end > p_reader->size)
+        {
+            end = p_reader->size;
+        }
+
+        // A new chunk overlaps at most two old chunks
+        p_reader->received[i] = received[(i * chunk_size) / old_size] & received[(end - 1U) / old_size];
+        if (p_reader->received[i] == 0U)
+        {
+            no_pending++;
+        }
+    }
+
+    p_reader->chunk_size = chunk_size;
+    p_reader->no_chunks = no_chunks;
+    p_reader->no_pending = no_pending;
+    p_reader->next = (p_reader->requested * old_size) / chunk_size;
+}
+
+
+/***
+ * @brief Register a failed response (bad checksum, bad response or timeout).
+ *
+ * @param p_reader  Pointer to the reader state
+ */
+
+static void rte_com_chunk_failed(rte_com_chunk_reader_t *p_reader)
+{
+    p_reader->retries++;
+    p_reader->failures++;
+    if ((p_reader->failures % RTECOM_CHUNK_HALVE_RETRIES) == 0U)
+    {
+        rte_com_chunk_halve(p_reader);
+    }
+}
+
+
+/***
+ * @brief Prepare the parameters of the next RTECOM_READ_CHUNK command.
+ *        Pending chunks are requested in a round-robin order, so a chunk with a
+ *        bad checksum is requested again after the other pending chunks.
+ *
+ * @param p_reader  Pointer to the reader state
+ * @param p_address Address parameter of the command
+ * @param p_data    Data parameter of the command (chunk size and sequence number)
+ *
+ * @return 1 - command prepared, 0 - all chunks have been received,
+ *         RTECOM_CHUNK_TOO_MANY_RETRIES - transfer aborted (max_retries consecutive failures)
+ */
+
+int rte_com_chunk_request(rte_com_chunk_reader_t *p_reader, uint32_t *p_address, uint32_t *p_data)
+{
+    if (p_reader->no_pending == 0U)
+    {
+        return 0;
+    }
+
+    if (p_reader->failures >= p_reader->max_retries)
+    {
+        return RTECOM_CHUNK_TOO_MANY_RETRIES;
+    }
+
+    uint32_t index = p_reader->next;
+    while (p_reader->received[index] != 0U)
+    {
+        index = (index + 1U < p_reader->no_chunks) ? (index + 1U) : 0U;
+    }
+
+    uint32_t position = index * p_reader->chunk_size;
+    uint32_t size = p_reader->size - position;
+    if (size > p_reader->chunk_size)
+    {
+        size = p_reader->chunk_size;
+    }
+
+    *p_address = p_reader->offset + position;
+    *p_data = size | (index << RTECOM_CHUNK_SEQUENCE_SHIFT);   // Sequence number = chunk index
+    p_reader->requested = index;
+    p_reader->next = (index + 1U < p_reader->no_chunks) ? (index + 1U) : 0U;
+    return 1;
+}
+
+
+/***
+ * @brief Check the response to the RTECOM_READ_CHUNK command and store the data.
+ *        The chunk stays pending if the response is not OK. Call the function
+ *        with size = 0 if no response has been received (timeout).
+ *
+ * @param p_reader   Pointer to the reader state
+ * @param p_response Pointer to the response (chunk header, data and checksum)
+ * @param size       Size of the response
+ *
+ * @return RTECOM_CHUNK_OK or error code
+ */
+
+int rte_com_chunk_response(rte_com_chunk_reader_t *p_reader, const uint8_t *p_response, uint32_t size)
+{
+    uint32_t index = p_reader->requested;
+    uint32_t position = index * p_reader->chunk_size;
+    uint32_t chunk_size = p_reader->size - position;
+    if (chunk_size > p_reader->chunk_size)
+    {
+        chunk_size = p_reader->chunk_size;
+    }
+
+    if (p_reader->received[index] != 0U)
+    {
+        return RTECOM_CHUNK_OK;     // Already received (e.g. duplicate response)
+    }
+
+    rtecom_chunk_t header;
+    if (size != (RTECOM_CHUNK_HEADER_SIZE + chunk_size + sizeof(header.checksum)))
+    {
+        rte_com_chunk_failed(p_reader);
+        return RTECOM_CHUNK_BAD_RESPONSE;
+    }
+
+    memcpy(&header, p_response, RTECOM_CHUNK_HEADER_SIZE);
+    memcpy(&header.checksum, &p_response[RTECOM_CHUNK_HEADER_SIZE + chunk_size], sizeof(header.checksum));
+
+    uint32_t checksum = rte_com_chunk_checksum(0U, p_response, RTECOM_CHUNK_HEADER_SIZE + chunk_size);
+    if (checksum != header.checksum)
+    {
+        rte_com_chunk_failed(p_reader);
+        return RTECOM_CHUNK_BAD_CHECKSUM;
+    }
+
+    if ((header.offset != (p_reader->offset + position)) || (header.sequence != (uint16_t)index)
+        || (header.size != chunk_size))
+    {
+        rte_com_chunk_failed(p_reader);
+        return RTECOM_CHUNK_BAD_RESPONSE;
+    }
+
+    memcpy(&p_reader->p_dest[position], &p_response[RTECOM_CHUNK_HEADER_SIZE], chunk_size);
+    p_reader->received[index] = 1U;
+    p_reader->no_pending--;
+    p_reader->failures = 0U;
+    return RTECOM_CHUNK_OK;
+}
+
+/*==== End of file ====*/
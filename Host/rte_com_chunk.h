@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_chunk.h
+ * @author  Branko Premzel
+ * @brief   Host side reader for the RTECOM_READ_CHUNK command. A large block of
+ *          the g_rtedbg structure is read in chunks. Chunks with a bad checksum
+ *          (or missing response) stay pending and are requested again, so a
+ *          transfer error does not require reading the complete block again.
+ *          See the rtecom_chunk_t description in the rte_com.h.
+ ******************************************************************************/
+
+#ifndef RTE_COM_CHUNK_H
+#define RTE_COM_CHUNK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "rte_com.h"
+
+#define RTECOM_CHUNK_MAX_CHUNKS     4096U   // Max. number of chunks in one transfer
+#define RTECOM_CHUNK_MAX_RETRIES    64U     // Default max. number of consecutive failed responses
+#define RTECOM_CHUNK_HALVE_RETRIES  4U      // The chunk size is halved after this number of consecutive failures
+#define RTECOM_CHUNK_MIN_SIZE       64U     // The chunk size is not halved below this size [bytes]
+
+#define RTECOM_CHUNK_OK             0   // Chunk received and stored
+#define RTECOM_CHUNK_BAD_CHECKSUM   -1  // Chunk checksum not OK - the chunk will be requested again
+#define RTECOM_CHUNK_BAD_RESPONSE   -2  // NACK, truncated response or unexpected chunk header
+#define RTECOM_CHUNK_BAD_PARAMETER  -3  // Size or offset not a multiple of 4, too many chunks
+#define RTECOM_CHUNK_TOO_MANY_RETRIES -4 // Transfer aborted - max_retries consecutive failed responses
+
+typedef struct
+{
+    uint8_t *p_dest;        // Buffer for the data (size bytes)
+    uint32_t offset;        // Address parameter of the first chunk (offset and context index)
+    uint32_t size;          // Number of bytes to read
+    uint32_t chunk_size;    // Size of a chunk [bytes]
+    uint32_t no_chunks;     // Number of chunks
+    uint32_t no_pending;    // Number of chunks not yet received
+    uint32_t next;          // Index of the chunk to be checked first for the next request
+    uint32_t requested;     // Index of the last requested chunk
+    uint32_t retries;       // Number of chunks requested again
+    uint32_t failures;      // Number of consecutive failed responses
+    uint32_t max_retries;   // Max. number of consecutive failed responses (default RTECOM_CHUNK_MAX_RETRIES)
+    uint8_t received[RTECOM_CHUNK_MAX_CHUNKS];  // 1 - chunk received correctly
+} rte_com_chunk_reader_t;
+
+uint32_t rte_com_chunk_checksum(uint32_t checksum, const uint8_t *p_data, uint32_t size);
+    // Calculate the checksum of the chunk header and data (as the rte_com.c does)
+int rte_com_chunk_init(rte_com_chunk_reader_t *p_reader, uint8_t *p_dest,
+                       uint32_t offset, uint32_t size, uint32_t chunk_size);
+    // Prepare the reading of 'size' bytes from the g_rtedbg 'offset'
+int rte_com_chunk_request(rte_com_chunk_reader_t *p_reader, uint32_t *p_address, uint32_t *p_data);
+    // Get the parameters of the next RTECOM_READ_CHUNK command (returns 1 - command prepared,
+    // 0 - all chunks received or RTECOM_CHUNK_TOO_MANY_RETRIES)
+int rte_com_chunk_response(rte_com_chunk_reader_t *p_reader, const uint8_t *p_response, uint32_t size);
+    // Check and store the response to the last request (without the CRC-32 if enabled)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTE_COM_CHUNK_H
+
+/*==== End of file ====*/
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_crc.c
+ * @author  Branko Premzel
+ * @brief   Host side CRC-32 calculation for the RTEcomLib messages.
+ *          CRC-32/MPEG-2: polynomial 0x04C11DB7, initial value 0xFFFFFFFF,
+ *          bits not reflected, no final XOR (check value 0x0376E6E7).
+ ******************************************************************************/
+
+#include "rte_com_crc.h"
+
+#define RTE_COM_CRC_POLYNOMIAL  0x04C11DB7U
+
+static uint32_t crc_table[256];
+static int crc_table_ready;
+
+
+/***
+ * @brief Prepare the table for the calculation of eight bits at a time.
+ */
+
+static void rte_com_crc_init_table(void)
+{
+    for (uint32_t i = 0U; i < 256U; i++)
+    {
+        uint32_t crc = i << 24U;
+        for (uint32_t bit = 0U; bit < 8U; bit++)
+        {
+            crc = (crc & 0x80000000U) ? ((crc << 1U) ^ RTE_COM_CRC_POLYNOMIAL) : (crc << 1U);
+        }
+        crc_table[i] = crc;
+    }
+
+    crc_table_ready = 1;
+}
+
+
+/***
+ * @brief Add data to the CRC-32.
+ *
+ * @param crc     Current CRC value (RTE_COM_CRC_INIT for the first block)
+ * @param p_data  Pointer to the data
+ * @param size    Number of bytes
+ *
+ * @return New CRC value
+ */
+
+uint32_t rte_com_crc32(uint32_t crc, const void *p_data, size_t size)
+{
+    const uint8_t *p_byte = (const uint8_t *)p_data;
+
+    if (!crc_table_ready)
+    {
+        rte_com_crc_init_table();
+    }
+
+    while (size > 0U)
+    {
+        crc = (crc << 8U) ^ crc_table[(crc >> 24U) ^ *p_byte++];
+        size--;
+    }
+
+    return crc;
+}
+
+
+/***
+ * @brief Append the CRC-32 of the command, address and data bytes to a message.
+ *        The XOR checksum (second byte) must already be set.
+ *
+ * @param p_msg  Pointer to the 10-byte message followed by space for the CRC (4 bytes)
+ */
+
+void rte_com_crc_message(uint8_t *p_msg)
+{
+    uint32_t crc = rte_com_crc32(RTE_COM_CRC_INIT, p_msg, 1U);
+    crc = rte_com_crc32(crc, &p_msg[2], 8U);
+
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        p_msg[10U + i] = (uint8_t)(crc >> (8U * i));    // Little endian
+    }
+}
+
+/*==== End of file ====*/
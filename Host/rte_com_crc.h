@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_crc.h
+ * @author  Branko Premzel
+ * @brief   Host side CRC-32 calculation for the optional CRC protection of the
+ *          RTEcomLib messages (RTECOM_CRC_ENABLED == 1). See the description of
+ *          the RTECOM_CRC_INIT in the rte_com.h.
+ ******************************************************************************/
+
+#ifndef RTE_COM_CRC_H
+#define RTE_COM_CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RTE_COM_CRC_INIT  0xFFFFFFFFU   // Same value as RTECOM_CRC_INIT in the rte_com.h
+
+uint32_t rte_com_crc32(uint32_t crc, const void *p_data, size_t size);
+    // Add data to the CRC-32 (start with crc = RTE_COM_CRC_INIT)
+void rte_com_crc_message(uint8_t *p_msg);
+    // Append the CRC-32 to a 10-byte message (p_msg must have space for 14 bytes)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTE_COM_CRC_H
+
+/*==== End of file ====*/
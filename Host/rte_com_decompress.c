@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_decompress.c
+ * @author  Branko Premzel
+ * @brief   Host side decoder for the data transferred with the
+ *          RTECOM_READ_COMPRESSED command. The decoded words are the same as if
+ *          they were read with the RTECOM_READ_RTEDBG command.
+ ******************************************************************************/
+
+#include <string.h>
+#include "rte_com_decompress.h"
+
+#define RTE_ERASED_STATE_WORD  0xFFFFFFFFU  // Same value as RTE_ERASED_STATE in the rtedbg.h
+
+
+/***
+ * @brief Decode the data received with the RTECOM_READ_COMPRESSED command.
+ *
+ * @param p_src      Pointer to the encoded data (after the 4-byte response header)
+ * @param size       Size of the encoded data (the 'size' field of the response header)
+ * @param p_dst      Pointer to the buffer for decoded words
+ * @param max_words  Size of the buffer for decoded words
+ * @param p_no_words Number of words decoded (should be equal to the 'no_words' response field)
+ *
+ * @return RTECOM_DECOMPRESS_OK or error code
+ */
+
+int rte_com_decompress(const uint8_t *p_src, uint32_t size,
+                       uint32_t *p_dst, uint32_t max_words, uint32_t *p_no_words)
+{
+    const uint8_t *p_end = p_src + size;
+    uint32_t no_words = 0U;
+    int result = RTECOM_DECOMPRESS_OK;
+
+    while (p_src < p_end)
+    {
+        uint32_t token = *p_src++;
+        uint32_t run = (token & ~RTECOM_RLE_TYPE_MASK) + 1U;
+        uint32_t type = token & RTECOM_RLE_TYPE_MASK;
+        uint32_t word = 0U;
+
+        if (run > (max_words - no_words))
+        {
+            result = RTECOM_DECOMPRESS_OVERFLOW;
+            break;
+        }
+
+        if (type == RTECOM_RLE_LITERAL)
+        {
+            if ((uint32_t)(p_end - p_src) < (run * 4U))
+            {
+                result = RTECOM_DECOMPRESS_BAD_DATA;
+                break;
+            }
+            memcpy(&p_dst[no_words], p_src, run * 4U);
+            p_src += run * 4U;
+            no_words += run;
+            continue;
+        }
+
+        if (type == RTECOM_RLE_ERASED)
+        {
+            word = RTE_ERASED_STATE_WORD;
+        }
+        else if (type == RTECOM_RLE_REPEAT)
+        {
+            if ((p_end - p_src) < 4)
+            {
+                result = RTECOM_DECOMPRESS_BAD_DATA;
+                break;
+            }
+            memcpy(&word, p_src, 4U);
+            p_src += 4U;
+        }
+
+        for (uint32_t i = 0U; i < run; i++)
+        {
+            p_dst[no_words++] = word;
+        }
+    }
+
+    *p_no_words = no_words;
+    return result;
+}
+
+
+/***
+ * @brief Decode the complete response of the RTECOM_READ_COMPRESSED command - the
+ *        4-byte header followed by the encoded data or by the words not encoded
+ *        (size = RTECOM_COMPRESSED_RAW).
+ *
+ * @param p_response    Pointer to the response (without the CRC)
+ * @param response_size Size of the response
+ * @param p_dst         Pointer to the buffer for decoded words
+ * @param max_words     Size of the buffer for decoded words
+ * @param p_no_words    Number of words decoded (equal to the 'no_words' header field)
+ *
+ * @return RTECOM_DECOMPRESS_OK or error code
+ */
+
+int rte_com_decompress_response(const uint8_t *p_response, uint32_t response_size,
+                                 uint32_t *p_dst, uint32_t max_words, uint32_t *p_no_words)
+{
+    uint16_t header[2];     // Number of words, size of the encoded data
+    *p_no_words = 0U;
+
+    if (response_size < 4U)
+    {
+        return RTECOM_DECOMPRESS_BAD_DATA;
+    }
+    memcpy(header, p_response, 4U);
+
+    if (header[1] == RTECOM_COMPRESSED_RAW)
+    {
+        if (header[0] > max_words)
+        {
+            return RTECOM_DECOMPRESS_OVERFLOW;
+        }
+        if ((4U + (4U * header[0])) > response_size)
+        {
+            return RTECOM_DECOMPRESS_BAD_DATA;
+        }
+        memcpy(p_dst, &p_response[4], 4U * header[0]);
+        *p_no_words = header[0];
+        return RTECOM_DECOMPRESS_OK;
+    }
+
+    if ((4U + header[1]) > response_size)
+    {
+        return RTECOM_DECOMPRESS_BAD_DATA;
+    }
+    int result = rte_com_decompress(&p_response[4], header[1], p_dst, max_words, p_no_words);
+    if ((result == RTECOM_DECOMPRESS_OK) && (*p_no_words != header[0]))
+    {
+        result = RTECOM_DECOMPRESS_BAD_DATA;
+    }
+
+    return result;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_com_decompress.h
+ * @author  Branko Premzel
+ * @brief   Host side decoder for the data transferred with the
+ *          RTECOM_READ_COMPRESSED command (run-length encoded g_rtedbg words).
+ *          See the RTECOM_RLE_* token definitions in the rte_com.h.
+ ******************************************************************************/
+
+#ifndef RTE_COM_DECOMPRESS_H
+#define RTE_COM_DECOMPRESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "rte_com.h"
+
+#define RTECOM_DECOMPRESS_OK        0   // Data decoded successfully
+#define RTECOM_DECOMPRESS_BAD_DATA  -1  // Token incomplete (encoded data truncated)
+#define RTECOM_DECOMPRESS_OVERFLOW  -2  // Decoded data does not fit into the output buffer
+
+int rte_com_decompress(const uint8_t *p_src, uint32_t size,
+                       uint32_t *p_dst, uint32_t max_words, uint32_t *p_no_words);
+    // Decode the run-length encoded data block (without the 4-byte response header)
+int rte_com_decompress_response(const uint8_t *p_response, uint32_t response_size,
+                                uint32_t *p_dst, uint32_t max_words, uint32_t *p_no_words);
+    // Decode the complete response (header + encoded or uncompressed words)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTE_COM_DECOMPRESS_H
+
+/*==== End of file ====*/
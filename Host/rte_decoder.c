@@ -0,0 +1,739 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_decoder.c
+ * @author  Branko Premzel
+ * @brief   Host side streaming decoder for the g_rtedbg binary data format.
+ *
+ *          Every message consists of one or more subpackets. A subpacket
+ *          contains zero to four DATA words followed by the FMT word:
+ *          *) DATA word: bits 31 .. 1 = bits 30 .. 0 of the logged data word,
+ *             bit 0 = 0,
+ *          *) FMT word:  top RTE_FMT_ID_BITS bits = format ID with bits 31 of the
+ *             DATA words in the lowest bits (first DATA word = highest bit),
+ *             remaining bits = timestamp, bit 0 = 1.
+ *          The subpackets of a long message (__rte_msgn(), __rte_msgx(), __rte_stringn())
+ *          all have four DATA words (except the last one), the same timestamp and
+ *          the same format ID. The value 0xFFFFFFFF marks a word that has been
+ *          reserved but not (yet) written.
+ ******************************************************************************/
+
+#include <string.h>
+#include "rte_decoder.h"
+
+
+/***
+ * @brief Decode the g_rtedbg header.
+ *
+ * @param p_hdr   Pointer to the structure for the decoded values
+ * @param p_data  Pointer to the snapshot data (starts with the g_rtedbg header)
+ * @param size    Size of the snapshot data [bytes]
+ *
+ * @return RTE_DEC_OK or RTE_DEC_BAD_HEADER
+ */
+
+int rte_dec_parse_header(rte_dec_header_t *p_hdr, const uint8_t *p_data, size_t size)
+{
+    uint32_t header[RTE_DEC_HEADER_WORDS];
+
+    if (size < sizeof(header))
+    {
+        return RTE_DEC_BAD_HEADER;
+    }
+
+    memcpy(header, p_data, sizeof(header));
+    uint32_t cfg = header[2];
+    memset(p_hdr, 0, sizeof(*p_hdr));
+    p_hdr->buf_index           = header[0];
+    p_hdr->filter              = header[1];
+    p_hdr->timestamp_frequency = header[3];
+    p_hdr->buffer_size         = header[5];
+    p_hdr->single_shot         = cfg & 1U;
+    p_hdr->filtering           = (cfg >> 1U) & 1U;
+    p_hdr->long_timestamp      = (cfg >> 4U) & 1U;
+    p_hdr->context             = (cfg >> 5U) & 7U;
+    p_hdr->timestamp_shift     = ((cfg >> 8U) & 0x0FU) + 1U;
+    p_hdr->fmt_id_bits         = ((cfg >> 12U) & 7U) + 9U;
+    p_hdr->max_subpackets      = (cfg >> 16U) & 0xFFU;
+    p_hdr->header_words        = (cfg >> 24U) & 0x7FU;
+    p_hdr->size_power_of_2     = cfg >> 31U;
+
+    if (p_hdr->max_subpackets == 0U)
+    {
+        p_hdr->max_subpackets = 256U;
+    }
+
+    if ((p_hdr->header_words < RTE_DEC_HEADER_WORDS)
+        || ((size_t)p_hdr->header_words * 4U > size)
+        || (p_hdr->buffer_size <= 4U))
+    {
+        return RTE_DEC_BAD_HEADER;
+    }
+
+    return RTE_DEC_OK;
+}
+
+
+/***
+ * @brief Prepare the decoder for a new data stream.
+ *
+ * @param p_dec     Pointer to the decoder state
+ * @param p_hdr     Logging configuration (only the RTE_FMT_ID_BITS, RTE_TIMESTAMP_SHIFT
+ *                  and RTE_MAX_SUBPACKETS values are used for decoding)
+ * @param callback  Function called for every decoded message
+ * @param p_user    Parameter passed to the callback function
+ */
+
+void rte_dec_init(rte_decoder_t *p_dec, const rte_dec_header_t *p_hdr,
+                  rte_dec_callback_t callback, void *p_user)
+{
+    memset(p_dec, 0, offsetof(rte_decoder_t, data));
+    p_dec->hdr = *p_hdr;
+    p_dec->callback = callback;
+    p_dec->p_user = p_user;
+    p_dec->join_subpackets = 1U;
+}
+
+
+/***
+ * @brief Pass the pending message to the callback function.
+ */
+
+static void rte_dec_emit(rte_decoder_t *p_dec)
+{
+    if (p_dec->msg_subpackets == 0U)
+    {
+        return;
+    }
+
+    // Extend the timestamp to 64 bits. A small step back is not a timer overflow, because
+    // the timestamp is read before the buffer space is reserved and an interrupt may log
+    // a message with a newer timestamp in the meantime.
+    uint32_t tstamp_bits = 31U - p_dec->hdr.fmt_id_bits;
+    uint32_t period = 1U << tstamp_bits;
+    if (p_dec->tstamp_valid == 0U)
+    {
+        p_dec->timestamp = p_dec->msg_tstamp;
+        p_dec->tstamp_valid = 1U;
+    }
+    else
+    {
+        uint32_t diff = (p_dec->msg_tstamp - p_dec->last_tstamp) & (period - 1U);
+        if (diff < (period / 2U))
+        {
+            p_dec->timestamp += diff;
+        }
+        else
+        {
+            p_dec->timestamp -= period - diff;
+        }
+    }
+    p_dec->last_tstamp = p_dec->msg_tstamp;
+
+    // The long timestamp message contains the timestamp bits above the short timestamp.
+    // The value 0xFFFFFFFF is logged by the RTE_RESTART_TIMING() - the timer has been restarted.
+    if ((p_dec->hdr.long_timestamp != 0U) && (p_dec->msg_fmt == RTE_DEC_LONG_TIMESTAMP_ID)
+        && (p_dec->msg_words == 1U))
+    {
+        uint64_t high = (p_dec->data[0] != 0xFFFFFFFFU) ? p_dec->data[0] : 0U;
+        p_dec->timestamp = (high << tstamp_bits) | p_dec->msg_tstamp;
+    }
+
+    rte_dec_msg_t msg;
+    msg.fmt_id = p_dec->msg_fmt;
+    msg.no_words = p_dec->msg_words;
+    msg.no_subpackets = p_dec->msg_subpackets;
+    msg.context = p_dec->hdr.context;
+    msg.timestamp = p_dec->timestamp << p_dec->hdr.timestamp_shift;
+    msg.data = p_dec->data;
+    p_dec->msg_subpackets = 0U;
+    p_dec->stats.messages++;
+
+    if (p_dec->callback != NULL)
+    {
+        p_dec->callback(&msg, p_dec->p_user);
+    }
+}
+
+
+/***
+ * @brief Decode the FMT word and the DATA words of the current subpacket.
+ */
+
+static void rte_dec_subpacket(rte_decoder_t *p_dec, uint32_t fmt_word)
+{
+    uint32_t no_raw = p_dec->no_raw;
+    uint32_t fmt = fmt_word >> (32U - p_dec->hdr.fmt_id_bits);
+    uint32_t tstamp = (fmt_word & (0xFFFFFFFFU >> p_dec->hdr.fmt_id_bits)) >> 1U;
+    uint32_t fmt_id = fmt & ~((1U << no_raw) - 1U);
+
+    p_dec->stats.subpackets++;
+    p_dec->no_raw = 0U;
+
+    // Continuation of a long message? The previous subpacket must have been a full one.
+    if ((p_dec->msg_subpackets != 0U)
+        && ((p_dec->msg_fmt >> 4U) != (fmt >> 4U)
+            || (p_dec->msg_tstamp != tstamp)
+            || (p_dec->msg_subpackets >= p_dec->hdr.max_subpackets)))
+    {
+        rte_dec_emit(p_dec);
+    }
+
+    if (p_dec->msg_subpackets == 0U)
+    {
+        p_dec->msg_fmt = fmt_id;
+        p_dec->msg_tstamp = tstamp;
+        p_dec->msg_words = 0U;
+    }
+
+    uint32_t *p_dst = &p_dec->data[p_dec->msg_words];
+    for (uint32_t i = 0U; i < no_raw; i++)
+    {
+        p_dst[i] = (p_dec->raw[i] >> 1U) | (((fmt >> (no_raw - 1U - i)) & 1U) << 31U);
+    }
+
+    p_dec->msg_words += no_raw;
+    p_dec->msg_subpackets++;
+
+    // Only a subpacket with four DATA words can be followed by a continuation
+    if ((no_raw < 4U) || (p_dec->join_subpackets == 0U))
+    {
+        rte_dec_emit(p_dec);
+    }
+}
+
+
+/***
+ * @brief Decode one circular buffer word.
+ */
+
+static inline void rte_dec_word(rte_decoder_t *p_dec, uint32_t word)
+{
+    if (word == RTE_DEC_ERASED_WORD)
+    {
+        // Space reserved but not written - the message is incomplete
+        p_dec->stats.erased_words++;
+        p_dec->stats.discarded_words += p_dec->no_raw;
+        p_dec->no_raw = 0U;
+        rte_dec_emit(p_dec);
+    }
+    else if ((word & 1U) == 0U)
+    {
+        if (p_dec->skip_to_fmt != 0U)
+        {
+            p_dec->stats.discarded_words++;
+        }
+        else
+        {
+            if (p_dec->no_raw >= 4U)
+            {
+                // More than four DATA words in a row - discard the oldest one
+                p_dec->stats.discarded_words++;
+                memmove(&p_dec->raw[0], &p_dec->raw[1], 3U * sizeof(uint32_t));
+                p_dec->no_raw = 3U;
+            }
+            p_dec->raw[p_dec->no_raw++] = word;
+        }
+    }
+    else if (p_dec->skip_to_fmt != 0U)
+    {
+        p_dec->skip_to_fmt = 0U;
+        p_dec->stats.discarded_words++;
+    }
+    else
+    {
+        rte_dec_subpacket(p_dec, word);
+    }
+}
+
+
+/***
+ * @brief Decode a block of the circular buffer data. The block size does not have to be
+ *        divisible by four - an incomplete word is completed with the next block.
+ *
+ * @param p_dec   Pointer to the decoder state
+ * @param p_data  Pointer to the data (little endian 32-bit words)
+ * @param size    Number of bytes
+ */
+
+void rte_dec_push(rte_decoder_t *p_dec, const uint8_t *p_data, size_t size)
+{
+    // Complete the word from the previous block
+    while ((p_dec->partial_bytes != 0U) && (size > 0U))
+    {
+        p_dec->partial_word |= (uint32_t)*p_data++ << (8U * p_dec->partial_bytes);
+        size--;
+
+        if (++p_dec->partial_bytes == 4U)
+        {
+            rte_dec_word(p_dec, p_dec->partial_word);
+            p_dec->partial_bytes = 0U;
+            p_dec->partial_word = 0U;
+        }
+    }
+
+    while (size >= 4U)
+    {
+        uint32_t word = (uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8U)
+                      | ((uint32_t)p_data[2] << 16U) | ((uint32_t)p_data[3] << 24U);
+        rte_dec_word(p_dec, word);
+        p_data += 4U;
+        size -= 4U;
+    }
+
+    while (size > 0U)
+    {
+        p_dec->partial_word |= (uint32_t)*p_data++ << (8U * p_dec->partial_bytes);
+        p_dec->partial_bytes++;
+        size--;
+    }
+}
+
+
+/***
+ * @brief Pass the pending message to the callback function. Call it at the end of the
+ *        data stream, since a message with a full last subpacket stays pending until
+ *        the next word shows that it is not continued.
+ */
+
+void rte_dec_flush(rte_decoder_t *p_dec)
+{
+    p_dec->stats.discarded_words += p_dec->no_raw;
+    p_dec->no_raw = 0U;
+    rte_dec_emit(p_dec);
+}
+
+
+/***
+ * @brief Read a little endian word from the snapshot data.
+ */
+
+static uint32_t rte_dec_get_word(const uint8_t *p_data)
+{
+    return (uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8U)
+         | ((uint32_t)p_data[2] << 16U) | ((uint32_t)p_data[3] << 24U);
+}
+
+
+/***
+ * @brief Decode the data of a circular buffer in the post-mortem mode.
+ *
+ * The oldest data is at the buf_index position. The words up to the first FMT word are
+ * discarded there, since the start of the oldest message has been overwritten. A subpacket
+ * that starts at the end of the buffer continues in the four-word trailer. The rest of the
+ * trailer is not valid. If the buffer size is a power of 2, the next subpacket starts at
+ * the buffer position equal to the number of trailer words used (see the RTE_LIMIT_INDEX()).
+ * Otherwise, it starts at the buffer beginning.
+ *
+ * @param p_dec        Pointer to the decoder state
+ * @param p_buffer     Pointer to the circular buffer data
+ * @param buffer_size  Buffer size including the four-word trailer [words]
+ * @param buf_index    Index of the next message (oldest data)
+ * @param power_of_2   1 - the buffer size (without the trailer) is a power of 2
+ */
+
+static void rte_dec_ring(rte_decoder_t *p_dec, const uint8_t *p_buffer, size_t buffer_size,
+                         size_t buf_index, uint32_t power_of_2)
+{
+    size_t buffer_end = buffer_size - 4U;   // RTE_BUFFER_SIZE
+    size_t start = buf_index;
+    size_t wrap_start = 0U;
+
+    if (start >= buffer_end)
+    {
+        /* The last message ended in the trailer or continued at the buffer start.
+         * A message with several subpackets can end more than four words after
+         * the buffer end (its next subpackets continue after the trailer words used). */
+        start = (power_of_2 != 0U) ? (start - buffer_end) : 0U;
+        if (start >= buffer_end)
+        {
+            start = 0U;     // Invalid buf_index
+        }
+    }
+
+    if (rte_dec_get_word(p_buffer + (start * 4U)) != RTE_DEC_ERASED_WORD)
+    {
+        p_dec->skip_to_fmt = 1U;
+    }
+
+    rte_dec_push(p_dec, p_buffer + (start * 4U), (buffer_end - start) * 4U);
+
+    // Complete the subpacket which continues in the trailer
+    size_t trailer = 0U;
+    while ((trailer < 4U) && (p_dec->no_raw != 0U))
+    {
+        rte_dec_word(p_dec, rte_dec_get_word(p_buffer + ((buffer_end + trailer) * 4U)));
+        trailer++;
+    }
+
+    if (power_of_2 != 0U)
+    {
+        wrap_start = trailer;
+    }
+
+    if (start > wrap_start)
+    {
+        rte_dec_push(p_dec, p_buffer + (wrap_start * 4U), (start - wrap_start) * 4U);
+    }
+}
+
+
+/***
+ * @brief Decode the circular buffer of a snapshot - see rte_dec_snapshot().
+ *
+ * @param p_dec     Pointer to the decoder state (initialized with the snapshot header)
+ * @param p_buffer  Pointer to the circular buffer data
+ * @param no_words  Number of circular buffer words in the snapshot
+ */
+
+static void rte_dec_buffer(rte_decoder_t *p_dec, const uint8_t *p_buffer, size_t no_words)
+{
+    const rte_dec_header_t *p_hdr = &p_dec->hdr;
+
+    if (no_words < p_hdr->buffer_size)
+    {
+        // Incomplete snapshot - decode the available data only
+        rte_dec_push(p_dec, p_buffer, no_words * 4U);
+    }
+    else if (p_hdr->single_shot != 0U)
+    {
+        size_t index = (p_hdr->buf_index < p_hdr->buffer_size) ? p_hdr->buf_index : p_hdr->buffer_size;
+        rte_dec_push(p_dec, p_buffer, index * 4U);
+    }
+    else
+    {
+        rte_dec_ring(p_dec, p_buffer, p_hdr->buffer_size, p_hdr->buf_index, p_hdr->size_power_of_2);
+    }
+
+    rte_dec_flush(p_dec);
+}
+
+
+/***
+ * @brief Decode a complete g_rtedbg snapshot - header followed by the circular buffer
+ *        (e.g. the Data.bin file created by the RTEgetData utility).
+ *        In the post-mortem mode, the decoding starts with the oldest data at the
+ *        buf_index position (see rte_dec_ring()). In the single shot mode, only the
+ *        data up to buf_index is decoded.
+ *
+ * @param p_dec     Pointer to the decoder state
+ * @param p_data    Pointer to the snapshot data
+ * @param size      Size of the snapshot data [bytes]
+ * @param callback  Function called for every decoded message
+ * @param p_user    Parameter passed to the callback function
+ *
+ * @return RTE_DEC_OK or RTE_DEC_BAD_HEADER
+ */
+
+int rte_dec_snapshot(rte_decoder_t *p_dec, const uint8_t *p_data, size_t size,
+                     rte_dec_callback_t callback, void *p_user)
+{
+    rte_dec_header_t hdr;
+    int result = rte_dec_parse_header(&hdr, p_data, size);
+    if (result != RTE_DEC_OK)
+    {
+        return result;
+    }
+
+    rte_dec_init(p_dec, &hdr, callback, p_user);
+    rte_dec_buffer(p_dec, p_data + (hdr.header_words * 4U), (size / 4U) - hdr.header_words);
+    return RTE_DEC_OK;
+}
+
+
+/***
+ * @brief Store a message decoded from the priority region.
+ */
+
+static void rte_dec_priority_store(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    rte_dec_priority_t *p_prio = (rte_dec_priority_t *)p_user;
+
+    if ((p_prio->no_msgs >= RTE_DEC_MAX_PRIORITY_MSGS)
+        || (p_msg->no_words > (RTE_DEC_MAX_PRIORITY_WORDS - p_prio->no_words)))
+    {
+        return;
+    }
+
+    rte_dec_priority_msg_t *p_stored = &p_prio->msg[p_prio->no_msgs++];
+    p_stored->fmt_id = p_msg->fmt_id;
+    p_stored->no_words = p_msg->no_words;
+    p_stored->no_subpackets = p_msg->no_subpackets;
+    p_stored->timestamp = p_msg->timestamp;
+    p_stored->offset = p_prio->no_words;
+    p_stored->in_buffer = 0U;
+    memcpy(&p_prio->data[p_prio->no_words], p_msg->data, p_msg->no_words * sizeof(uint32_t));
+    p_prio->no_words += p_msg->no_words;
+}
+
+
+/***
+ * @brief Mark the priority messages that are also in the circular buffer. The
+ *        messages are compared by the format ID, data and the logged (not extended)
+ *        timestamp value.
+ */
+
+static void rte_dec_priority_match(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    rte_dec_priority_t *p_prio = (rte_dec_priority_t *)p_user;
+    uint64_t tstamp_mask = ((uint64_t)1U << (31U - p_prio->fmt_id_bits)) - 1U;
+    uint64_t tstamp = (p_msg->timestamp >> p_prio->timestamp_shift) & tstamp_mask;
+
+    for (uint32_t i = 0U; i < p_prio->no_msgs; i++)
+    {
+        rte_dec_priority_msg_t *p_stored = &p_prio->msg[i];
+        if ((p_stored->in_buffer == 0U)
+            && (p_stored->fmt_id == p_msg->fmt_id)
+            && (p_stored->no_words == p_msg->no_words)
+            && (((p_stored->timestamp >> p_prio->timestamp_shift) & tstamp_mask) == tstamp)
+            && (memcmp(&p_prio->data[p_stored->offset], p_msg->data,
+                       p_msg->no_words * sizeof(uint32_t)) == 0))
+        {
+            p_stored->in_buffer = 1U;
+            break;
+        }
+    }
+}
+
+
+/***
+ * @brief Decode a g_rtedbg snapshot with the priority region (RTE_PRIORITY_BUFFER_SIZE)
+ *        and merge the messages of both circular buffers.
+ *
+ * The priority messages are logged to the circular buffer and copied to the priority
+ * region. A priority message that is no longer in the circular buffer has been overwritten
+ * there - it is older than all messages in the circular buffer. Such messages are passed
+ * to the callback first (in the order and with the timestamps decoded from the priority
+ * region), followed by all messages of the circular buffer. Priority messages that are
+ * still in the circular buffer are therefore reported only once and in the right order,
+ * even if the short timestamps of both buffers have wrapped around several times.
+ * If the snapshot does not contain the priority region, the function is the same as
+ * the rte_dec_snapshot().
+ *
+ * @param p_dec     Pointer to the decoder state
+ * @param p_prio    Pointer to the memory for the priority messages
+ * @param p_data    Pointer to the snapshot data (complete g_rtedbg structure)
+ * @param size      Size of the snapshot data [bytes]
+ * @param callback  Function called for every decoded message
+ * @param p_user    Parameter passed to the callback function
+ *
+ * @return RTE_DEC_OK or RTE_DEC_BAD_HEADER
+ */
+
+int rte_dec_snapshot_merged(rte_decoder_t *p_dec, rte_dec_priority_t *p_prio,
+                            const uint8_t *p_data, size_t size,
+                            rte_dec_callback_t callback, void *p_user)
+{
+    rte_dec_header_t hdr;
+    int result = rte_dec_parse_header(&hdr, p_data, size);
+    if (result != RTE_DEC_OK)
+    {
+        return result;
+    }
+
+    // The priority region follows the circular buffer: index, filter, size and the buffer.
+    size_t region = (size_t)hdr.header_words + hdr.buffer_size;
+    if ((size / 4U) < (region + 3U))
+    {
+        return rte_dec_snapshot(p_dec, p_data, size, callback, p_user);
+    }
+
+    uint32_t priority_index = rte_dec_get_word(p_data + (region * 4U));
+    uint32_t priority_size = rte_dec_get_word(p_data + ((region + 2U) * 4U));
+    uint32_t region_size = priority_size - 4U;
+    if ((priority_size <= 4U) || ((region_size & (region_size - 1U)) != 0U)
+        || ((size / 4U) < (region + 3U + priority_size)))
+    {
+        return rte_dec_snapshot(p_dec, p_data, size, callback, p_user);
+    }
+
+    const uint8_t *p_buffer = p_data + (hdr.header_words * 4U);
+    size_t no_words = hdr.buffer_size;
+    p_prio->no_msgs = 0U;
+    p_prio->no_words = 0U;
+    p_prio->fmt_id_bits = hdr.fmt_id_bits;
+    p_prio->timestamp_shift = hdr.timestamp_shift;
+
+    // Decode the priority region (the index is not limited to the region size)
+    rte_dec_init(p_dec, &hdr, rte_dec_priority_store, p_prio);
+    rte_dec_ring(p_dec, p_data + ((region + 3U) * 4U), priority_size,
+                 priority_index & (region_size - 1U), 1U);
+    rte_dec_flush(p_dec);
+
+    // Find the priority messages that are still in the circular buffer
+    rte_dec_init(p_dec, &hdr, rte_dec_priority_match, p_prio);
+    rte_dec_buffer(p_dec, p_buffer, no_words);
+
+    for (uint32_t i = 0U; i < p_prio->no_msgs; i++)
+    {
+        const rte_dec_priority_msg_t *p_stored = &p_prio->msg[i];
+        if ((p_stored->in_buffer == 0U) && (callback != NULL))
+        {
+            rte_dec_msg_t msg;
+            msg.fmt_id = p_stored->fmt_id;
+            msg.no_words = p_stored->no_words;
+            msg.no_subpackets = p_stored->no_subpackets;
+            msg.context = hdr.context;
+            msg.timestamp = p_stored->timestamp;
+            msg.data = &p_prio->data[p_stored->offset];
+            callback(&msg, p_user);
+        }
+    }
+
+    rte_dec_init(p_dec, &hdr, callback, p_user);
+    rte_dec_buffer(p_dec, p_buffer, no_words);
+    return RTE_DEC_OK;
+}
+
+/***
+ * @brief Store a message of a logging context (see rte_dec_contexts_merged()).
+ *        The messages logged before the first long timestamp of the snapshot have
+ *        timestamps relative to the first message. They are moved to the absolute
+ *        time when the first long timestamp message is found.
+ */
+
+static void rte_dec_context_store(const rte_dec_msg_t *p_msg, void *p_user)
+{
+    rte_dec_contexts_t *p_ctx = (rte_dec_contexts_t *)p_user;
+
+    if ((p_ctx->anchored == 0U) && (p_msg->fmt_id == RTE_DEC_LONG_TIMESTAMP_ID)
+        && (p_msg->no_words == 1U))
+    {
+        p_ctx->anchored = 1U;
+
+        if (p_ctx->no_msgs > p_ctx->first)
+        {
+            // Timestamp of this message relative to the previous one (as without the long timestamp)
+            uint64_t period = (uint64_t)1U << (31U - p_ctx->fmt_id_bits);
+            uint64_t last = p_ctx->p_msg[p_ctx->no_msgs - 1U].timestamp >> p_ctx->timestamp_shift;
+            uint64_t absolute = p_msg->timestamp >> p_ctx->timestamp_shift;
+            uint64_t diff = (absolute - last) & (period - 1U);
+            uint64_t relative = (diff < (period / 2U)) ? (last + diff) : (last - (period - diff));
+            uint64_t offset = (absolute - relative) << p_ctx->timestamp_shift;
+
+            for (uint32_t i = p_ctx->first; i < p_ctx->no_msgs; i++)
+            {
+                p_ctx->p_msg[i].timestamp += offset;
+            }
+        }
+    }
+
+    if ((p_ctx->no_msgs >= p_ctx->max_msgs)
+        || (p_msg->no_words > (p_ctx->max_words - p_ctx->no_words)))
+    {
+        p_ctx->dropped++;
+        return;
+    }
+
+    rte_dec_context_msg_t *p_stored = &p_ctx->p_msg[p_ctx->no_msgs++];
+    p_stored->fmt_id = p_msg->fmt_id;
+    p_stored->no_words = p_msg->no_words;
+    p_stored->no_subpackets = p_msg->no_subpackets;
+    p_stored->context = p_msg->context;
+    p_stored->timestamp = p_msg->timestamp;
+    p_stored->offset = p_ctx->no_words;
+    memcpy(&p_ctx->p_data[p_ctx->no_words], p_msg->data, p_msg->no_words * sizeof(uint32_t));
+    p_ctx->no_words += p_msg->no_words;
+}
+
+
+/***
+ * @brief Decode the snapshots of several logging contexts (g_rtedbg and g_rtedbg_ctx[] -
+ *        see the RTE_NO_OF_CONTEXTS) and pass their messages to the callback function
+ *        in the timestamp order.
+ *
+ * Each snapshot is decoded separately (see rte_dec_snapshot()) and its messages are stored
+ * in the memory provided by the caller. The timestamps of a context are absolute from its
+ * first long timestamp message on - the RTEdbg library logs the long timestamp to all
+ * contexts. The messages before it are moved to the absolute time as well. A snapshot
+ * without a long timestamp message keeps the timestamps relative to its first message and
+ * is merged correctly only if all contexts have been logged without a long timestamp.
+ * The messages are then merged - messages with the same timestamp are reported in the
+ * order of the snapshots. The rte_dec_msg_t.context contains the context index.
+ * Messages that do not fit into the memory are counted in the p_ctx->dropped.
+ *
+ * @param p_dec         Pointer to the decoder state
+ * @param p_ctx         Memory for the messages (p_msg, max_msgs, p_data and max_words set)
+ * @param p_data        Pointers to the snapshot data of each context
+ * @param size          Sizes of the snapshots [bytes]
+ * @param no_snapshots  Number of snapshots (1 .. RTE_DEC_MAX_CONTEXTS)
+ * @param callback      Function called for every decoded message
+ * @param p_user        Parameter passed to the callback function
+ *
+ * @return RTE_DEC_OK or RTE_DEC_BAD_HEADER (the messages are not reported in this case)
+ */
+
+int rte_dec_contexts_merged(rte_decoder_t *p_dec, rte_dec_contexts_t *p_ctx,
+                            const uint8_t * const p_data[], const size_t size[],
+                            uint32_t no_snapshots, rte_dec_callback_t callback, void *p_user)
+{
+    uint32_t next[RTE_DEC_MAX_CONTEXTS];    // Index of the next message of each snapshot
+    uint32_t end[RTE_DEC_MAX_CONTEXTS];     // Index after the last message of each snapshot
+
+    if ((no_snapshots == 0U) || (no_snapshots > RTE_DEC_MAX_CONTEXTS))
+    {
+        return RTE_DEC_BAD_HEADER;
+    }
+
+    p_ctx->no_msgs = 0U;
+    p_ctx->no_words = 0U;
+    p_ctx->dropped = 0U;
+
+    for (uint32_t i = 0U; i < no_snapshots; i++)
+    {
+        rte_dec_header_t hdr;
+        int result = rte_dec_parse_header(&hdr, p_data[i], size[i]);
+        if (result != RTE_DEC_OK)
+        {
+            return result;
+        }
+
+        p_ctx->first = p_ctx->no_msgs;
+        p_ctx->anchored = (hdr.long_timestamp != 0U) ? 0U : 1U;
+        p_ctx->fmt_id_bits = hdr.fmt_id_bits;
+        p_ctx->timestamp_shift = hdr.timestamp_shift;
+        (void)rte_dec_snapshot(p_dec, p_data[i], size[i], rte_dec_context_store, p_ctx);
+        next[i] = p_ctx->first;
+        end[i] = p_ctx->no_msgs;
+    }
+
+    for (;;)
+    {
+        uint32_t selected = no_snapshots;
+        for (uint32_t i = 0U; i < no_snapshots; i++)
+        {
+            if ((next[i] < end[i])
+                && ((selected == no_snapshots)
+                    || (p_ctx->p_msg[next[i]].timestamp < p_ctx->p_msg[next[selected]].timestamp)))
+            {
+                selected = i;
+            }
+        }
+
+        if (selected == no_snapshots)
+        {
+            break;
+        }
+
+        const rte_dec_context_msg_t *p_stored = &p_ctx->p_msg[next[selected]++];
+        if (callback != NULL)
+        {
+            rte_dec_msg_t msg;
+            msg.fmt_id = p_stored->fmt_id;
+            msg.no_words = p_stored->no_words;
+            msg.no_subpackets = p_stored->no_subpackets;
+            msg.context = p_stored->context;
+            msg.timestamp = p_stored->timestamp;
+            msg.data = &p_ctx->p_data[p_stored->offset];
+            callback(&msg, p_user);
+        }
+    }
+
+    return RTE_DEC_OK;
+}
+
+/*==== End of file ====*/
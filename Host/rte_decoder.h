@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rte_decoder.h
+ * @author  Branko Premzel
+ * @brief   Host side streaming decoder for the g_rtedbg binary data format.
+ *
+ *          The decoder splits the circular buffer words into messages in the
+ *          same way as they were written by the __rte_msg0() ... __rte_msgn()
+ *          functions. Bit 31 of every DATA word is restored from the FMT word
+ *          and the subpackets of long messages are joined together. The decoded
+ *          messages are passed to a callback function as soon as they are
+ *          complete. The data can therefore be decoded while it is received
+ *          from the embedded system - in blocks of any size.
+ *
+ *          The decoder does not use the format definition files. The messages
+ *          are reported with the format ID, timestamp and raw data words only.
+ *          Use the RTEmsg application to print the messages with format strings.
+ ******************************************************************************/
+
+#ifndef RTE_DECODER_H
+#define RTE_DECODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RTE_DEC_HEADER_WORDS    6U      // Minimal size of the g_rtedbg header (32-bit words)
+#define RTE_DEC_ERASED_WORD     0xFFFFFFFFU // Same value as RTE_ERASED_STATE in the rtedbg.h
+#define RTE_DEC_MAX_SUBPACKETS  256U    // Max. value of the RTE_MAX_SUBPACKETS
+#define RTE_DEC_MAX_WORDS       (4U * RTE_DEC_MAX_SUBPACKETS)  // Max. message size [words]
+
+#define RTE_DEC_LONG_TIMESTAMP_ID 0U     // Format ID of the MSG1_LONG_TIMESTAMP (rte_system_fmt.h)
+
+#define RTE_DEC_OK              0       // Data decoded successfully
+#define RTE_DEC_BAD_HEADER      -1      // Header incomplete or values out of range
+
+
+/* Logging configuration - decoded from the g_rtedbg header (see the rtedbg_int.h). */
+typedef struct
+{
+    uint32_t fmt_id_bits;       // RTE_FMT_ID_BITS (9 .. 16)
+    uint32_t timestamp_shift;   // RTE_TIMESTAMP_SHIFT (1 .. 16)
+    uint32_t max_subpackets;    // RTE_MAX_SUBPACKETS (1 .. 256)
+    uint32_t header_words;      // Size of the g_rtedbg header (number of 32-bit words)
+    uint32_t context;           // Logging context index (0 = g_rtedbg)
+    uint32_t single_shot;       // 1 - single shot logging was active, 0 - post-mortem logging
+    uint32_t long_timestamp;    // RTE_USE_LONG_TIMESTAMP
+    uint32_t filtering;         // RTE_MSG_FILTERING_ENABLED
+    uint32_t size_power_of_2;   // 1 - the buffer size is a power of 2
+    uint32_t buf_index;         // Value of the g_rtedbg.buf_index
+    uint32_t filter;            // Value of the g_rtedbg.filter
+    uint32_t timestamp_frequency; // Timestamp timer frequency [Hz]
+    uint32_t buffer_size;       // Circular buffer size including the four-word trailer
+} rte_dec_header_t;
+
+
+/* Decoded message passed to the callback function. */
+typedef struct
+{
+    uint32_t fmt_id;            // Format ID (without the bits 31 of the DATA words)
+    uint32_t no_words;          // Number of DATA words
+    uint32_t no_subpackets;     // Number of subpackets the message was stored in
+    uint32_t context;           // Logging context index (from the snapshot header)
+    uint64_t timestamp;         // Timestamp extended to 64 bits [timestamp timer counts] - absolute
+                                // after the first long timestamp message (MSG1_LONG_TIMESTAMP)
+    const uint32_t *data;       // DATA words (valid during the callback only)
+} rte_dec_msg_t;
+
+typedef void (*rte_dec_callback_t)(const rte_dec_msg_t *p_msg, void *p_user);
+
+
+/* Decoding statistics */
+typedef struct
+{
+    uint32_t messages;          // Number of messages passed to the callback function
+    uint32_t subpackets;        // Number of subpackets (FMT words) decoded
+    uint32_t erased_words;      // Number of 0xFFFFFFFF words (reserved but not written)
+    uint32_t discarded_words;   // Number of DATA words without a matching FMT word
+} rte_dec_stats_t;
+
+
+/* Decoder state - the caller provides the memory (no dynamic memory allocation). */
+typedef struct
+{
+    rte_dec_header_t hdr;
+    rte_dec_callback_t callback;
+    void *p_user;
+    rte_dec_stats_t stats;
+    uint32_t join_subpackets;   // 1 - join subpackets of long messages (default)
+    uint32_t skip_to_fmt;       // 1 - discard words until the next FMT word
+    uint32_t partial_word;      // Bytes of an incomplete word (byte stream)
+    uint32_t partial_bytes;     // Number of bytes in the partial_word
+    uint32_t raw[4];            // DATA words of the current subpacket
+    uint32_t no_raw;            // Number of words in raw[]
+    uint32_t msg_fmt;           // Pending message: FMT word format ID field
+    uint32_t msg_tstamp;        // Pending message: raw timestamp
+    uint32_t msg_subpackets;    // Pending message: number of subpackets (0 = no message)
+    uint32_t msg_words;         // Pending message: number of words in data[]
+    uint32_t last_tstamp;       // Raw value of the last timestamp
+    uint64_t timestamp;         // Last timestamp extended to 64 bits [raw timestamp units]
+    uint32_t tstamp_valid;      // 1 - the last_tstamp and timestamp are valid
+    uint32_t data[RTE_DEC_MAX_WORDS];
+} rte_decoder_t;
+
+
+/* Messages decoded from the priority region (see rte_dec_snapshot_merged()). */
+#define RTE_DEC_MAX_PRIORITY_MSGS   1024U   // Max. number of messages in the priority region
+#define RTE_DEC_MAX_PRIORITY_WORDS  8192U   // Max. number of their DATA words
+
+typedef struct
+{
+    uint32_t fmt_id;            // Format ID
+    uint32_t no_words;          // Number of DATA words
+    uint32_t no_subpackets;     // Number of subpackets
+    uint32_t offset;            // Index of the first DATA word in the data[]
+    uint32_t in_buffer;         // 1 - the message is also in the circular buffer
+    uint64_t timestamp;         // Timestamp decoded from the priority region
+} rte_dec_priority_msg_t;
+
+typedef struct
+{
+    uint32_t no_msgs;           // Number of messages in the msg[]
+    uint32_t no_words;          // Number of words in the data[]
+    uint32_t fmt_id_bits;       // RTE_FMT_ID_BITS (from the header)
+    uint32_t timestamp_shift;   // RTE_TIMESTAMP_SHIFT (from the header)
+    rte_dec_priority_msg_t msg[RTE_DEC_MAX_PRIORITY_MSGS];
+    uint32_t data[RTE_DEC_MAX_PRIORITY_WORDS];
+} rte_dec_priority_t;
+
+
+/* Messages of several logging contexts (see rte_dec_contexts_merged()). The caller
+ * provides the memory for the messages and their DATA words. */
+#define RTE_DEC_MAX_CONTEXTS    8U      // Max. value of the RTE_NO_OF_CONTEXTS
+
+typedef struct
+{
+    uint32_t fmt_id;            // Format ID
+    uint32_t no_words;          // Number of DATA words
+    uint32_t no_subpackets;     // Number of subpackets
+    uint32_t offset;            // Index of the first DATA word in the p_data[]
+    uint32_t context;           // Logging context index
+    uint64_t timestamp;         // Extended timestamp
+} rte_dec_context_msg_t;
+
+typedef struct
+{
+    rte_dec_context_msg_t *p_msg; // Memory for the messages
+    uint32_t max_msgs;          // Number of elements of the p_msg[]
+    uint32_t *p_data;           // Memory for the DATA words
+    uint32_t max_words;         // Number of elements of the p_data[]
+    uint32_t no_msgs;           // Number of messages stored
+    uint32_t no_words;          // Number of DATA words stored
+    uint32_t dropped;           // Number of messages not stored (not enough memory)
+    uint32_t first;             // Index of the first message of the snapshot being decoded
+    uint32_t anchored;          // 1 - a long timestamp has been found in this snapshot
+    uint32_t fmt_id_bits;       // RTE_FMT_ID_BITS (from the header)
+    uint32_t timestamp_shift;   // RTE_TIMESTAMP_SHIFT (from the header)
+} rte_dec_contexts_t;
+
+
+int  rte_dec_parse_header(rte_dec_header_t *p_hdr, const uint8_t *p_data, size_t size);
+    // Decode the g_rtedbg header (first bytes of a snapshot)
+void rte_dec_init(rte_decoder_t *p_dec, const rte_dec_header_t *p_hdr,
+                  rte_dec_callback_t callback, void *p_user);
+    // Prepare the decoder for a new data stream
+void rte_dec_push(rte_decoder_t *p_dec, const uint8_t *p_data, size_t size);
+    // Decode a block of circular buffer data (any size - little endian words)
+void rte_dec_flush(rte_decoder_t *p_dec);
+    // Pass the last (pending) message to the callback function
+int  rte_dec_snapshot(rte_decoder_t *p_dec, const uint8_t *p_data, size_t size,
+                      rte_dec_callback_t callback, void *p_user);
+    // Decode a complete g_rtedbg snapshot (header + circular buffer - e.g. Data.bin)
+int  rte_dec_snapshot_merged(rte_decoder_t *p_dec, rte_dec_priority_t *p_prio,
+                             const uint8_t *p_data, size_t size,
+                             rte_dec_callback_t callback, void *p_user);
+    // Decode a snapshot with the priority region and merge the messages of both buffers
+int  rte_dec_contexts_merged(rte_decoder_t *p_dec, rte_dec_contexts_t *p_ctx,
+                             const uint8_t * const p_data[], const size_t size[],
+                             uint32_t no_snapshots, rte_dec_callback_t callback, void *p_user);
+    // Decode the snapshots of several logging contexts and merge the messages by timestamp
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTE_DECODER_H
+
+/*==== End of file ====*/
@@ -25,6 +25,871 @@
 
 /* Global variable */
 rtecom_recv_data_t g_rtecom;    // Working variable for rte_com_byte_received()
+static_assert((offsetof(rtecom_recv_data_t, command) + RTECOM_RECV_PACKET_LEN) <= sizeof(rtecom_recv_data_t),
+              "The received message does not fit into the rtecom_recv_data_t structure.");
+#if RTECOM_BATCH_ENABLED == 1
+rtecom_batch_t g_rtecom_batch;  // Sub-commands and short responses of the RTECOM_BATCH command
+#endif
+
+
+#if RTECOM_CRC_ENABLED == 1
+#if !defined RTECOM_CRC_HW
+/* The CRC-32 is calculated with a 16-entry table (four bits at a time) if the serial
+ * driver does not calculate it with a CRC peripheral (see the rte_com_STM32_driver.h).
+ * It takes roughly 15 to 20 CPU cycles per byte on a Cortex-M3/M4 and is calculated in the
+ * receive interrupt - e.g. about 2 ms for an 8 kB read at 72 MHz.
+ */
+static const uint32_t rte_com_crc_table[16] =
+{
+    0x00000000U, 0x04C11DB7U, 0x09823B6EU, 0x0D4326D9U, 0x130476DCU, 0x17C56B6BU, 0x1A864DB2U, 0x1E475005U,
+    0x2608EDB8U, 0x22C9F00FU, 0x2F8AD6D6U, 0x2B4BCB61U, 0x350C9B64U, 0x31CD86D3U, 0x3C8EA00AU, 0x384FBDBDU
+};
+
+static uint32_t rte_com_crc_value = RTECOM_CRC_INIT;
+
+__STATIC_FORCEINLINE void rte_com_crc_reset(void)
+{
+    rte_com_crc_value = RTECOM_CRC_INIT;
+}
+
+static void rte_com_crc_update(const uint8_t *p_data, uint32_t size)
+{
+    uint32_t crc = rte_com_crc_value;
+
+    while (size > 0U)
+    {
+        uint32_t data = *p_data++;
+        crc = (crc << 4U) ^ rte_com_crc_table[(crc >> 28U) ^ (data >> 4U)];
+        crc = (crc << 4U) ^ rte_com_crc_table[(crc >> 28U) ^ (data & 0x0FU)];
+        size--;
+    }
+
+    rte_com_crc_value = crc;
+}
+
+__STATIC_FORCEINLINE uint32_t rte_com_crc_result(void)
+{
+    return rte_com_crc_value;
+}
+#endif // !defined RTECOM_CRC_HW
+
+
+/***
+ * @brief Send data to the host and add it to the CRC-32 of the response.
+ *
+ * @param p_data Pointer to the data to be sent
+ * @param size   Number of bytes to send
+ */
+
+__STATIC_FORCEINLINE void rte_com_send(const uint8_t *p_data, uint32_t size)
+{
+    rte_com_crc_update(p_data, size);
+    rte_com_send_data(p_data, size);
+}
+
+
+/***
+ * @brief Send the CRC-32 of the response and prepare the calculation for the next one.
+ *        The CRC is stored in the g_rtecom since it is sent after this function returns
+ *        (DMA transfer).
+ */
+
+static void rte_com_send_crc(void)
+{
+    g_rtecom.crc = rte_com_crc_result();
+    rte_com_crc_reset();
+    rte_com_send_data((const uint8_t *)&g_rtecom.crc, RTECOM_CRC_SIZE);
+}
+
+
+/***
+ * @brief Check the CRC-32 of the received message (command, address and data bytes).
+ *
+ * @return 1 - CRC is OK, 0 - not OK
+ */
+
+static uint32_t rte_com_crc_ok(void)
+{
+    rte_com_crc_reset();
+    rte_com_crc_update(&g_rtecom.command, 1U);
+    rte_com_crc_update((const uint8_t *)&g_rtecom.address, 8U);
+    uint32_t crc = rte_com_crc_result();
+    rte_com_crc_reset();    // Start the calculation for the response
+
+    return (crc == g_rtecom.crc) ? 1U : 0U;
+}
+#else
+#define rte_com_send(p_data, size)  rte_com_send_data(p_data, size)
+#endif // RTECOM_CRC_ENABLED == 1
+
+
+/***
+ * @brief Get the data logging structure (context or bank) selected by the top byte of the
+ *        address parameter and remove the context index from the address. The address is left
+ *        unchanged for an invalid context index. It is then outside of the data structure
+ *        and NACK is returned.
+ *
+ * @param p_address Pointer to the address parameter of a command
+ *
+ * @return Pointer to the g_rtedbg, g_rtedbg_ctx[] or g_rtedbg_bank data structure
+ */
+
+__STATIC_FORCEINLINE rtedbg_t *rte_com_context(uint32_t *p_address)
+{
+#if (RTE_NO_OF_CONTEXTS > 1) || (RTE_DUAL_BANK_ENABLED == 1)
+    uint32_t context = *p_address >> RTECOM_CONTEXT_SHIFT;
+    if (context < ((uint32_t)(RTE_NO_OF_CONTEXTS) + (uint32_t)(RTE_DUAL_BANK_ENABLED)))
+    {
+        *p_address &= (1UL << RTECOM_CONTEXT_SHIFT) - 1U;
+        return rte_context(context);
+    }
+#else
+    UNUSED(p_address);
+#endif
+    return &g_rtedbg;
+}
+
+#if RTECOM_STREAMING_ENABLED == 1
+#if RTE_LAP_COUNTER_ENABLED != 1
+#error "The RTECOM_READ_NEW needs the buffer lap counter - set the RTE_LAP_COUNTER_ENABLED to 1."
+#endif
+
+/* Position of the host in the circular buffer of each logging context (RTECOM_READ_NEW):
+ * index for the next request and the value of the buf_laps at that position. */
+typedef struct
+{
+    uint32_t index_plus_1;  // Index for the next request + 1 (0 = no request yet)
+    uint32_t laps;
+} rtecom_stream_t;
+
+static rtecom_stream_t rtecom_stream[(uint32_t)(RTE_NO_OF_CONTEXTS) + (uint32_t)(RTE_DUAL_BANK_ENABLED)];
+
+
+/***
+ * @brief Get the number of trailer words used by the last subpacket of a buffer lap.
+ *        The FMT word is the last word of a subpacket. If the last buffer word is a DATA
+ *        word, the subpacket continues in the trailer up to and including its FMT word.
+ *
+ * @param p_rtedbg Pointer to the data logging structure
+ *
+ * @return Number of trailer words used (0 ... 4)
+ */
+
+static uint32_t rte_com_trailer_words(const rtedbg_t *p_rtedbg)
+{
+    uint32_t no_words = 0U;
+
+    if ((p_rtedbg->buffer[(uint32_t)(RTE_BUFFER_SIZE) - 1U] & 1U) == 0U)
+    {
+        do
+        {
+            no_words++;
+        }
+        while ((no_words < 4U)
+               && ((p_rtedbg->buffer[(uint32_t)(RTE_BUFFER_SIZE) + no_words - 1U] & 1U) == 0U));
+    }
+
+    return no_words;
+}
+#endif  // RTECOM_STREAMING_ENABLED == 1
+
+#if RTECOM_COMPRESSION_ENABLED == 1
+rtecom_compressed_t g_rtecom_compressed;    // Response of the RTECOM_READ_COMPRESSED command
+
+/***
+ * @brief Encode the data words with the run-length compression (see the RTECOM_RLE_* tokens).
+ *        Erased and zero runs are encoded with a single byte, runs of equal words with
+ *        five bytes. The encoding stops when the output buffer is full.
+ *        The result is in the g_rtecom_compressed structure.
+ *
+ * @param p_src    Pointer to the data words
+ * @param no_words Number of words to be encoded
+ */
+
+static void rte_com_compress(const uint32_t *p_src, uint32_t no_words)
+{
+    uint8_t *p_out = g_rtecom_compressed.data;
+    const uint8_t *p_end = p_out + (RTECOM_COMPRESS_BUFFER_SIZE);
+    uint32_t index = 0U;
+
+    while ((index < no_words) && (p_out < p_end))
+    {
+        uint32_t word = p_src[index];
+        uint32_t max_run = no_words - index;
+        if (max_run > (RTECOM_RLE_MAX_RUN))
+        {
+            max_run = RTECOM_RLE_MAX_RUN;
+        }
+
+        uint32_t run = 1U;
+        while ((run < max_run) && (p_src[index + run] == word))
+        {
+            run++;
+        }
+
+        if ((word == RTE_ERASED_STATE) || (word == 0U))
+        {
+            *p_out++ = (uint8_t)(((word == 0U) ? RTECOM_RLE_ZERO : RTECOM_RLE_ERASED) | (run - 1U));
+        }
+        else if (run > 1U)
+        {
+            if ((p_end - p_out) < 5)
+            {
+                break;
+            }
+            *p_out++ = (uint8_t)(RTECOM_RLE_REPEAT | (run - 1U));
+            memcpy(p_out, &word, 4U);
+            p_out += 4U;
+        }
+        else
+        {
+            // Literal words - up to the next run of equal, erased or zero words
+            uint32_t max_literal = (uint32_t)((p_end - p_out) - 1) / 4U;
+            if (max_run > max_literal)
+            {
+                max_run = max_literal;
+            }
+            if (max_run == 0U)
+            {
+                break;
+            }
+
+            run = 1U;
+            while (run < max_run)
+            {
+                uint32_t next = p_src[index + run];
+                if ((next == RTE_ERASED_STATE) || (next == 0U)
+                    || (((index + run + 1U) < no_words) && (p_src[index + run + 1U] == next)))
+                {
+                    break;
+                }
+                run++;
+            }
+
+            *p_out++ = (uint8_t)(RTECOM_RLE_LITERAL | (run - 1U));
+            memcpy(p_out, &p_src[index], run * 4U);
+            p_out += run * 4U;
+        }
+
+        index += run;
+    }
+
+    g_rtecom_compressed.no_words = (uint16_t)index;
+    g_rtecom_compressed.size = (uint16_t)(p_out - g_rtecom_compressed.data);
+}
+
+
+/***
+ * @brief Find the number of words to be sent uncompressed - up to the first run of
+ *        RTECOM_RLE_MAX_RUN equal words after the words already encoded (e.g. the erased
+ *        part of the circular buffer), which is compressed again by the next command.
+ *
+ * @param p_src    Pointer to the data words
+ * @param start    Number of words already encoded (> 0)
+ * @param no_words Max. number of words
+ *
+ * @return Number of words
+ */
+
+static uint32_t rte_com_raw_words(const uint32_t *p_src, uint32_t start, uint32_t no_words)
+{
+    uint32_t run = 1U;
+
+    for (uint32_t index = start; index < no_words; index++)
+    {
+        if (p_src[index] == p_src[index - 1U])
+        {
+            run++;
+            if (run > (RTECOM_RLE_MAX_RUN))
+            {
+                return index - (RTECOM_RLE_MAX_RUN);
+            }
+        }
+        else
+        {
+            run = 1U;
+        }
+    }
+
+    return no_words;
+}
+#endif // RTECOM_COMPRESSION_ENABLED == 1
+
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+rtecom_chunk_t g_rtecom_chunk;      // Header and checksum of the RTECOM_READ_CHUNK response
+
+/***
+ * @brief Calculate the checksum of the RTECOM_READ_CHUNK response words.
+ *        The checksum is rotated left by one bit before each word is added. The
+ *        order of words is thus also checked. This takes only two instructions per
+ *        word on a Cortex-M core.
+ *
+ * @param checksum Initial checksum value
+ * @param p_data   Pointer to the data words
+ * @param no_words Number of words
+ *
+ * @return Checksum value
+ */
+
+static uint32_t rte_com_chunk_checksum(uint32_t checksum, const uint32_t *p_data, uint32_t no_words)
+{
+    while (no_words > 0U)
+    {
+        checksum = ((checksum << 1U) | (checksum >> 31U)) + *p_data++;
+        no_words--;
+    }
+
+    return checksum;
+}
+#endif // RTECOM_CHUNKED_READ_ENABLED == 1
+
+#if RTECOM_BATCH_ENABLED == 1
+/***
+ * @brief Execute the sub-commands of the RTECOM_BATCH command and send the responses.
+ *        Responses are sent in the same order as the sub-commands. Consecutive short
+ *        responses are copied to a buffer and sent as one block. Longer responses (e.g.
+ *        the circular buffer) are sent directly from the g_rtedbg structure. They are
+ *        transferred by the DMA after this function returns. A RTECOM_WRITE_RTEDBG after
+ *        such a response is therefore executed after the complete response has been sent
+ *        (see the rte_com_tx_idle()) - e.g. the message filter must not be restored while
+ *        the buffer is still being sent. The sub-commands that follow do not see the
+ *        written value.
+ *        The sub-commands are protected by the XOR checksum and by the CRC-32 that follows
+ *        them if the RTECOM_CRC_ENABLED is 1.
+ *
+ * @return Total number of bytes sent to the host.
+ */
+
+static uint32_t rte_com_execute_batch(void)
+{
+    uint32_t checksum = g_rtecom_batch.checksum;
+    uint32_t size = g_rtecom_batch.size - RTECOM_CRC_SIZE;
+    g_rtecom_batch.size = 0U;
+
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        checksum ^= g_rtecom_batch.commands[i];
+    }
+
+#if RTECOM_CRC_ENABLED == 1
+    uint32_t crc;
+    memcpy(&crc, &g_rtecom_batch.commands[size], RTECOM_CRC_SIZE);
+    rte_com_crc_reset();
+    rte_com_crc_update(g_rtecom_batch.commands, size);
+    if (rte_com_crc_result() != crc)
+    {
+        checksum = 1U;      // Bad CRC - no response
+    }
+    rte_com_crc_reset();    // Start the calculation for the response
+#endif
+
+    if (checksum != 0U)
+    {
+        return 0U;      // Bad checksum - no response
+    }
+
+    uint32_t total_size = 0U;
+    uint32_t copied = 0U;   // Number of bytes in the copy buffer
+    uint32_t sent = 0U;     // Number of bytes of the copy buffer already sent
+    uint32_t direct = 0U;   // 1 - a response has been sent directly from the g_rtedbg
+    uint32_t no_deferred = 0U;
+
+    for (uint32_t i = 0U; i < size; i += RTECOM_BATCH_CMD_LEN)
+    {
+        const uint8_t *p_cmd = &g_rtecom_batch.commands[i];
+        uint32_t address;
+        uint32_t data;
+        memcpy(&address, p_cmd + 1U, sizeof(address));
+        memcpy(&data, p_cmd + 5U, sizeof(data));
+
+        const uint8_t *p_data = p_cmd;  // NACK = command value
+        uint32_t data_size = 1U;        // Size of ACK or NACK
+
+        rtedbg_t *p_rtedbg = rte_com_context(&address);
+
+        if (*p_cmd == RTECOM_WRITE_RTEDBG)
+        {
+            if (address < (sizeof(g_rtedbg) / 4U))
+            {
+                if (direct == 0U)
+                {
+                    *(((uint32_t *)p_rtedbg) + address) = data;
+                    p_data = &g_rtecom.checksum;    // ACK (checksum = 0x0F)
+                }
+                else if (no_deferred < (RTECOM_BATCH_DEFERRED_WRITES))
+                {
+                    // Write after the block read directly has been sent (e.g. filter restore).
+                    // NACK is returned if there are too many such writes.
+                    g_rtecom_batch.deferred[no_deferred].p_address = ((uint32_t *)p_rtedbg) + address;
+                    g_rtecom_batch.deferred[no_deferred].data = data;
+                    no_deferred++;
+                    p_data = &g_rtecom.checksum;    // ACK
+                }
+            }
+        }
+        else if (*p_cmd == RTECOM_READ_RTEDBG)
+        {
+            if ((address <= sizeof(g_rtedbg)) && (data <= (sizeof(g_rtedbg) - address)))
+            {
+                p_data = ((const uint8_t *)p_rtedbg) + address;
+                data_size = data;
+            }
+        }
+#if RTE_DUAL_BANK_ENABLED == 1
+        else if (*p_cmd == RTECOM_SWAP_BANKS)
+        {
+            // NACK while the frozen bank may still be sent - by this batch (a block sent
+            // directly) or by the previous response. It would be erased by the swap.
+            if ((direct == 0U) && (rte_com_tx_busy() == 0U))
+            {
+                static uint8_t frozen_bank;     // Response (index of the frozen bank)
+                frozen_bank = (uint8_t)rte_swap_banks();
+                p_data = &frozen_bank;
+            }
+        }
+#endif
+
+        total_size += data_size;
+
+        if (data_size <= ((RTECOM_BATCH_COPY_SIZE) - copied))
+        {
+            memcpy(&g_rtecom_batch.copy[copied], p_data, data_size);
+            copied += data_size;
+        }
+        else
+        {
+            if (copied > sent)
+            {
+                rte_com_send(&g_rtecom_batch.copy[sent], copied - sent);
+                sent = copied;
+            }
+            rte_com_send(p_data, data_size);
+            direct = 1U;
+        }
+    }
+
+    if (copied > sent)
+    {
+        rte_com_send(&g_rtecom_batch.copy[sent], copied - sent);
+    }
+
+#if RTECOM_CRC_ENABLED == 1
+    rte_com_send_crc();     // CRC-32 of the complete batch response
+    total_size += RTECOM_CRC_SIZE;
+#endif
+
+    if (no_deferred != 0U)
+    {
+        // The writes are executed by the rte_com_tx_idle() after the response has been sent.
+        g_rtecom_batch.no_deferred = (uint8_t)no_deferred;
+        if (rte_com_tx_busy() == 0U)
+        {
+            rte_com_tx_idle();  // Already sent (or sent without the DMA)
+        }
+    }
+
+    return total_size;
+}
+
+
+/***
+ * @brief Store the received sub-command bytes of the RTECOM_BATCH command.
+ *        The batch is executed after all sub-command bytes have been received.
+ *
+ * @param p_data Pointer to the received data.
+ * @param size   Number of bytes received.
+ *
+ * @return Number of bytes used.
+ */
+
+static uint32_t rte_com_batch_received(const uint8_t *p_data, uint32_t size)
+{
+    uint32_t no_received = g_rtecom_batch.no_received;
+    uint32_t length = g_rtecom_batch.size - no_received;
+
+    if (length > size)
+    {
+        length = size;
+    }
+
+    memcpy(&g_rtecom_batch.commands[no_received], p_data, length);
+    no_received += length;
+    g_rtecom_batch.no_received = (uint16_t)no_received;
+
+    if (no_received < g_rtecom_batch.size)
+    {
+#if defined RTECOM_TIMEOUT
+        RTECOM_LOG_TIME_LAST_DATA_RECEIVED();   // Set time of the last received data
+#endif
+        return length;
+    }
+
+    uint32_t data_size = rte_com_execute_batch();
+#if RTECOM_SINGLE_WIRE == 1
+    // Set the number of bytes that have to be discarded before reception starts again.
+    g_rtecom.no_received = (uint32_t)(-(int32_t)data_size);
+#else
+    (void)data_size;
+    g_rtecom.no_received = 0U;
+#endif
+    return length;
+}
+#endif // RTECOM_BATCH_ENABLED == 1
+
+
+/***
+ * @brief Execute the RTECOM_WRITE_RTEDBG sub-commands of a batch deferred until the
+ *        response has been sent. The serial driver calls the function after all queued
+ *        data blocks have been sent.
+ */
+
+void rte_com_tx_idle(void)
+{
+#if RTECOM_BATCH_ENABLED == 1
+    uint32_t no_deferred = g_rtecom_batch.no_deferred;
+    g_rtecom_batch.no_deferred = 0U;
+
+    for (uint32_t i = 0U; i < no_deferred; i++)
+    {
+        *g_rtecom_batch.deferred[i].p_address = g_rtecom_batch.deferred[i].data;
+    }
+#endif
+}
+
+
+/***
+ * @brief Execute the command received from the host and send the response.
+ *        The length of the response depends on the command. NACK is sent for
+ *        an unknown command or if the address is not OK.
+ *        The message reception is restarted after the command has been executed.
+ */
+
+static void rte_com_execute_command(void)
+{
+    // NACK is returned if the command (e.g. RTECOM_READ) is not implemented or address not OK.
+    const uint8_t *p_data = &g_rtecom.command;  // NACK = command value
+
+    uint32_t data_size = 1U;                    // Size of ACK or NACK
+    uint32_t command = g_rtecom.command;
+#if (RTECOM_STREAMING_ENABLED == 1) || (RTECOM_CHUNKED_READ_ENABLED == 1) || (RTECOM_COMPRESSION_ENABLED == 1)
+    uint32_t header_size = 0U;                  // Size of the data already sent (if any)
+#endif
+
+    if (command == RTECOM_WRITE_RTEDBG)
+    {
+        // Write 32-bit data to g_rtedbg (e.g. set message filter or index).
+        // The word address must be inside of the g_rtedbg structure.
+        // Returns ACK or NACK if address value is not OK.
+        rtedbg_t *p_rtedbg = rte_com_context(&g_rtecom.address);
+        if (g_rtecom.address < (sizeof(g_rtedbg) / 4U))
+        {
+            *(((uint32_t *)p_rtedbg) + g_rtecom.address) = g_rtecom.data;
+            p_data++;   // ACK (pointer to checksum = 0x0F)
+        }
+    }
+    else if (command == RTECOM_READ_RTEDBG)
+    {
+        // Read data from g_rtedbg data structure
+        // Returns: NN bytes (NN = data parameter – number of bytes requested)
+        rtedbg_t *p_rtedbg = rte_com_context(&g_rtecom.address);
+        if ((data_size + g_rtecom.address) <= sizeof(g_rtedbg))
+        {
+            p_data = ((const uint8_t *)p_rtedbg) + g_rtecom.address;
+            data_size = g_rtecom.data;
+        }
+    }
+
+#if RTECOM_STREAMING_ENABLED == 1
+    else if (command == RTECOM_READ_NEW)
+    {
+        // Read the circular buffer words logged since the last read.
+        // Returns: index for the next request (32-bit) followed by the new words
+        uint32_t context = g_rtecom.address >> RTECOM_CONTEXT_SHIFT;
+        rtedbg_t *p_rtedbg = rte_com_context(&g_rtecom.address);
+        uint32_t index = g_rtecom.address;
+        if (index < ((uint32_t)(RTE_BUFFER_SIZE) + 4U))
+        {
+            rtecom_stream_t *p_stream = &rtecom_stream[context];   // Context is valid here
+
+            // Read the consistent index and lap counter values (the logging may interrupt)
+            uint32_t laps;
+            uint32_t next_index;
+            do
+            {
+                laps = p_rtedbg->buf_laps;
+                next_index = p_rtedbg->buf_index;
+            }
+            while (laps != p_rtedbg->buf_laps);
+
+            if (next_index >= (uint32_t)(RTE_BUFFER_SIZE))
+            {
+                laps++;     // The last message has ended after the buffer end - not counted yet
+            }
+            RTE_LIMIT_INDEX(next_index)
+
+            uint32_t host_laps = p_stream->laps;
+            if (((index + 1U) != p_stream->index_plus_1) || ((laps - host_laps) >= 0x80000000U))
+            {
+                // First or repeated request or the logging has been restarted (lap counter
+                // reset by the rte_init()) - assume that the host is less than one lap behind
+                host_laps = (index <= next_index) ? laps : (laps - 1U);
+            }
+
+            uint32_t overrun = 0U;
+            uint32_t laps_behind = laps - host_laps;
+            if ((laps_behind > 1U) || ((laps_behind == 1U) && (next_index > index)))
+            {
+                // Words not yet transferred have been overwritten - continue with the oldest data
+                overrun = RTECOM_STREAM_OVERRUN;
+                index = next_index;
+                host_laps = laps - 1U;
+                laps_behind = 1U;
+            }
+
+            uint32_t no_words = 0U;
+            uint32_t next_laps = host_laps;
+            if (laps_behind != 0U)
+            {
+                // The logging wrapped around - send the rest of the buffer and the trailer words
+                // used by the last subpacket. If the buffer size is a power of 2, the logging
+                // continues at the position equal to the number of trailer words used (see the
+                // RTE_LIMIT_INDEX()). Otherwise, it continues at the buffer start.
+                uint32_t lap_end = (uint32_t)(RTE_BUFFER_SIZE) + rte_com_trailer_words(p_rtedbg);
+                if (index < lap_end)
+                {
+                    no_words = lap_end - index;
+                }
+                next_index = lap_end;
+                RTE_LIMIT_INDEX(next_index)
+                next_laps++;
+            }
+            else if (next_index >= index)
+            {
+                no_words = next_index - index;
+            }
+            else
+            {
+                next_index = index;     // The lap counter is not updated yet (lock-free driver)
+            }
+
+            if (no_words > g_rtecom.data)
+            {
+                no_words = g_rtecom.data;   // Limit the size to the host request
+                next_index = index + no_words;
+                next_laps = host_laps;
+            }
+            p_stream->index_plus_1 = next_index + 1U;
+            p_stream->laps = next_laps;
+
+            // The header is sent from a dedicated variable since the g_rtecom is
+            // overwritten by the next command while the response is being sent (DMA).
+            static uint32_t next_index_header;
+            next_index_header = next_index | overrun;
+            rte_com_send((const uint8_t *)&next_index_header, sizeof(next_index_header));
+
+            // The buffer words are not included in the CRC-32 of the response (it covers
+            // only the next index). They are read by the DMA after the CRC has been
+            // calculated and the logging may overwrite them in the meantime.
+            data_size = no_words * 4U;
+            if (data_size > 0U)
+            {
+                rte_com_send_data((const uint8_t *)&p_rtedbg->buffer[index], data_size);
+            }
+            header_size = sizeof(next_index_header) + data_size;
+            data_size = 0U;
+        }
+    }
+#endif  // RTECOM_STREAMING_ENABLED == 1
+
+#if RTECOM_BATCH_ENABLED == 1
+    else if (command == RTECOM_BATCH)
+    {
+        // Start the reception of sub-commands. The response is sent after all have been received.
+        // Returns: nothing now or NACK if the number of sub-commands is not OK
+        uint32_t no_commands = g_rtecom.address;
+        if ((no_commands > 0U) && (no_commands <= (RTECOM_BATCH_MAX_COMMANDS)))
+        {
+            g_rtecom_batch.size = (uint16_t)((no_commands * RTECOM_BATCH_CMD_LEN) + RTECOM_CRC_SIZE);
+            g_rtecom_batch.no_received = 0U;
+            g_rtecom_batch.checksum = (uint8_t)g_rtecom.data;
+            data_size = 0U;
+        }
+    }
+#endif  // RTECOM_BATCH_ENABLED == 1
+
+#if RTECOM_COMPRESSION_ENABLED == 1
+    else if (command == RTECOM_READ_COMPRESSED)
+    {
+        // Read g_rtedbg words encoded with the run-length compression
+        // Returns: header (number of words encoded and size of encoded data) + encoded data
+        //          or header (number of words, size = RTECOM_COMPRESSED_RAW) + words not encoded
+        uint32_t address = g_rtecom.address;
+        uint32_t no_words = g_rtecom.data;
+        const rtedbg_t *p_rtedbg = rte_com_context(&address);
+        if (((address & 3U) == 0U) && (address < sizeof(g_rtedbg)))
+        {
+            if (no_words > ((sizeof(g_rtedbg) - address) / 4U))
+            {
+                no_words = (sizeof(g_rtedbg) - address) / 4U;   // Limit to the end of g_rtedbg
+            }
+            if (no_words > (RTECOM_COMPRESS_MAX_WORDS))
+            {
+                no_words = RTECOM_COMPRESS_MAX_WORDS;   // Limit the encoding time in the interrupt
+            }
+            const uint32_t *p_src = ((const uint32_t *)p_rtedbg) + (address / 4U);
+            rte_com_compress(p_src, no_words);
+            if ((g_rtecom_compressed.no_words > 0U)
+                && (g_rtecom_compressed.size >= (4U * g_rtecom_compressed.no_words)))
+            {
+                // No gain - send the words uncompressed directly from the g_rtedbg
+                no_words = rte_com_raw_words(p_src, g_rtecom_compressed.no_words, no_words);
+                g_rtecom_compressed.no_words = (uint16_t)no_words;
+                g_rtecom_compressed.size = RTECOM_COMPRESSED_RAW;
+                rte_com_send((const uint8_t *)&g_rtecom_compressed, 4U);
+                header_size = 4U;
+                p_data = (const uint8_t *)p_src;
+                data_size = 4U * no_words;
+            }
+            else
+            {
+                p_data = (const uint8_t *)&g_rtecom_compressed;
+                data_size = 4U + g_rtecom_compressed.size;
+            }
+        }
+    }
+#endif  // RTECOM_COMPRESSION_ENABLED == 1
+
+#if RTECOM_CHUNKED_READ_ENABLED == 1
+    else if (command == RTECOM_READ_CHUNK)
+    {
+        // Read a chunk of g_rtedbg. The host requests the chunks with a bad checksum again.
+        // Returns: chunk header (offset, sequence number, size) + data + checksum
+        uint32_t address = g_rtecom.address;
+        uint32_t size = g_rtecom.data & RTECOM_CHUNK_SIZE_MASK;
+        const rtedbg_t *p_rtedbg = rte_com_context(&address);
+        if ((((address | size) & 3U) == 0U) && (size > 0U) && (address < sizeof(g_rtedbg)))
+        {
+            if (size > (RTECOM_CHUNK_MAX_SIZE))
+            {
+                size = RTECOM_CHUNK_MAX_SIZE;
+            }
+            if (size > (sizeof(g_rtedbg) - address))
+            {
+                size = sizeof(g_rtedbg) - address;  // Limit to the end of g_rtedbg
+            }
+
+            const uint32_t *p_words = ((const uint32_t *)p_rtedbg) + (address / 4U);
+            g_rtecom_chunk.offset = g_rtecom.address;
+            g_rtecom_chunk.sequence = (uint16_t)(g_rtecom.data >> RTECOM_CHUNK_SEQUENCE_SHIFT);
+            g_rtecom_chunk.size = (uint16_t)size;
+            uint32_t checksum = rte_com_chunk_checksum(0U, (const uint32_t *)&g_rtecom_chunk, 2U);
+            g_rtecom_chunk.checksum = rte_com_chunk_checksum(checksum, p_words, size / 4U);
+
+            // The data words are sent directly from g_rtedbg. Logging should be stopped
+            // (filter = 0) while the chunks are read, otherwise the checksum may not match.
+            rte_com_send((const uint8_t *)&g_rtecom_chunk, RTECOM_CHUNK_HEADER_SIZE);
+            rte_com_send((const uint8_t *)p_words, size);
+            header_size = RTECOM_CHUNK_HEADER_SIZE + size;
+            p_data = (const uint8_t *)&g_rtecom_chunk.checksum;
+            data_size = sizeof(g_rtecom_chunk.checksum);
+        }
+    }
+#endif  // RTECOM_CHUNKED_READ_ENABLED == 1
+
+#if RTE_DUAL_BANK_ENABLED == 1
+    else if (command == RTECOM_SWAP_BANKS)
+    {
+        // Freeze the active bank and continue logging in the other one.
+        // Returns: index of the frozen bank or NACK if the previous response (e.g. the
+        // frozen bank that would be erased by the swap) is still being sent.
+        // The response is sent from a dedicated variable since the g_rtecom is
+        // overwritten by the next command while the response is being sent (DMA).
+        if (rte_com_tx_busy() == 0U)
+        {
+            static uint8_t frozen_bank;
+            frozen_bank = (uint8_t)rte_swap_banks();
+            p_data = &frozen_bank;
+        }
+    }
+#endif  // RTE_DUAL_BANK_ENABLED == 1
+
+    // Enable the following commands it if you also want to be able to read and write
+    // to the embedded system's memory and peripherals for testing purposes.
+    // Add check if address is aligned if the core does not support unaligned access.
+    // Ensure that all data from the specified address to the end address (address + data)
+    // is within the valid memory range (prevent exception in case of bad address).
+#if RTECOM_READ_ENABLED == 1
+    else if (command == RTECOM_READ)
+    {
+        // Read data from the specified address
+        // Returns: NN=size data bytes
+        uint32_t size = g_rtecom.data;
+        uint32_t address = g_rtecom.address;
+        data_size = size;
+        p_data = (const uint8_t *)address;
+#if RTECOM_READ_FROM_PERIPHERALS == 1
+        if ((size == 2U) && ((address & 1U) == 0U))
+        {
+            g_rtecom.data = *(uint16_t *)address;
+            p_data = (const uint8_t *)&g_rtecom.data;
+        }
+        else if ((size == 4U) && ((address & 3U) == 0U))
+        {
+            g_rtecom.data = *(uint32_t *)address;
+            p_data = (const uint8_t *)&g_rtecom.data;
+
+        }
+#endif // RTECOM_READ_FROM_PERIPHERALS == 1
+    }
+#if RTECOM_WRITE_ENABLED == 1
+    else if (command == RTECOM_WRITE32)
+    {
+        // Write 32-bit data to the specified address
+        // Returns: ACK
+        *(uint32_t *)g_rtecom.address = g_rtecom.data;
+        p_data++;   // ACK (pointer to checksum = 0x0F)
+    }
+    else if (command == RTECOM_WRITE16)
+    {
+        // Write 16-bit data to the specified address
+        // Returns: ACK
+        *(uint16_t *)g_rtecom.address = (uint16_t)g_rtecom.data;
+        p_data++;   // ACK (pointer to checksum = 0x0F)
+    }
+    else if (command == RTECOM_WRITE8)
+    {
+        // Write 8-bit data to the specified address
+        // Returns: ACK
+            *(uint8_t *)g_rtecom.address = (uint8_t)g_rtecom.data;
+        p_data++;   // ACK (pointer to checksum = 0x0F)
+    }
+#endif  // RTECOM_WRITE_ENABLED == 1
+#endif  // RTECOM_READ_ENABLED == 1
+
+    if (data_size > 0U)
+    {
+        rte_com_send(p_data, data_size);        // Send the data to host
+    }
+
+#if (RTECOM_STREAMING_ENABLED == 1) || (RTECOM_CHUNKED_READ_ENABLED == 1) || (RTECOM_COMPRESSION_ENABLED == 1)
+    data_size += header_size;
+#endif
+#if RTECOM_CRC_ENABLED == 1
+    if (data_size > 0U)
+    {
+        rte_com_send_crc();                     // CRC-32 of the complete response
+        data_size += RTECOM_CRC_SIZE;
+    }
+#endif
+
+#if RTECOM_SINGLE_WIRE == 1
+    // Set the number of bytes that have to be discarded before reception starts again.
+    g_rtecom.no_received = (uint32_t)(-(int32_t)data_size);
+#else
+    g_rtecom.no_received = 0U;
+#endif
+}
+
 
 /***
  * @brief Processing of data received through the serial channel.
@@ -49,6 +914,19 @@ void rte_com_byte_received(uint8_t data, uint32_t errors)
     }
 #endif
 
+#if RTECOM_BATCH_ENABLED == 1
+    if (g_rtecom_batch.size != 0U)
+    {
+        if (errors != 0U)
+        {
+            g_rtecom_batch.size = 0U;   // Discard the batch
+            return;
+        }
+        (void)rte_com_batch_received(&data, 1U);
+        return;
+    }
+#endif
+
     if ((errors == 0U)                              // No error during reception?
         && (!((no_received == 0U) && (data >= RTECOM_LAST_COMMAND))) // Correct command?
 #if RTECOM_SINGLE_WIRE != 1
@@ -56,9 +934,15 @@ void rte_com_byte_received(uint8_t data, uint32_t errors)
 #endif
        )
     {
-        uint32_t checksum = g_rtecom.checksum ^ data;
+        uint32_t checksum = g_rtecom.checksum;
+#if RTECOM_CRC_ENABLED == 1
+        if (no_received < (RTECOM_RECV_PACKET_LEN - RTECOM_CRC_SIZE))  // CRC is not included
+#endif
+        {
+            checksum ^= data;
+        }
         g_rtecom.checksum = (uint8_t)checksum;
-        *(((uint8_t *)&g_rtecom.command) + no_received) = (uint8_t)data; // Assemble message
+        RTECOM_FRAME_BYTES(&g_rtecom)[no_received] = (uint8_t)data;   // Assemble message
         ++no_received;
         g_rtecom.no_received = no_received;
 
@@ -71,104 +955,130 @@ void rte_com_byte_received(uint8_t data, uint32_t errors)
             return;
         }
 
-        if (checksum == RTECOM_CHECKSUM)
+        if ((checksum == RTECOM_CHECKSUM)
+#if RTECOM_CRC_ENABLED == 1
+            && (rte_com_crc_ok() != 0U)
+#endif
+           )
         {
-            // NACK is returned if the command (e.g. RTECOM_READ) is not implemented or address not OK.
-            const uint8_t *p_data = &g_rtecom.command;  // NACK = command value
+            rte_com_execute_command();
+            return;
+        }
+    }
 
-            uint32_t data_size = 1U;                    // Size of ACK or NACK
-            uint32_t command = g_rtecom.command;
+    g_rtecom.no_received = 0U;
+}
 
-            if (command == RTECOM_WRITE_RTEDBG)
-            {
-                // Write 32-bit data to g_rtedbg (e.g. set message filter or index).
-                // The word address must be inside of the g_rtedbg structure.
-                // Returns ACK or NACK if address value is not OK.
-                if (g_rtecom.address < (sizeof(g_rtedbg) / 4U))
-                {
-                    *(((uint32_t *)&g_rtedbg) + g_rtecom.address) = g_rtecom.data;
-                    p_data++;   // ACK (pointer to checksum = 0x0F)
-                }
-            }
-            else if (command == RTECOM_READ_RTEDBG)
-            {
-                // Read data from g_rtedbg data structure
-                // Returns: NN bytes (NN = data parameter – number of bytes requested)
-                if ((data_size + g_rtecom.address) <= sizeof(g_rtedbg))
-                {
-                    p_data = ((const uint8_t *)&g_rtedbg) + g_rtecom.address;
-                    data_size = g_rtecom.data;
-                }
-            }
 
-            // Enable the following commands it if you also want to be able to read and write
-            // to the embedded system's memory and peripherals for testing purposes.
-            // Add check if address is aligned if the core does not support unaligned access.
-            // Ensure that all data from the specified address to the end address (address + data)
-            // is within the valid memory range (prevent exception in case of bad address).
-#if RTECOM_READ_ENABLED == 1
-            else if (command == RTECOM_READ)
-            {
-                // Read data from the specified address
-                // Returns: NN=size data bytes
-                uint32_t size = g_rtecom.data;
-                uint32_t address = g_rtecom.address;
-                data_size = size;
-                p_data = (const uint8_t *)address;
-#if RTECOM_READ_FROM_PERIPHERALS == 1
-                if ((size == 2U) && ((address & 1U) == 0U))
-                {
-                    g_rtecom.data = *(uint16_t *)address;
-                    p_data = (const uint8_t *)&g_rtecom.data;
-                }
-                else if ((size == 4U) && ((address & 3U) == 0U))
-                {
-                    g_rtecom.data = *(uint32_t *)address;
-                    p_data = (const uint8_t *)&g_rtecom.data;
+#if RTECOM_DMA_RECEIVE == 1
+/***
+ * @brief Processing of a block of data received through the serial channel.
+ *        This function is called by the serial driver, for example, after the
+ *        idle line, half transfer or transfer complete interrupt of a circular
+ *        DMA receive buffer. The processing is the same as if each byte were
+ *        processed by the rte_com_byte_received(), but a complete message is
+ *        copied at once and the checksum is calculated only once.
+ *
+ * @param p_data Pointer to the received data.
+ * @param size   Number of bytes received.
+ * @param errors Non-zero value indicates a hardware reception error (framing error, parity error, etc.).
+ *               The block and the partially received message are discarded in that case.
+ */
 
-                }
-#endif // RTECOM_READ_FROM_PERIPHERALS == 1
-            }
-#if RTECOM_WRITE_ENABLED == 1
-            else if (command == RTECOM_WRITE32)
-            {
-                // Write 32-bit data to the specified address
-                // Returns: ACK
-                *(uint32_t *)g_rtecom.address = g_rtecom.data;
-                p_data++;   // ACK (pointer to checksum = 0x0F)
-            }
-            else if (command == RTECOM_WRITE16)
-            {
-                // Write 16-bit data to the specified address
-                // Returns: ACK
-                *(uint16_t *)g_rtecom.address = (uint16_t)g_rtecom.data;
-                p_data++;   // ACK (pointer to checksum = 0x0F)
-            }
-            else if (command == RTECOM_WRITE8)
-            {
-                // Write 8-bit data to the specified address
-                // Returns: ACK
-                    *(uint8_t *)g_rtecom.address = (uint8_t)g_rtecom.data;
-                p_data++;   // ACK (pointer to checksum = 0x0F)
-            }
-#endif  // RTECOM_WRITE_ENABLED == 1
-#endif  // RTECOM_READ_ENABLED == 1
+void rte_com_data_received(const uint8_t *p_data, uint32_t size, uint32_t errors)
+{
+    uint32_t no_received = g_rtecom.no_received;
 
-            if (data_size > 0U)
+    if (errors != 0U)
+    {
+        g_rtecom.no_received = 0U;
+#if RTECOM_BATCH_ENABLED == 1
+        g_rtecom_batch.size = 0U;
+#endif
+        return;
+    }
+
+    while (size > 0U)
+    {
+#if RTECOM_SINGLE_WIRE == 1
+        if (no_received >= RTECOM_RECV_PACKET_LEN)
+        {
+            // Ignores the bytes it sends itself
+            uint32_t to_skip = 65536U - no_received;
+            if (to_skip > size)
             {
-                rte_com_send_data(p_data, data_size);   // Send the data to host
+                no_received += size;
+                break;
             }
+            p_data += to_skip;
+            size -= to_skip;
+            no_received = 0U;
+            continue;
+        }
+#endif
 
-#if RTECOM_SINGLE_WIRE == 1
-            // Set the number of bytes that have to be discarded before reception starts again.
-            g_rtecom.no_received = (uint32_t)(-(int32_t)data_size);
-            return;
+#if RTECOM_BATCH_ENABLED == 1
+        if (g_rtecom_batch.size != 0U)
+        {
+            uint32_t length = rte_com_batch_received(p_data, size);
+            p_data += length;
+            size -= length;
+            no_received = g_rtecom.no_received;
+            continue;
+        }
 #endif
+
+        if ((no_received == 0U) && (*p_data >= RTECOM_LAST_COMMAND))
+        {
+            p_data++;       // Not a command - discard the byte
+            size--;
+            continue;
+        }
+
+        uint32_t length = RTECOM_RECV_PACKET_LEN - no_received;
+        if (length > size)
+        {
+            length = size;
+        }
+
+        memcpy(RTECOM_FRAME_BYTES(&g_rtecom) + no_received, p_data, length); // Assemble message
+        p_data += length;
+        size -= length;
+        no_received += length;
+
+        if (no_received < RTECOM_RECV_PACKET_LEN)
+        {
+#if defined RTECOM_TIMEOUT
+            // If timeout is enabled, it stores the time of the data received.
+            RTECOM_LOG_TIME_LAST_DATA_RECEIVED();   // Set time of the last received data
+#endif
+            break;
+        }
+
+        // Checksum = XOR of the received checksum, address and data bytes
+        const uint8_t *p_msg = &g_rtecom.checksum;
+        uint32_t checksum = 0U;
+        for (uint32_t i = 0U; i < (RTECOM_RECV_PACKET_LEN - RTECOM_CRC_SIZE - 1U); i++)
+        {
+            checksum ^= p_msg[i];
+        }
+        g_rtecom.checksum = (uint8_t)checksum;  // ACK points to the checksum (0x0F)
+        no_received = 0U;
+
+        if ((checksum == RTECOM_CHECKSUM)
+#if RTECOM_CRC_ENABLED == 1
+            && (rte_com_crc_ok() != 0U)
+#endif
+           )
+        {
+            rte_com_execute_command();
+            no_received = g_rtecom.no_received;
         }
     }
 
-    g_rtecom.no_received = 0U;
+    g_rtecom.no_received = no_received;
 }
+#endif // RTECOM_DMA_RECEIVE == 1
 
 #endif // RTE_ENABLED != 0
 
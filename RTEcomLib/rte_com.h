@@ -14,6 +14,10 @@
 #ifndef RTE_COM_H
 #define RTE_COM_H
 
+#if !defined RTECOM_CRC_ENABLED
+#define RTECOM_CRC_ENABLED  0
+#endif
+
 typedef struct
 {
     volatile uint16_t no_received;
@@ -24,8 +28,17 @@ typedef struct
                             // the message (address and data word)
     uint32_t address;       // Address of data buffer to be transferred or variable to be set
     uint32_t data;          // Size of data (length) or data written to the address
+#if RTECOM_CRC_ENABLED == 1
+    uint32_t crc;           // CRC-32 of the command, address and data bytes (see RTECOM_CRC_INIT)
+                            // The CRC-32 of the response is stored here before it is sent.
+#endif
 } rtecom_recv_data_t;
 
+/* The message is assembled byte by byte starting with the 'command' field (see the
+ * no_received). The bytes are addressed through the complete structure - a pointer to
+ * the 'command' field would point to a single byte only. */
+#define RTECOM_FRAME_BYTES(p_recv)  ((uint8_t *)(p_recv) + offsetof(rtecom_recv_data_t, command))
+
 typedef enum
 {
     /* The first two commands are mandatory.
@@ -48,6 +61,38 @@ typedef enum
                             // Returns: ACK
     RTECOM_WRITE8,          // Write 8-bit data to the specified address
                             // Returns: ACK
+    RTECOM_READ_NEW,        // Read circular buffer words logged since the last read (streaming)
+                            // Address = index of the first word not yet received by the host
+                            // Data = maximum number of words to be transferred
+                            // Returns: 32-bit index for the next request + new buffer words
+                            //          or NACK if the index is not inside of the buffer
+    RTECOM_BATCH,           // Execute several RTECOM_WRITE_RTEDBG / RTECOM_READ_RTEDBG commands
+                            // (and RTECOM_SWAP_BANKS if the dual bank logging is enabled)
+                            // Address = number of sub-commands that follow this message
+                            //           (9 bytes each: command, address, data) and their
+                            //           CRC-32 if the RTECOM_CRC_ENABLED is 1
+                            // Data = XOR of all sub-command bytes
+                            // Returns: concatenated responses of all sub-commands
+                            //          or NACK if the number of sub-commands is not OK
+                            // A RTECOM_WRITE_RTEDBG after a long read (sent directly from
+                            // the g_rtedbg - see RTECOM_BATCH_COPY_SIZE) is executed after
+                            // the response has been sent (max. RTECOM_BATCH_DEFERRED_WRITES)
+    RTECOM_READ_COMPRESSED, // Read g_rtedbg words encoded with run-length compression
+                            // Address = offset from the start of g_rtedbg (multiple of 4)
+                            // Data = maximum number of words to be encoded
+                            // Returns: number of words encoded (16-bit), size of the encoded
+                            //          data (16-bit) + encoded data
+                            //          or NACK if the address is not inside of g_rtedbg or not aligned
+    RTECOM_READ_CHUNK,      // Read a block of g_rtedbg with offset, sequence number and checksum
+                            // Address = offset from the start of g_rtedbg (multiple of 4)
+                            // Data = size in bytes (lower 16 bits, multiple of 4)
+                            //        + sequence number (upper 16 bits)
+                            // Returns: chunk header (rtecom_chunk_t without the checksum),
+                            //          data and 32-bit checksum
+                            //          or NACK if the address or size is not OK
+    RTECOM_SWAP_BANKS,      // Swap the banks of the ping-pong buffer (RTE_DUAL_BANK_ENABLED)
+                            // Returns: index of the frozen bank (1 byte: 0 or 1)
+                            //          or NACK if the dual bank logging is not enabled
     RTECOM_LAST_COMMAND
 } rte_com_command_t;
 
@@ -57,15 +102,138 @@ typedef enum
 //         NACK - sends the command value
 // Note: NACK is returned if the command (e.g. RTECOM_READ) is not implemented or address not OK.
 
+// If several logging contexts are used (RTE_NO_OF_CONTEXTS > 1), the top byte of the address
+// parameter of the commands that access the g_rtedbg selects the context (0 = g_rtedbg).
+// With the dual bank logging (RTE_DUAL_BANK_ENABLED == 1), it selects the bank (1 = g_rtedbg_bank).
+#define RTECOM_CONTEXT_SHIFT    24U
+
+// Flag in the next index of the RTECOM_READ_NEW response - the logging has overwritten words
+// not yet transferred to the host. The response continues with the oldest data in the buffer.
+#define RTECOM_STREAM_OVERRUN   0x80000000U
+
+/* Optional CRC-32 protection of messages (RTECOM_CRC_ENABLED == 1)
+ * The host appends the CRC-32 of the command, address and data bytes to the message (the
+ * XOR checksum is also checked). Every response (including ACK and NACK) is followed by the
+ * CRC-32 of all response bytes. CRC-32/MPEG-2 is used because this is the default
+ * configuration of the STM32 CRC peripheral: polynomial 0x04C11DB7, initial value 0xFFFFFFFF,
+ * bits not reflected, no final XOR. Bytes are processed in the order they are transferred.
+ * The CRC is transferred as a 32-bit little endian value (as the address and data).
+ * The CRC is calculated in the receive interrupt before the DMA transfer of the response
+ * starts. Data read from the active circular buffer may change in the meantime - set the
+ * message filter to zero (or read a frozen bank) before reading it. The buffer words of the
+ * RTECOM_READ_NEW response are not covered by the CRC (only the next index is).
+ */
+#define RTECOM_CRC_INIT         0xFFFFFFFFU
+#define RTECOM_CRC_POLYNOMIAL   0x04C11DB7U
+#if RTECOM_CRC_ENABLED == 1
+#define RTECOM_CRC_SIZE         4U
+#else
+#define RTECOM_CRC_SIZE         0U
+#endif
+
 // Host always sends 10 bytes: command (8b), checksum (8b), address (32b), data (32b)
-#define RTECOM_RECV_PACKET_LEN  10U
+// + CRC-32 (32b) if the RTECOM_CRC_ENABLED is 1
+#define RTECOM_RECV_PACKET_LEN  (10U + RTECOM_CRC_SIZE)
 
 // Only if a timeout is implemented for receiving messages from the host, the following macro must be defined.
 #if !defined RTECOM_LOG_TIME_LAST_DATA_RECEIVED
 #define RTECOM_LOG_TIME_LAST_DATA_RECEIVED()
 #endif
 
+// Size of a sub-command in the RTECOM_BATCH message: command (8b), address (32b), data (32b)
+#define RTECOM_BATCH_CMD_LEN    9U
+
+#if !defined RTECOM_BATCH_ENABLED
+#define RTECOM_BATCH_ENABLED  0
+#endif
+#if !defined RTECOM_BATCH_MAX_COMMANDS
+#define RTECOM_BATCH_MAX_COMMANDS  8U   // Maximal number of sub-commands in a batch
+#endif
+#if !defined RTECOM_BATCH_DEFERRED_WRITES
+#define RTECOM_BATCH_DEFERRED_WRITES  2U    // Max. number of writes executed after the response
+#endif
+#if !defined RTECOM_BATCH_COPY_SIZE
+#define RTECOM_BATCH_COPY_SIZE    48U   // Size of buffer for copies of short responses (the filter,
+                                        // ACK and the g_rtedbg header without optional parts fit)
+#endif
+
+typedef struct
+{
+    uint16_t size;          // Number of sub-command (and CRC) bytes expected (0 = batch reception not active)
+    uint16_t no_received;   // Number of sub-command bytes received
+    uint8_t checksum;       // XOR of the sub-command bytes ('data' of the RTECOM_BATCH message)
+    uint8_t commands[(RTECOM_BATCH_MAX_COMMANDS * RTECOM_BATCH_CMD_LEN) + RTECOM_CRC_SIZE];
+        // Sub-commands followed by their CRC-32 (if the RTECOM_CRC_ENABLED is 1)
+    uint8_t copy[RTECOM_BATCH_COPY_SIZE];
+        // Short responses (ACK, NACK, g_rtedbg header fields) are copied here. Later sub-commands
+        // can thus not modify them before they are sent. They are sent as a single data block.
+    volatile uint8_t no_deferred;
+        // Number of deferred writes waiting for the end of the response transfer
+    struct
+    {
+        uint32_t *p_address;
+        uint32_t data;
+    } deferred[RTECOM_BATCH_DEFERRED_WRITES];
+        // RTECOM_WRITE_RTEDBG sub-commands after a block sent directly from the g_rtedbg. They are
+        // executed after the block has been sent - e.g. the message filter is restored then.
+} rtecom_batch_t;
+
+/* Run-length encoding for the RTECOM_READ_COMPRESSED command.
+ * Each token starts with a byte: token type (upper 2 bits) and number of words - 1 (lower 6 bits).
+ */
+#define RTECOM_RLE_LITERAL  0x00U   // Words not compressed - 4 bytes per word follow
+#define RTECOM_RLE_ERASED   0x40U   // Run of RTE_ERASED_STATE words - nothing follows
+#define RTECOM_RLE_ZERO     0x80U   // Run of zero words - nothing follows
+#define RTECOM_RLE_REPEAT   0xC0U   // Run of equal words - the 4-byte word value follows
+#define RTECOM_RLE_TYPE_MASK 0xC0U
+#define RTECOM_RLE_MAX_RUN  64U     // Maximal number of words in a token
+
+#if !defined RTECOM_COMPRESSION_ENABLED
+#define RTECOM_COMPRESSION_ENABLED  0
+#endif
+#if !defined RTECOM_COMPRESS_BUFFER_SIZE
+#define RTECOM_COMPRESS_BUFFER_SIZE  256U   // Size of buffer for the encoded data (max. 65534)
+#endif
+#if !defined RTECOM_COMPRESS_MAX_WORDS
+#define RTECOM_COMPRESS_MAX_WORDS    4096U  // Max. number of words read with one command (max. 16383)
+#endif
+#define RTECOM_COMPRESSED_RAW  0xFFFFU      // 'size' value of a response with uncompressed words
+
+typedef struct
+{
+    uint16_t no_words;      // Number of g_rtedbg words encoded
+    uint16_t size;          // Size of the encoded data (bytes) or RTECOM_COMPRESSED_RAW
+    uint8_t data[RTECOM_COMPRESS_BUFFER_SIZE];  // Encoded data
+} rtecom_compressed_t;
+
+/* Chunked read of large g_rtedbg structures (RTECOM_READ_CHUNK command).
+ * The response starts with the offset, sequence number and size of the chunk, so the host
+ * can identify each chunk and request only the chunks with a bad checksum again.
+ * The checksum is calculated over the header words and data words: for each word, the
+ * checksum is rotated left by one bit and the word is added (initial value 0).
+ */
+#if !defined RTECOM_CHUNKED_READ_ENABLED
+#define RTECOM_CHUNKED_READ_ENABLED  0
+#endif
+#if !defined RTECOM_CHUNK_MAX_SIZE
+#define RTECOM_CHUNK_MAX_SIZE  16384U   // Max. size of a chunk [bytes] (multiple of 4, max. 65500)
+#endif
+#define RTECOM_CHUNK_SIZE_MASK      0xFFFFU // Size of chunk in the 'data' parameter
+#define RTECOM_CHUNK_SEQUENCE_SHIFT 16U     // Sequence number in the 'data' parameter
+#define RTECOM_CHUNK_HEADER_SIZE    8U      // Size of the chunk header in the response
+
+typedef struct
+{
+    uint32_t offset;        // Address parameter of the request (offset and context index)
+    uint16_t sequence;      // Sequence number from the request
+    uint16_t size;          // Number of data bytes in the response (limited to the end of g_rtedbg)
+    uint32_t checksum;      // Checksum of the header and data - sent after the data
+} rtecom_chunk_t;
+
 extern rtecom_recv_data_t g_rtecom;  // Working variable for rte_com_byte_received()
+#if RTECOM_BATCH_ENABLED == 1
+extern rtecom_batch_t g_rtecom_batch;
+#endif
 
 
 /**************************
@@ -73,15 +241,40 @@ extern rtecom_recv_data_t g_rtecom;  // Working variable for rte_com_byte_receiv
  **************************/
 void rte_com_byte_received(uint8_t data, uint32_t errors);
     // Callback function for processing of received data
+void rte_com_data_received(const uint8_t *p_data, uint32_t size, uint32_t errors);
+    // Callback function for processing of a received data block (DMA reception)
+void rte_com_tx_complete(void);
+    // Callback function for the transmit complete (DMA) interrupt - see the serial driver
+void rte_com_tx_idle(void);
+    // Called by the serial driver after all queued data blocks have been sent
+void rte_com_rx_init(void);
+    // Start the DMA reception into the circular buffer - see the serial driver
+void rte_com_rx_process(void);
+    // Callback function for the receive DMA and USART idle line interrupts - see the serial driver
 
 
 #if (RTECOM_WRITE_ENABLED == 1) && (RTECOM_READ_ENABLED == 0)
 #error "The RTECOM_READ_ENABLED must also be enabled if the RTECOM_WRITE_ENABLED is enabled."
 #endif
+#if !defined RTECOM_STREAMING_ENABLED
+#define RTECOM_STREAMING_ENABLED  0
+#endif
+#if !defined RTECOM_DMA_RECEIVE
+#define RTECOM_DMA_RECEIVE  0
+#endif
 #if (RTECOM_READ_FROM_PERIPHERALS == 1) && (RTECOM_READ_ENABLED == 0)
 #error "The RTECOM_READ_FROM_PERIPHERALS can not be enabled without the RTECOM_READ_ENABLED."
 #endif
 
+#if (RTECOM_CHUNKED_READ_ENABLED == 1) && (((RTECOM_CHUNK_MAX_SIZE) > 65500U) || ((RTECOM_CHUNK_MAX_SIZE) & 3U))
+#error "RTECOM_CHUNK_MAX_SIZE must be a multiple of 4 and not larger than 65500."
+#endif
+#if (RTECOM_COMPRESSION_ENABLED == 1) \
+    && (((RTECOM_COMPRESS_BUFFER_SIZE) >= (RTECOM_COMPRESSED_RAW)) || ((RTECOM_COMPRESS_MAX_WORDS) > 16383U) \
+        || ((RTECOM_COMPRESS_MAX_WORDS) == 0U))
+#error "RTECOM_COMPRESS_BUFFER_SIZE must be smaller than 65535 and RTECOM_COMPRESS_MAX_WORDS in the range 1 to 16383."
+#endif
+
 #endif // RTE_COM_H
 
 /*==== End of file ====*/
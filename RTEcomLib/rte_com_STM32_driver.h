@@ -10,6 +10,53 @@
  * @brief   Send data over a serial channel using the DMA unit of the STM32 processor.
  * @note    The code has been tested on the STM32C0 only. Check if the DMA and
  *          USART of your STM32 device is compatible with this implementation.
+ *
+ * Data blocks are sent through a small transmit queue (ring of descriptors with
+ * pointer/length pairs). The DMA transfer complete interrupt starts the transfer
+ * of the next queued block, so several replies (or parts of a reply) are sent
+ * back to back at full line rate without copying the data.
+ *
+ * The following macros have to be defined in a header file - example for the STM32C0:
+ *    #define STM32_DMA_UNIT          DMA1
+ *    #define STM32_LL_DMA_CHANNEL    LL_DMA_CHANNEL_1
+ *    #define STM32_USART             USART2
+ *    #define STM32_DMA_IS_ACTIVE_FLAG_TC(dma)  LL_DMA_IsActiveFlag_TC1(dma)
+ *    #define STM32_DMA_CLEAR_FLAG_TC(dma)      LL_DMA_ClearFlag_TC1(dma)
+ * Optional:
+ *    #define RTECOM_TX_QUEUE_SIZE    4U    // Number of descriptors (power of 2, max. 128)
+ *
+ * The queue must hold all blocks of the longest response (RTECOM_TX_MAX_BLOCKS), since
+ * the host sends the next command only after it has received the complete response.
+ * The default queue size is set accordingly. A block is discarded if the queue is
+ * nevertheless full (the host did not wait for the response) - the host detects the
+ * incomplete response. The rte_com_send_data() thus never waits with the interrupts
+ * disabled.
+ *
+ * The rte_com_tx_complete() function must be called from the DMA channel interrupt
+ * handler (e.g. DMA1_Channel1_IRQHandler()). It calls the rte_com_tx_idle() after the
+ * last queued block has been sent.
+ *
+ * This file is included only by the rte_com.c (see RTECOM_SERIAL_DRIVER). It defines
+ * the rte_com_tx_complete(), rte_com_rx_init() and rte_com_rx_process() functions
+ * declared in the rte_com.h. The transmit queue and receive buffer are static.
+ *
+ * Optional DMA reception (RTECOM_DMA_RECEIVE == 1):
+ * The received data is written by a second DMA channel into a small circular buffer.
+ * The CPU is not interrupted for each byte, only at the idle line (end of the host
+ * message), half transfer and transfer complete events. The following macros have
+ * to be defined in addition - example for the STM32C0:
+ *    #define STM32_LL_DMA_RX_CHANNEL LL_DMA_CHANNEL_2
+ *    #define STM32_LL_DMAMUX_REQ_RX  LL_DMAMUX_REQ_USART2_RX
+ *    #define STM32_DMA_CLEAR_FLAG_RX(dma)      LL_DMA_ClearFlag_GI2(dma)
+ *    #define RTECOM_RX_BUFFER_SIZE   64U   // Size of the circular receive buffer
+ * Call rte_com_rx_init() after the USART initialization (instead of enabling the RXNE
+ * interrupt) and rte_com_rx_process() from the receive DMA channel and USART interrupt
+ * handlers (e.g. DMA1_Channel2_3_IRQHandler() and USART2_IRQHandler()).
+ *
+ * Optional CRC-32 protection of messages (RTECOM_CRC_ENABLED == 1):
+ * The CRC is calculated by the CRC peripheral. Enable its clock before the first
+ * message is received - e.g. with __HAL_RCC_CRC_CLK_ENABLE(). The peripheral must not
+ * be used by other parts of the firmware while the rte_com is processing a message.
  *******************************************************************************/
 
 #ifndef RTE_COM_STM32_DRIVER_H_
@@ -17,23 +64,63 @@
 
 #include "main.h"
 
+/* Max. number of data blocks of a response:
+ * RTECOM_READ_CHUNK - header, data, checksum and CRC-32,
+ * RTECOM_BATCH      - one block for each sub-command (copied short responses that precede a
+ *                     long one are sent as one block), the last copied responses and CRC-32.
+ */
+#if (RTECOM_BATCH_ENABLED == 1) && ((RTECOM_BATCH_MAX_COMMANDS) > 2U)
+#define RTECOM_TX_MAX_BLOCKS  ((RTECOM_BATCH_MAX_COMMANDS) + 2U)
+#else
+#define RTECOM_TX_MAX_BLOCKS  4U
+#endif
+
+#if !defined RTECOM_TX_QUEUE_SIZE
+#if RTECOM_TX_MAX_BLOCKS <= 4U
+#define RTECOM_TX_QUEUE_SIZE  4U
+#elif RTECOM_TX_MAX_BLOCKS <= 8U
+#define RTECOM_TX_QUEUE_SIZE  8U
+#elif RTECOM_TX_MAX_BLOCKS <= 16U
+#define RTECOM_TX_QUEUE_SIZE  16U
+#elif RTECOM_TX_MAX_BLOCKS <= 32U
+#define RTECOM_TX_QUEUE_SIZE  32U
+#elif RTECOM_TX_MAX_BLOCKS <= 64U
+#define RTECOM_TX_QUEUE_SIZE  64U
+#else
+#define RTECOM_TX_QUEUE_SIZE  128U
+#endif
+#endif
+
+#if ((RTECOM_TX_QUEUE_SIZE) & ((RTECOM_TX_QUEUE_SIZE) - 1U)) || ((RTECOM_TX_QUEUE_SIZE) > 128U)
+#error "RTECOM_TX_QUEUE_SIZE must be a power of 2 and not larger than 128."
+#endif
+
+#if (RTECOM_TX_QUEUE_SIZE) < (RTECOM_TX_MAX_BLOCKS)
+#error "RTECOM_TX_QUEUE_SIZE is too small for the longest response (RTECOM_TX_MAX_BLOCKS)."
+#endif
+
+typedef struct
+{
+    struct
+    {
+        const uint8_t *p_buffer;    // Start address of the data block
+        uint32_t size;              // Size of the data block
+    } desc[RTECOM_TX_QUEUE_SIZE];
+    volatile uint8_t head;  // Counter of queued blocks (index of the next free descriptor)
+    volatile uint8_t tail;  // Counter of sent blocks (index of the block being transferred)
+} rtecom_tx_queue_t;
+
+static rtecom_tx_queue_t rte_com_tx_queue;  // Transmit queue (head == tail => queue empty, DMA idle)
+
+
 /***
- * @brief Send data over USART using DMA.
+ * @brief Start the transfer of a data block with the DMA.
  *
  * @param  p_buffer  Pointer to data buffer
  * @param  size      Size of data in the buffer
- *
- * @note The 'size' parameter must not be greater than 0xFFFF, as this is the maximum number
- *       of bytes that can be sent with STM32 DMA in a packet.
- *
- * The following macros have to be defined in a header file - example for the STM32C0:
- *    #define STM32_DMA_UNIT          DMA1
- *    #define STM32_LL_DMA_CHANNEL    LL_DMA_CHANNEL_1
- *    #define STM32_USART             USART2
- *
  */
 
-__STATIC_FORCEINLINE void rte_com_send_data(const uint8_t *p_buffer, uint32_t size)
+__STATIC_FORCEINLINE void rte_com_start_dma(const uint8_t *p_buffer, uint32_t size)
 {
     // Disable DMA1 Channel to reconfigure it
     LL_DMA_DisableChannel(STM32_DMA_UNIT, STM32_LL_DMA_CHANNEL);
@@ -42,6 +129,7 @@ __STATIC_FORCEINLINE void rte_com_send_data(const uint8_t *p_buffer, uint32_t si
                            LL_USART_DMA_GetRegAddr(STM32_USART, LL_USART_DMA_REG_DATA_TRANSMIT),
                            LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
     LL_DMA_SetDataLength(STM32_DMA_UNIT, STM32_LL_DMA_CHANNEL, size);
+    LL_DMA_EnableIT_TC(STM32_DMA_UNIT, STM32_LL_DMA_CHANNEL);
 
     // Enable DMA Channel
     LL_DMA_EnableChannel(STM32_DMA_UNIT, STM32_LL_DMA_CHANNEL);
@@ -50,6 +138,242 @@ __STATIC_FORCEINLINE void rte_com_send_data(const uint8_t *p_buffer, uint32_t si
     LL_USART_EnableDMAReq_TX(STM32_USART);
 }
 
+
+/***
+ * @brief DMA transfer complete processing - start the transfer of the next queued block.
+ *        Call the function from the DMA channel interrupt handler.
+ */
+
+void rte_com_tx_complete(void)
+{
+    uint32_t irq_tmp = __get_PRIMASK();
+    __disable_irq();
+
+    if (STM32_DMA_IS_ACTIVE_FLAG_TC(STM32_DMA_UNIT))
+    {
+        STM32_DMA_CLEAR_FLAG_TC(STM32_DMA_UNIT);
+        uint32_t tail = rte_com_tx_queue.tail;
+
+        if (tail != rte_com_tx_queue.head)       // Was a transfer in progress?
+        {
+            tail = (uint8_t)(tail + 1U);
+            rte_com_tx_queue.tail = (uint8_t)tail;
+
+            if (tail != rte_com_tx_queue.head)   // Is another block waiting?
+            {
+                tail &= (RTECOM_TX_QUEUE_SIZE) - 1U;
+                rte_com_start_dma(rte_com_tx_queue.desc[tail].p_buffer, rte_com_tx_queue.desc[tail].size);
+            }
+            else
+            {
+                rte_com_tx_idle();              // All queued blocks have been sent
+            }
+        }
+    }
+
+    if (irq_tmp == 0U)
+    {
+        __enable_irq();
+    }
+}
+
+
+/***
+ * @brief Check if the transfer of the queued data blocks is still in progress.
+ *
+ * @return 1 - the DMA is sending data, 0 - idle
+ */
+
+__STATIC_FORCEINLINE uint32_t rte_com_tx_busy(void)
+{
+    return (rte_com_tx_queue.head != rte_com_tx_queue.tail) ? 1U : 0U;
+}
+
+
+/***
+ * @brief Send data over USART using DMA.
+ *        The block is sent immediately if the DMA is idle. Otherwise it is queued
+ *        and sent after the previously queued blocks.
+ *
+ * @param  p_buffer  Pointer to data buffer
+ * @param  size      Size of data in the buffer
+ *
+ * @note The 'size' parameter must not be greater than 0xFFFF, as this is the maximum number
+ *       of bytes that can be sent with STM32 DMA in a packet.
+ * @note The data must not change until it has been sent, because it is not copied.
+ * @note The block is discarded if the queue is full - see RTECOM_TX_MAX_BLOCKS.
+ */
+
+__STATIC_FORCEINLINE void rte_com_send_data(const uint8_t *p_buffer, uint32_t size)
+{
+    uint32_t irq_tmp = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t head = rte_com_tx_queue.head;
+
+    if ((uint8_t)(head - rte_com_tx_queue.tail) < (RTECOM_TX_QUEUE_SIZE))
+    {
+        rte_com_tx_queue.desc[head & ((RTECOM_TX_QUEUE_SIZE) - 1U)].p_buffer = p_buffer;
+        rte_com_tx_queue.desc[head & ((RTECOM_TX_QUEUE_SIZE) - 1U)].size = size;
+        rte_com_tx_queue.head = (uint8_t)(head + 1U);
+
+        if (head == rte_com_tx_queue.tail)  // Was the queue empty (DMA idle)?
+        {
+            rte_com_start_dma(p_buffer, size);
+        }
+    }
+
+    if (irq_tmp == 0U)
+    {
+        __enable_irq();
+    }
+}
+
+
+#if RTECOM_DMA_RECEIVE == 1
+
+#if !defined RTECOM_RX_BUFFER_SIZE
+#define RTECOM_RX_BUFFER_SIZE  64U
+#endif
+
+typedef struct
+{
+    uint8_t buffer[RTECOM_RX_BUFFER_SIZE];  // Circular buffer written by the DMA
+    uint32_t index;                         // Index of the first not yet processed byte
+} rtecom_rx_buffer_t;
+
+static rtecom_rx_buffer_t rte_com_rx_buffer;
+
+
+/***
+ * @brief Start the reception with DMA into the circular buffer.
+ *        The DMA channel runs continuously. The half transfer, transfer complete
+ *        and USART idle line interrupts trigger the processing of the received data.
+ */
+
+void rte_com_rx_init(void)
+{
+    LL_DMA_DisableChannel(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL);
+    LL_DMA_SetPeriphRequest(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL, STM32_LL_DMAMUX_REQ_RX);
+    LL_DMA_ConfigTransfer(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL,
+                          LL_DMA_DIRECTION_PERIPH_TO_MEMORY | LL_DMA_MODE_CIRCULAR |
+                          LL_DMA_PERIPH_NOINCREMENT | LL_DMA_MEMORY_INCREMENT |
+                          LL_DMA_PDATAALIGN_BYTE | LL_DMA_MDATAALIGN_BYTE | LL_DMA_PRIORITY_HIGH);
+    LL_DMA_ConfigAddresses(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL,
+                           LL_USART_DMA_GetRegAddr(STM32_USART, LL_USART_DMA_REG_DATA_RECEIVE),
+                           (uint32_t)rte_com_rx_buffer.buffer,
+                           LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL, RTECOM_RX_BUFFER_SIZE);
+    rte_com_rx_buffer.index = 0U;
+    STM32_DMA_CLEAR_FLAG_RX(STM32_DMA_UNIT);
+    LL_DMA_EnableIT_HT(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL);
+    LL_DMA_EnableIT_TC(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL);
+    LL_DMA_EnableChannel(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL);
+
+    LL_USART_ClearFlag_IDLE(STM32_USART);
+    LL_USART_EnableIT_IDLE(STM32_USART);
+    LL_USART_EnableIT_ERROR(STM32_USART);
+    LL_USART_EnableDMAReq_RX(STM32_USART);
+}
+
+
+/***
+ * @brief Pass the data received since the last call to the rte_com_data_received().
+ *        Call the function from the receive DMA channel and USART interrupt handlers.
+ *        The data is processed in one or two parts (if the DMA wrapped around).
+ */
+
+void rte_com_rx_process(void)
+{
+    uint32_t irq_tmp = __get_PRIMASK();
+    __disable_irq();
+
+    // Reception errors and the idle line flag are cleared by writing 1 to the respective bits
+    uint32_t errors =
+        STM32_USART->ISR & (USART_ISR_ORE | USART_ISR_NE | USART_ISR_FE | USART_ISR_PE);
+    STM32_USART->ICR = errors | USART_ICR_IDLECF;
+    STM32_DMA_CLEAR_FLAG_RX(STM32_DMA_UNIT);
+
+    uint32_t write_index = (RTECOM_RX_BUFFER_SIZE)
+        - LL_DMA_GetDataLength(STM32_DMA_UNIT, STM32_LL_DMA_RX_CHANNEL);
+    if (write_index >= (RTECOM_RX_BUFFER_SIZE))
+    {
+        write_index = 0U;
+    }
+
+    uint32_t index = rte_com_rx_buffer.index;
+    rte_com_rx_buffer.index = write_index;
+
+    if (write_index < index)
+    {
+        // The DMA wrapped around - process the data up to the end of buffer first
+        rte_com_data_received(&rte_com_rx_buffer.buffer[index], (RTECOM_RX_BUFFER_SIZE) - index, errors);
+        index = 0U;
+        errors = 0U;
+    }
+
+    if ((write_index > index) || (errors != 0U))
+    {
+        rte_com_data_received(&rte_com_rx_buffer.buffer[index], write_index - index, errors);
+    }
+
+    if (irq_tmp == 0U)
+    {
+        __enable_irq();
+    }
+}
+
+#endif // RTECOM_DMA_RECEIVE == 1
+
+
+#if RTECOM_CRC_ENABLED == 1
+/* CRC-32 calculation with the CRC peripheral. The default configuration after reset is
+ * used: polynomial 0x04C11DB7, initial value 0xFFFFFFFF, no bit reversal.
+ */
+#define RTECOM_CRC_HW  1
+
+__STATIC_FORCEINLINE void rte_com_crc_reset(void)
+{
+    CRC->CR |= CRC_CR_RESET;    // Load the initial value
+}
+
+
+/***
+ * @brief Add data to the CRC calculation. The bytes of the aligned words are reversed so
+ *        that the bytes are processed in the same order as they are transferred.
+ *
+ * @param p_data Pointer to the data
+ * @param size   Number of bytes
+ */
+
+__STATIC_FORCEINLINE void rte_com_crc_update(const uint8_t *p_data, uint32_t size)
+{
+    while ((size > 0U) && (((uint32_t)p_data & 3U) != 0U))
+    {
+        *(__IO uint8_t *)&CRC->DR = *p_data++;
+        size--;
+    }
+
+    while (size >= 4U)
+    {
+        CRC->DR = __REV(*(const uint32_t *)p_data);
+        p_data += 4U;
+        size -= 4U;
+    }
+
+    while (size > 0U)
+    {
+        *(__IO uint8_t *)&CRC->DR = *p_data++;
+        size--;
+    }
+}
+
+__STATIC_FORCEINLINE uint32_t rte_com_crc_result(void)
+{
+    return CRC->DR;
+}
+#endif // RTECOM_CRC_ENABLED == 1
+
 #endif /* RTE_COM_STM32_DRIVER_H_ */
 
 /*==== End of file ====*/
@@ -27,6 +27,7 @@
 #define RTEDBG_H
 
 #include <stdint.h>
+#include <stddef.h>
 #if defined RTE_USE_MEMSET
 #include <string.h>
 #endif
@@ -313,11 +314,58 @@ __STATIC_FORCEINLINE uint32_t double_par(const double number)
                (rte_any32_t)(data3), (rte_any32_t)(data4));                         \
 }
 
+#if (RTE_MINIMIZED_CODE_SIZE == 0) && (RTE_HANDLE_UNALIGNED_MEMORY_ACCESS == 0)        \
+    && (RTE_DISCARD_MSGS_WITH_UNALIGNED_ADDRESS == 0) && defined __GNUC__
+/* Messages with a size known at compile time and not larger than 16 bytes are logged
+ * with the __rte_msg0() ... __rte_msg4() functions. The data is stored to the circular
+ * buffer in the same format as with the __rte_msgn() (one subpacket), but without the
+ * length calculation and the copy loop. The address must be word aligned - as for the
+ * __rte_msgn() if the RTE_HANDLE_UNALIGNED_MEMORY_ACCESS is 0.
+ * The __rte_msgn() is used if the size is not a compile-time constant.
+ */
+#define RTE_MSGN(fmt, filter_no, address, size)                                     \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 15U);                                      \
+    if (__builtin_constant_p(size) && ((size) <= 16U))                              \
+    {                                                                               \
+        volatile const uint32_t *rte_addr = (volatile const uint32_t *)(address);   \
+        if ((size) == 0U)                                                           \
+        {                                                                           \
+            __rte_msg0(RTE_PACK(filter_no, fmt, 0U));                               \
+        }                                                                           \
+        else if ((size) <= 4U)                                                      \
+        {                                                                           \
+            __rte_msg1(RTE_PACK(filter_no, fmt, 1U), (rte_any32_t)rte_addr[0]);     \
+        }                                                                           \
+        else if ((size) <= 8U)                                                      \
+        {                                                                           \
+            __rte_msg2(RTE_PACK(filter_no, fmt, 2U), (rte_any32_t)rte_addr[0],      \
+                       (rte_any32_t)rte_addr[1]);                                   \
+        }                                                                           \
+        else if ((size) <= 12U)                                                     \
+        {                                                                           \
+            __rte_msg3(RTE_PACK(filter_no, fmt, 3U), (rte_any32_t)rte_addr[0],      \
+                       (rte_any32_t)rte_addr[1], (rte_any32_t)rte_addr[2]);         \
+        }                                                                           \
+        else                                                                        \
+        {                                                                           \
+            __rte_msg4(RTE_PACK(filter_no, fmt, 4U), (rte_any32_t)rte_addr[0],      \
+                       (rte_any32_t)rte_addr[1], (rte_any32_t)rte_addr[2],          \
+                       (rte_any32_t)rte_addr[3]);                                   \
+        }                                                                           \
+    }                                                                               \
+    else                                                                            \
+    {                                                                               \
+        __rte_msgn(RTE_PACK(filter_no, fmt, 4U), address, size);                    \
+    }                                                                               \
+}
+#else
 #define RTE_MSGN(fmt, filter_no, address, size)                                     \
 {                                                                                   \
     RTE_CHECK_PARAMETERS(filter_no, fmt, 15U);                                      \
     __rte_msgn(RTE_PACK(filter_no, fmt, 4U), address, size);                        \
 }
+#endif
 
 #define RTE_MSGX(fmt, filter_no, address, size)                                     \
 {                                                                                   \
@@ -417,6 +465,10 @@ void rte_long_timestamp(void);
 
 void rte_timestamp_frequency(const uint32_t new_frequency);
 
+#if RTE_DUAL_BANK_ENABLED == 1
+uint32_t rte_swap_banks(void);
+#endif
+
 #if RTE_FIRMWARE_MAY_SET_FILTER != 0
 void rte_set_filter(uint32_t filter);
 void rte_restore_filter(void);
@@ -425,6 +477,240 @@ void rte_restore_filter(void);
 #define rte_restore_filter()
 #endif
 
+
+/************************************************************************************
+ * Zero-copy logging - the DATA words are written directly to the circular buffer.
+ * RTE_MSG_RESERVE() reserves space for a message with 'no_words' 32-bit DATA words and
+ * prepares the writer. The words are then written one by one with rte_writer_put()
+ * and the message is completed with rte_msg_commit(). The message is stored in the same
+ * format as with the RTE_MSGN() with a size of no_words * 4 bytes - use a MSGN format
+ * definition. Words not written before the commit are logged as zero. Words written
+ * after the reserved ones have been written are ignored.
+ * The writer is not active (rte_writer_active() returns 0) if the message is disabled
+ * by the filter or discarded. The rte_writer_put() and rte_msg_commit() do nothing
+ * in this case - the calculation of the data can be skipped.
+ * The timestamp is read at the reservation. Other messages may be logged between the
+ * reservation and commit (e.g. by interrupts), but the host sees the message as
+ * incomplete until it is committed - keep the time between them short.
+ *
+ * Example:
+ *     rte_writer_t writer;
+ *     RTE_MSG_RESERVE(&writer, MSGN_SENSOR_FRAME, F_SENSORS, 12U);
+ *     if (rte_writer_active(&writer))
+ *     {
+ *         for (uint32_t i = 0U; i < 12U; i++)
+ *         {
+ *             rte_writer_put(&writer, sensor_value(i));
+ *         }
+ *         rte_msg_commit(&writer);
+ *     }
+ ***********************************************************************************/
+
+typedef struct
+{
+    uint32_t *p_word;       // Address of the next DATA word in the circular buffer
+    uint32_t *p_end;        // End of the DATA words of the current subpacket (the FMT word)
+    uint32_t bits31;        // Bits 31 of the DATA words in the current subpacket
+                            // (same bit order as with the rte_pack_data_t)
+    uint32_t next_words;    // Number of DATA words in the following subpackets
+    uint32_t buf_index;     // Circular buffer index of the current subpacket
+    uint32_t fmt_word;      // FMT word without the bits 31 (format ID and timestamp)
+    uint32_t fmt_id;        // Format ID parameter of the RTE_MSG_RESERVE()
+    uint32_t msg_index;     // Circular buffer index of the message
+    uint32_t msg_words;     // Number of words reserved for the message (DATA and FMT)
+    void *p_rtedbg;         // Logging data structure (NULL - writer not active)
+} rte_writer_t;
+
+void __rte_msg_reserve(rte_writer_t * const p_writer, const uint32_t fmt_id, const uint32_t no_words);
+void __rte_writer_next(rte_writer_t * const p_writer);
+void rte_msg_commit(rte_writer_t * const p_writer);
+
+#define RTE_MSG_RESERVE(p_writer, fmt, filter_no, no_words)                         \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 15U);                                      \
+    __rte_msg_reserve(p_writer, RTE_PACK(filter_no, fmt, 4U), no_words);            \
+}
+
+/***
+ * @brief Check if the message is logged - the space has been reserved.
+ *
+ * @param p_writer  Writer prepared by the RTE_MSG_RESERVE()
+ *
+ * @return 1 - message is logged, 0 - message disabled or discarded
+ */
+
+__STATIC_FORCEINLINE uint32_t rte_writer_active(const rte_writer_t * const p_writer)
+{
+    return (p_writer->p_rtedbg != NULL) ? 1U : 0U;
+}
+
+/***
+ * @brief Write the next DATA word of the message to the circular buffer.
+ *        The FMT word is written when the subpacket is complete.
+ *
+ * @param p_writer  Writer prepared by the RTE_MSG_RESERVE()
+ * @param data      Data word
+ */
+
+__STATIC_FORCEINLINE void rte_writer_put(rte_writer_t * const p_writer, const uint32_t data)
+{
+    // The writer is read before and updated after the word has been written to the buffer.
+    // The compiler does not have to read it again in a sequence of rte_writer_put() calls.
+    uint32_t *p_word = p_writer->p_word;
+    uint32_t * const p_end = p_writer->p_end;
+
+    if (p_word != p_end)
+    {
+        const uint32_t bits31 = (p_writer->bits31 << 1U) | (data >> 31U);
+        *p_word = data << 1U;
+        p_word++;
+        p_writer->p_word = p_word;
+        p_writer->bits31 = bits31;
+        if (p_word == p_end)
+        {
+            __rte_writer_next(p_writer);    // Write the FMT word of the complete subpacket
+        }
+    }
+}
+
+
+/************************************************************************************
+ * Batch logging - a group of short messages is logged with a single reservation.
+ * The messages are collected in the rte_batch_t structure with the RTE_BATCH_MSG0() ...
+ * RTE_BATCH_MSG4() macros (same parameters and message format as RTE_MSG0() ... RTE_MSG4())
+ * and logged with rte_batch_commit(). The filters of all messages are checked first and
+ * the space for the enabled ones is then reserved at once - the critical section (or the
+ * lock-free reservation) and the timestamp read are executed once per batch instead of
+ * once per message. The messages are stored in the order in which they were added. The
+ * first one gets the timestamp of the commit and every next one a timestamp one unit
+ * (2^RTE_TIMESTAMP_SHIFT timer counts) later - the decoder would otherwise join two
+ * messages with the same format ID and timestamp (e.g. two RTE_BATCH_MSG4() in a row)
+ * into one long message. In the single shot mode, the batch is discarded if it does not
+ * fit in the rest of the buffer.
+ * The collected messages are committed automatically if a message is added to a full
+ * batch (RTE_BATCH_MAX_MSGS messages).
+ *
+ * Example:
+ *     rte_batch_t batch;
+ *     rte_batch_init(&batch);
+ *     RTE_BATCH_MSG1(&batch, MSG1_SPEED, F_CONTROL, speed);
+ *     RTE_BATCH_MSG2(&batch, MSG2_CURRENTS, F_CONTROL, i_a, i_b);
+ *     RTE_BATCH_MSG0(&batch, MSG0_LOOP_END, F_CONTROL);
+ *     rte_batch_commit(&batch);
+ ***********************************************************************************/
+
+#if !defined RTE_BATCH_MAX_MSGS
+#define RTE_BATCH_MAX_MSGS  8
+#endif
+
+#if ((RTE_BATCH_MAX_MSGS) < 1) || ((RTE_BATCH_MAX_MSGS) > 32)
+#error "The RTE_BATCH_MAX_MSGS must have a value between 1 and 32."
+#endif
+
+typedef struct
+{
+    uint32_t no_msgs;       // Number of messages in the batch
+    uint32_t no_words;      // Number of DATA words in the data[]
+    uint32_t fmt_id[RTE_BATCH_MAX_MSGS];     // Format IDs with the filter numbers (not shifted)
+    uint8_t  msg_words[RTE_BATCH_MAX_MSGS];  // Number of DATA words of the messages (0 ... 4)
+    rte_any32_t data[4U * (uint32_t)(RTE_BATCH_MAX_MSGS)];  // DATA words of all messages
+} rte_batch_t;
+
+void rte_batch_commit(rte_batch_t * const p_batch);
+
+/***
+ * @brief Prepare an empty batch.
+ *
+ * @param p_batch  Batch data structure
+ */
+
+__STATIC_FORCEINLINE void rte_batch_init(rte_batch_t * const p_batch)
+{
+    p_batch->no_msgs = 0U;
+    p_batch->no_words = 0U;
+}
+
+/***
+ * @brief Add a message to the batch - called by the RTE_BATCH_MSG0() ... RTE_BATCH_MSG4().
+ *
+ * @param p_batch   Batch prepared by the rte_batch_init()
+ * @param fmt_id    Format ID with the filter number - RTE_PACK() with shift 0
+ * @param no_words  Number of DATA words (0 ... 4)
+ * @param data1 ... data4  DATA words (the ones above no_words are not used)
+ */
+
+__STATIC_FORCEINLINE void rte_batch_add(rte_batch_t * const p_batch, const uint32_t fmt_id,
+                                        const uint32_t no_words,
+                                        const rte_any32_t data1, const rte_any32_t data2,
+                                        const rte_any32_t data3, const rte_any32_t data4)
+{
+    if (p_batch->no_msgs >= (uint32_t)(RTE_BATCH_MAX_MSGS))
+    {
+        rte_batch_commit(p_batch);  // Log the collected messages
+    }
+
+    const uint32_t msg_no = p_batch->no_msgs;
+    rte_any32_t *p_data = &p_batch->data[p_batch->no_words];
+
+    // The no_words is a constant - the unused assignments are removed by the compiler
+    if (no_words > 0U)
+    {
+        p_data[0] = data1;
+    }
+    if (no_words > 1U)
+    {
+        p_data[1] = data2;
+    }
+    if (no_words > 2U)
+    {
+        p_data[2] = data3;
+    }
+    if (no_words > 3U)
+    {
+        p_data[3] = data4;
+    }
+
+    p_batch->fmt_id[msg_no] = fmt_id;
+    p_batch->msg_words[msg_no] = (uint8_t)no_words;
+    p_batch->no_words += no_words;
+    p_batch->no_msgs = msg_no + 1U;
+}
+
+#define RTE_BATCH_MSG0(p_batch, fmt, filter_no)                                     \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 0U);                                       \
+    rte_batch_add(p_batch, RTE_PACK(filter_no, fmt, 0U), 0U, (rte_any32_t)0U,       \
+                  (rte_any32_t)0U, (rte_any32_t)0U, (rte_any32_t)0U);               \
+}
+
+#define RTE_BATCH_MSG1(p_batch, fmt, filter_no, data1)                              \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 1U);                                       \
+    rte_batch_add(p_batch, RTE_PACK(filter_no, fmt, 0U), 1U, (rte_any32_t)(data1),  \
+                  (rte_any32_t)0U, (rte_any32_t)0U, (rte_any32_t)0U);               \
+}
+
+#define RTE_BATCH_MSG2(p_batch, fmt, filter_no, data1, data2)                       \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 3U);                                       \
+    rte_batch_add(p_batch, RTE_PACK(filter_no, fmt, 0U), 2U, (rte_any32_t)(data1),  \
+                  (rte_any32_t)(data2), (rte_any32_t)0U, (rte_any32_t)0U);          \
+}
+
+#define RTE_BATCH_MSG3(p_batch, fmt, filter_no, data1, data2, data3)                \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 7U);                                       \
+    rte_batch_add(p_batch, RTE_PACK(filter_no, fmt, 0U), 3U, (rte_any32_t)(data1),  \
+                  (rte_any32_t)(data2), (rte_any32_t)(data3), (rte_any32_t)0U);     \
+}
+
+#define RTE_BATCH_MSG4(p_batch, fmt, filter_no, data1, data2, data3, data4)         \
+{                                                                                   \
+    RTE_CHECK_PARAMETERS(filter_no, fmt, 15U);                                      \
+    rte_batch_add(p_batch, RTE_PACK(filter_no, fmt, 0U), 4U, (rte_any32_t)(data1),  \
+                  (rte_any32_t)(data2), (rte_any32_t)(data3), (rte_any32_t)(data4)); \
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -450,7 +736,27 @@ void rte_restore_filter(void);
 #define rte_get_filter() 0
 #define rte_restore_filter()
 #define rte_set_filter(filter)
+#define rte_swap_banks() 0U
 #define RTE_RESTART_TIMING()
+typedef struct
+{
+    uint32_t unused;
+} rte_writer_t;
+#define RTE_MSG_RESERVE(p_writer, fmt_id, filter, no_words)
+#define rte_writer_active(p_writer) 0U
+#define rte_writer_put(p_writer, data)
+#define rte_msg_commit(p_writer)
+typedef struct
+{
+    uint32_t unused;
+} rte_batch_t;
+#define rte_batch_init(p_batch)
+#define rte_batch_commit(p_batch)
+#define RTE_BATCH_MSG0(p_batch, fmt_id, filter)
+#define RTE_BATCH_MSG1(p_batch, fmt_id, filter, data1)
+#define RTE_BATCH_MSG2(p_batch, fmt_id, filter, data1, data2)
+#define RTE_BATCH_MSG3(p_batch, fmt_id, filter, data1, data2, data3)
+#define RTE_BATCH_MSG4(p_batch, fmt_id, filter, data1, data2, data3, data4)
 #endif // RTE_ENABLED != 0
 
 #endif /* RTEDBG_H */
@@ -43,11 +43,42 @@ extern "C" {
  *       timestamp drivers that are appropriate for the particular demo (exist in the folder).
  */
 
+#if defined RTE_HOST_BUILD
+/* Host (e.g. Linux) build of the RTEdbg and RTEcomLib libraries for execution time
+ * measurements and testing without the target hardware. The macro RTE_HOST_BUILD must
+ * be defined on the compiler command line. The 'main.h' included above must then be
+ * a host version with the RTEcom definitions (RTECOM_SERIAL_DRIVER, etc.).
+ */
+#if defined RTE_SIMULATED_SYSTICK
+/* Simulated SYSTICK (see the Host/Emulator/main.h) for the host test of the extended
+ * SYSTICK driver - Host/Emulator/rte_tstamp_sim.c. The same settings as for the target. */
+#define RTE_TIMER_DRIVER  "rtedbg_timer_systick_ext.h"
+#define RTE_TIMESTAMP_SHIFT   3U    // Divide the timestamp by 2^3 = 8
+#define RTE_GET_TSTAMP_FREQUENCY() 48000000U        // Simulated core frequency [Hz]
+#else
+#define RTE_TIMER_DRIVER  "rtedbg_timer_host.h"
+#define RTE_TIMESTAMP_SHIFT   1U    // Timestamp resolution = 2 ns
+#define RTE_GET_TSTAMP_FREQUENCY() 1000000000U      // Monotonic clock frequency [Hz]
+#endif
+
+#if defined RTE_HOST_LOCK_FREE
+#define RTE_CPU_DRIVER  "rtedbg_generic_lock_free.h" // Lock-free reservation (atomic compare-and-swap)
+#else
+#define RTE_CPU_DRIVER  "rtedbg_host_irq_disable.h" // Spin lock instead of the interrupt disable
+#endif
+
+#else
 // Example: Timer SYSTICK used as the timestamp counter
 #define RTE_TIMER_DRIVER  "rtedbg_timer_systick.h"
 #define RTE_TIMESTAMP_SHIFT   3U    // Divide the timestamp by 2^3 = 8
 #define RTE_GET_TSTAMP_FREQUENCY() SystemCoreClock  // Current core frequency [Hz]
 
+/* Alternative: SYSTICK extended to 32 bits by its interrupt. The rte_long_timestamp() does not
+ * have to be called periodically - the long timestamp is logged by the SysTick_Handler() defined
+ * in the driver when it is needed (see the rtedbg_timer_systick_ext.h). Remove the SysTick_Handler()
+ * from the application or define the RTE_TSTAMP_OVERFLOW_HANDLER. */
+//#define RTE_TIMER_DRIVER  "rtedbg_timer_systick_ext.h"
+
 
 /* CPU core-specific functions for buffer space reservation. */
 #define RTE_CPU_DRIVER  "rtedbg_generic_irq_disable.h" // Reserving buffer space by temporarily disabling interrupts
@@ -61,10 +92,19 @@ extern "C" {
         __enable_irq();                 \
     }
 
+/* Alternative for CPU cores with exclusive access instructions (e.g. Cortex-M3/M4/M7/M33).
+ * Logging never disables interrupts. Not available for the Cortex-M0/M0+ used in this demo. */
+//#define RTE_CPU_DRIVER  "rtedbg_generic_lock_free.h"
+#endif // defined RTE_HOST_BUILD
+
 
 /*****************************************
  *   SETUP THE RTEdbg FUNCTIONALITY
  ****************************************/
+/* Note: Parameters enclosed in '#if !defined' can also be set from the compiler command
+ *       line - e.g. to compare the logging function execution times for all settings
+ *       in a host build (see RTE_HOST_BUILD).
+ */
 
 #define RTE_ENABLED                       1
   /* 1 - data logging functionality enabled
@@ -78,7 +118,9 @@ extern "C" {
     * Number of bits available for the timestamp = 32 - RTE_FMT_ID_BITS - 1
     */
 
+#if !defined RTE_BUFFER_SIZE
 #define RTE_BUFFER_SIZE                2048
+#endif
   /* Number of 32-bit words in the circular data buffer.
    * If the value of RTE_BUFFER_SIZE is a power of two, the data logging of messages is
    * a bit faster and the logging functions are also smaller.
@@ -114,7 +156,9 @@ extern "C" {
    *     by calling the rte_init() function.
    */
 
+#if !defined RTE_MINIMIZED_CODE_SIZE
 #define RTE_MINIMIZED_CODE_SIZE           2
+#endif
   /* 0 - Fastest code execution, reduced stack requirement and larger code size if most
    *     of the data logging functions are used.
    * 1 - Reduced code size but slower execution and higher stack usage for the
@@ -123,7 +167,9 @@ extern "C" {
    *     the cost of slower execution.
    */
 
+#if !defined RTE_DELAYED_TSTAMP_READ
 #define RTE_DELAYED_TSTAMP_READ           1
+#endif
   /* 1 - The timestamp counter is read just before its value is needed for data logging.
    *     The code size is typically slightly smaller and the stack usage also.
    *     This setting is generally recommended for simpler microcontrollers (like the
@@ -158,6 +204,37 @@ extern "C" {
    * 0 - Shorten messages that are too long to the maximum size.
    */
 
+#if !defined RTE_SINGLE_PASS_STRINGS
+#define RTE_SINGLE_PASS_STRINGS           0
+#endif
+  /* 1 - The __rte_stringn() (RTE_STRING() and RTE_STRINGN() macros) searches for the end of
+   *     the string in the first 16 bytes and reserves only the space required for a short
+   *     string. For a longer string it reserves space for the longest possible string
+   *     (max. RTE_SINGLE_PASS_MAX_LENGTH bytes) and copies the string while searching for
+   *     its end - a single pass over the string. The unused words are returned if no other
+   *     message has been logged in the meantime. Otherwise, they are set to RTE_ERASED_STATE
+   *     (skipped by the decoder as reserved but not written) and take up buffer space.
+   *     Strings with a larger max. length and all strings in the single shot mode are logged
+   *     as with the value 0.
+   * 0 - The string length is determined first and the string is then logged with the
+   *     __rte_msgn() - two passes over the string, but smaller code size.
+   */
+
+#if !defined RTE_SINGLE_PASS_MAX_LENGTH
+#define RTE_SINGLE_PASS_MAX_LENGTH        64
+#endif
+  /* Maximum string length [bytes] (max_length parameter limited to RTE_MAX_MSG_SIZE) for
+   * which the worst case space is reserved with RTE_SINGLE_PASS_STRINGS = 1 (up to 20 words).
+   */
+
+#if !defined RTE_BATCH_MAX_MSGS
+#define RTE_BATCH_MAX_MSGS                8
+#endif
+  /* Maximum number of messages in a batch (rte_batch_t) - see the RTE_BATCH_MSG0() ...
+   * RTE_BATCH_MSG4() in the rtedbg.h. The batch is logged automatically when it is full.
+   * Every message takes up to 21 bytes in the rte_batch_t structure (max. value 32).
+   */
+
 /**
  * Some CPU cores do not support unaligned memory access, or it may be possible to disable
  * unaligned memory access via firmware. For such cases, the function __rte_msgn()/RTE_MSGN()
@@ -170,8 +247,123 @@ extern "C" {
  * is enabled, logging will be slower compared to cases where the memory address is aligned.
  */
 
+#if !defined RTE_NO_OF_CONTEXTS
+#define RTE_NO_OF_CONTEXTS                1
+#endif
+  /* Number of independent data logging structures (logging contexts).
+   * 1 - All messages are logged to the g_rtedbg circular buffer.
+   * 2 .. 8 - Messages are logged to the g_rtedbg (context 0) or g_rtedbg_ctx[] data
+   *     structure selected by the RTE_CONTEXT_INDEX() macro - e.g. one for the thread mode
+   *     and one for the interrupts. Each context has its own buffer index, so the writers
+   *     in different contexts do not share the circular buffer space reservation. All
+   *     contexts have the same buffer size. The message filter in the g_rtedbg applies to
+   *     all contexts. Each structure is a complete data snapshot for the host (context
+   *     index in the rte_cfg word). The host merges the decoded messages by timestamp
+   *     (see the rte_dec_contexts_merged() in the Host/rte_decoder.c). The long timestamp
+   *     message (rte_long_timestamp()) is logged to all contexts, so that the timestamps
+   *     of each context can be extended to absolute values. The copies are written from
+   *     the context which calls the rte_long_timestamp() - a CPU driver that is not
+   *     reentrant (RTE_USE_LOCAL_CPU_DRIVER) must not be used with several contexts.
+   */
+#if (RTE_NO_OF_CONTEXTS > 1) && !defined RTE_HOST_BUILD
+#define RTE_CONTEXT_INDEX()  ((__get_IPSR() != 0U) ? 1U : 0U)
+  /* Example: context 0 - thread mode, context 1 - interrupts and exceptions.
+   * This definition separates only the thread mode from the interrupts. All interrupts
+   * share context 1 regardless of their priority - a nested interrupt still reserves space
+   * in the same buffer as the interrupt it has preempted. To give groups of interrupt
+   * priorities their own contexts, derive the index from the priority of the active
+   * exception, e.g. for RTE_NO_OF_CONTEXTS = 3 (priority values 0 .. 7 = context 2):
+   * #define RTE_CONTEXT_INDEX()  ((__get_IPSR() == 0U) ? 0U :                            \
+   *     ((NVIC_GetPriority((IRQn_Type)((int32_t)__get_IPSR() - 16)) < 8U) ? 2U : 1U))
+   * The execution time of the macro is added to every logging function.
+   */
+#elif (RTE_NO_OF_CONTEXTS > 1) && !defined RTE_CONTEXT_INDEX
+extern uint32_t rte_host_context;
+#define RTE_CONTEXT_INDEX()  (rte_host_context)
+  /* Host build - the context is selected by the test program */
+#endif
+
+#if !defined RTE_TRIGGER_ENABLED
+#define RTE_TRIGGER_ENABLED               0
+#endif
+  /* 1 - Trigger-based capture (oscilloscope-style pre-trigger and post-trigger windows).
+   *     The g_rtedbg header is extended with the trigger words (see rtedbg_t). The host
+   *     writes the format ID, optional first DATA word value and mask, and the number of
+   *     words to be logged after the trigger message (e.g. with the RTECOM_WRITE_RTEDBG
+   *     command) and then arms the trigger. After the trigger message has been logged and
+   *     the post-trigger window has been filled, the logging is stopped (filter = 0).
+   *     The cost for the logging functions is one comparison if the trigger is not active.
+   * 0 - Trigger disabled (header without the trigger words).
+   */
+
+#if !defined RTE_STATISTICS_ENABLED
+#define RTE_STATISTICS_ENABLED            0
+#endif
+  /* 1 - Logging statistics in the g_rtedbg header - number of messages and circular buffer
+   *     words logged for each of the 32 filter numbers, number of discarded messages (single
+   *     shot buffer full or too long messages) and number of truncated messages. The host
+   *     reads them with the header (e.g. RTECOM_READ_RTEDBG) to find out which message
+   *     groups fill the buffer. The header is extended by 66 words. Each logged message
+   *     costs two additional RAM increments.
+   * 0 - Statistics disabled.
+   */
+
+#if !defined RTE_RATE_LIMIT_ENABLED
+#define RTE_RATE_LIMIT_ENABLED            0
+#endif
+  /* 1 - Token bucket rate limiter for each filter number. The host (e.g. with the
+   *     RTECOM_WRITE_RTEDBG command) or the firmware sets the interval and burst size in
+   *     g_rtedbg.rate_limit[filter_no] and enables the limiter with the rate_limit_mask.
+   *     Excess messages are discarded before the buffer space is reserved and counted in
+   *     rate_shed[filter_no] (16-bit counters that stop at 0xFFFF). This prevents a single message group from overwriting the
+   *     whole circular buffer. The header is extended by 49 words. The cost for the message
+   *     groups without a limit is one bit test.
+   * 0 - Rate limiter disabled.
+   */
+
+#if !defined RTE_PRIORITY_BUFFER_SIZE
+#define RTE_PRIORITY_BUFFER_SIZE          0
+#endif
+  /* >0 - Size of the priority region [32-bit words] - must be a power of 2 and larger than the
+   *      largest message. Messages of the filter numbers enabled in g_rtedbg.priority_filter
+   *      (default RTE_PRIORITY_FILTER) are copied after logging to a second circular buffer
+   *      located after the g_rtedbg.buffer[]. The critical messages therefore survive the
+   *      wrap-around of the main circular buffer. The host decoder merges both buffers
+   *      (see the rte_dec_snapshot_merged() in the Host/rte_decoder.c). Note that the F_SYSTEM
+   *      group also contains the periodic long timestamp messages - define the
+   *      RTE_PRIORITY_FILTER with a dedicated filter number or enlarge the region accordingly.
+   *  0 - Priority region disabled.
+   */
+
+#if !defined RTE_DUAL_BANK_ENABLED
+#define RTE_DUAL_BANK_ENABLED             0
+#endif
+  /* 1 - Two data logging structures (banks) are used as a ping-pong buffer: g_rtedbg (bank 0)
+   *     and g_rtedbg_bank (bank 1). Messages are logged to the active bank. The rte_swap_banks()
+   *     function (or the RTECOM_SWAP_BANKS command from the host) erases the inactive bank and
+   *     makes it active. The previously active bank is frozen and can be transferred to the host
+   *     while logging continues - the message filter does not have to be set to zero.
+   *     The RAM required for the circular buffer is doubled. Available only with one context.
+   * 0 - Single data logging structure.
+   */
+
+#if !defined RTE_LAP_COUNTER_ENABLED
+#define RTE_LAP_COUNTER_ENABLED           0
+#endif
+  /* 1 - The wrap-arounds of the circular buffer are counted in g_rtedbg.buf_laps. The
+   *     RTECOM_READ_NEW command needs it to detect that the logging has overwritten words
+   *     not yet transferred to the host (RTECOM_STREAMING_ENABLED). The header is extended
+   *     by one word. The cost is one comparison per buffer space reservation.
+   * 0 - Wrap-arounds are not counted.
+   */
+
+#if !defined RTE_HANDLE_UNALIGNED_MEMORY_ACCESS
 #define RTE_HANDLE_UNALIGNED_MEMORY_ACCESS     0
+#endif
   /* 1 - CPU core does not allow unaligned memory access or unaligned access is disabled.
+   *     The data at an unaligned address is read with aligned word accesses and the
+   *     adjacent words are combined with shifts. Only the words that contain the data
+   *     bytes are read.
    * 0 - CPU core supports unaligned memory access, and special handling of this is not necessary.
    */
 
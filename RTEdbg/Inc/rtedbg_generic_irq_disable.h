@@ -49,6 +49,7 @@
 do {                                                                 \
     RTE_ENTER_CRITICAL()                                             \
     buf_idx = ptr->buf_index;                                        \
+    RTE_COUNT_LAP(ptr, buf_idx)                                      \
     RTE_LIMIT_INDEX(buf_idx)                                         \
     ptr->buf_index = buf_idx + (size);                               \
     RTE_EXIT_CRITICAL()                                              \
@@ -74,12 +75,52 @@ do {                                                                 \
             return;        /* Exit the __rte_msg?() function. */     \
         }                                                            \
     }                                                                \
+    RTE_COUNT_LAP(ptr, buf_idx)                                      \
     RTE_LIMIT_INDEX(buf_idx)                                         \
     ptr->buf_index = buf_idx + (size);                               \
     RTE_EXIT_CRITICAL()                                              \
 } while(0)
 #endif /* RTE_SINGLE_SHOT_ENABLED == 0 */
 
+/* Return the unused words at the end of a reservation (see the __rte_stringn()).
+ * This is only possible if no space has been reserved since - released = 1 in this case.
+ */
+#define RTE_RELEASE_SPACE(ptr, end_idx, new_end, released)           \
+do {                                                                 \
+    RTE_ENTER_CRITICAL()                                             \
+    released = 0U;                                                   \
+    if (ptr->buf_index == (end_idx))                                 \
+    {                                                                \
+        ptr->buf_index = (new_end);                                  \
+        released = 1U;                                               \
+    }                                                                \
+    RTE_EXIT_CRITICAL()                                              \
+} while(0)
+
+/* Add a value to a 32-bit variable - 'old' is the value before the addition
+ * (e.g. reservation of space in the priority region).
+ */
+#define RTE_ATOMIC_FETCH_ADD(var, value, old)                        \
+do {                                                                 \
+    RTE_ENTER_CRITICAL()                                             \
+    old = (var);                                                     \
+    (var) = old + (value);                                           \
+    RTE_EXIT_CRITICAL()                                              \
+} while(0)
+
+/* Increment a 16-bit counter that stops at its maximum value (e.g. the rate_shed[]).
+ * The 16-bit counters are packed two per word - the update must not be interrupted.
+ */
+#define RTE_INCREMENT_SATURATED(var)                                 \
+do {                                                                 \
+    RTE_ENTER_CRITICAL()                                             \
+    if ((var) != 0xFFFFU)                                            \
+    {                                                                \
+        (var)++;                                                     \
+    }                                                                \
+    RTE_EXIT_CRITICAL()                                              \
+} while(0)
+
 #endif  // RTEDBG_GENERIC_IRQ_DISABLE_H
 
 /*==== End of file ====*/
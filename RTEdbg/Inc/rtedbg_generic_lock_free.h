@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rtedbg_generic_lock_free.h
+ * @author  Branko Premzel
+ * @version RTEdbg library v1.01.00
+ *
+ * @brief  Lock-free circular buffer space reservation.
+ *
+ *         The buffer index is updated with a compare-and-swap loop instead of
+ *         disabling interrupts. Data logging therefore never masks interrupts and
+ *         does not add jitter to the high priority interrupts. If the reservation
+ *         is interrupted by a task or interrupt that also logs data, the loop is
+ *         simply repeated with the new index value.
+ *
+ *         Implementations:
+ *         *) CPU cores with exclusive access instructions (e.g. ARM Cortex-M3/M4/M7/M33)
+ *            The index is updated with the LDREX/STREX instructions (CMSIS intrinsics).
+ *         *) Host build (RTE_HOST_BUILD)
+ *            The index is updated with the GCC/Clang __atomic built-in functions
+ *            (same memory model as the C11 atomics).
+ *
+ *         Enable the driver in the rtedbg_config.h:
+ *            #define RTE_CPU_DRIVER  "rtedbg_generic_lock_free.h"
+ *         The RTE_ENTER_CRITICAL() and RTE_EXIT_CRITICAL() macros are not needed.
+ *
+ * @note   The ARM Cortex-M0/M0+ cores do not have exclusive access instructions.
+ *         Use the rtedbg_generic_irq_disable.h for them.
+ *
+ * @note   Single-shot logging: the check if the message fits in the buffer is part
+ *         of the compare-and-swap loop. Only one of the writers can stop the logging
+ *         and no message is written partially beyond the end of the buffer.
+ ******************************************************************************/
+
+#ifndef RTEDBG_GENERIC_LOCK_FREE_H
+#define RTEDBG_GENERIC_LOCK_FREE_H
+
+#if RTE_SINGLE_SHOT_ENABLED == 0
+#define RTE_CHECK_SINGLE_SHOT(ptr, buf_idx, size, release)
+#else
+/* Check if there is enough space for the complete message in the single-shot mode. */
+#define RTE_CHECK_SINGLE_SHOT(ptr, buf_idx, size, release)           \
+    if (ptr->rte_cfg & RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE)            \
+    {                                                                \
+        if ((buf_idx + (size)) >= (uint32_t)(RTE_BUFFER_SIZE))       \
+        {                                                            \
+            release;                                                 \
+            RTE_STOP_MESSAGE_LOGGING();                              \
+            return;        /* Exit the __rte_msg?() function. */     \
+        }                                                            \
+    }
+#endif /* RTE_SINGLE_SHOT_ENABLED == 0 */
+
+
+/* The wrap-around is counted after the index has been updated. Only the writer that has
+ * reserved the first message after the buffer end increments the counter. The RTECOM_READ_NEW
+ * may see the new index with the old counter value for a short time (see the rte_com.c).
+ */
+#if defined RTE_HOST_BUILD
+#if RTE_LAP_COUNTER_ENABLED == 1
+#define RTE_COUNT_LAP_ATOMIC(ptr, idx)                               \
+    if ((idx) >= (uint32_t)(RTE_BUFFER_SIZE))                        \
+    {                                                                \
+        (void)__atomic_fetch_add(&ptr->buf_laps, 1U, __ATOMIC_RELAXED); \
+    }
+#else
+#define RTE_COUNT_LAP_ATOMIC(ptr, idx)
+#endif
+
+/* Compare-and-swap with the GCC/Clang atomic built-in functions. */
+#define RTE_RESERVE_SPACE(ptr, buf_idx, size)                        \
+do {                                                                 \
+    uint32_t old_idx = __atomic_load_n(&ptr->buf_index, __ATOMIC_RELAXED); \
+    uint32_t new_idx;                                                \
+    do                                                               \
+    {                                                                \
+        buf_idx = old_idx;                                           \
+        RTE_CHECK_SINGLE_SHOT(ptr, buf_idx, size, (void)0)           \
+        RTE_LIMIT_INDEX(buf_idx)                                     \
+        new_idx = buf_idx + (size);                                  \
+    }                                                                \
+    while (!__atomic_compare_exchange_n(&ptr->buf_index, &old_idx, new_idx, \
+                                        1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)); \
+    RTE_COUNT_LAP_ATOMIC(ptr, old_idx)                               \
+} while(0)
+
+/* Return the unused words at the end of a reservation (see the __rte_stringn()).
+ * This is only possible if no space has been reserved since - released = 1 in this case.
+ */
+#define RTE_RELEASE_SPACE(ptr, end_idx, new_end, released)           \
+do {                                                                 \
+    uint32_t expected_idx = (end_idx);                               \
+    released = __atomic_compare_exchange_n(&ptr->buf_index, &expected_idx, (new_end), \
+                                           0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ? 1U : 0U; \
+} while(0)
+
+/* Add a value to a 32-bit variable - 'old' is the value before the addition
+ * (e.g. reservation of space in the priority region).
+ */
+#define RTE_ATOMIC_FETCH_ADD(var, value, old)                        \
+    old = __atomic_fetch_add(&(var), (value), __ATOMIC_RELAXED)
+
+/* Increment a 16-bit counter that stops at its maximum value (e.g. the rate_shed[]). */
+#define RTE_INCREMENT_SATURATED(var)                                 \
+do {                                                                 \
+    uint16_t old_cnt = __atomic_load_n(&(var), __ATOMIC_RELAXED);    \
+    while ((old_cnt != 0xFFFFU)                                      \
+           && !__atomic_compare_exchange_n(&(var), &old_cnt, (uint16_t)(old_cnt + 1U), \
+                                           1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) \
+    {                                                                \
+    }                                                                \
+} while(0)
+
+#elif defined __ARM_FEATURE_LDREX
+/* Exclusive load and store of the buffer index (CMSIS intrinsic functions). */
+#define RTE_RESERVE_SPACE(ptr, buf_idx, size)                        \
+do {                                                                 \
+    uint32_t old_idx;                                                \
+    do                                                               \
+    {                                                                \
+        old_idx = __LDREXW(&ptr->buf_index);                         \
+        buf_idx = old_idx;                                           \
+        RTE_CHECK_SINGLE_SHOT(ptr, buf_idx, size, __CLREX())         \
+        RTE_LIMIT_INDEX(buf_idx)                                     \
+    }                                                                \
+    while (__STREXW(buf_idx + (size), &ptr->buf_index) != 0U);       \
+    RTE_COUNT_LAP(ptr, old_idx)                                      \
+} while(0)
+
+/* Return the unused words at the end of a reservation (see the __rte_stringn()).
+ * This is only possible if no space has been reserved since - released = 1 in this case.
+ */
+#define RTE_RELEASE_SPACE(ptr, end_idx, new_end, released)           \
+do {                                                                 \
+    released = 0U;                                                   \
+    while (__LDREXW(&ptr->buf_index) == (end_idx))                   \
+    {                                                                \
+        if (__STREXW((new_end), &ptr->buf_index) == 0U)              \
+        {                                                            \
+            released = 1U;                                           \
+            break;                                                   \
+        }                                                            \
+    }                                                                \
+    if (released == 0U)                                              \
+    {                                                                \
+        __CLREX();                                                   \
+    }                                                                \
+} while(0)
+
+/* Add a value to a 32-bit variable - 'old' is the value before the addition
+ * (e.g. reservation of space in the priority region).
+ */
+#define RTE_ATOMIC_FETCH_ADD(var, value, old)                        \
+do {                                                                 \
+    do                                                               \
+    {                                                                \
+        old = __LDREXW(&(var));                                      \
+    }                                                                \
+    while (__STREXW(old + (value), &(var)) != 0U);                   \
+} while(0)
+
+/* Increment a 16-bit counter that stops at its maximum value (e.g. the rate_shed[]). */
+#define RTE_INCREMENT_SATURATED(var)                                 \
+do {                                                                 \
+    uint16_t old_cnt;                                                \
+    do                                                               \
+    {                                                                \
+        old_cnt = __LDREXH(&(var));                                  \
+        if (old_cnt == 0xFFFFU)                                      \
+        {                                                            \
+            __CLREX();                                               \
+            break;                                                   \
+        }                                                            \
+    }                                                                \
+    while (__STREXH((uint16_t)(old_cnt + 1U), &(var)) != 0U);        \
+} while(0)
+
+#else
+#error "The CPU core does not support exclusive access - use the rtedbg_generic_irq_disable.h."
+#endif
+
+#endif  // RTEDBG_GENERIC_LOCK_FREE_H
+
+/*==== End of file ====*/
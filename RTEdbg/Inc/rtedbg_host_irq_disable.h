@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rtedbg_host_irq_disable.h
+ * @author  Branko Premzel
+ * @version RTEdbg library v1.01.00
+ *
+ * @brief  Stand-in for the rtedbg_generic_irq_disable.h in a host (Linux/POSIX)
+ *         build of the RTEdbg library.
+ *
+ *         Interrupts cannot be disabled in a host application. The critical
+ *         section is replaced by a spin lock, so that the circular buffer space
+ *         can also be reserved from several threads. The buffer space reservation
+ *         itself is the same as in the rtedbg_generic_irq_disable.h. This makes
+ *         the host execution time measurements comparable with the target.
+ *
+ * @note   The driver requires the GCC or Clang __atomic built-in functions.
+ ******************************************************************************/
+
+#ifndef RTEDBG_HOST_IRQ_DISABLE_H
+#define RTEDBG_HOST_IRQ_DISABLE_H
+
+static volatile char rte_host_lock;     // Spin lock replacing the interrupt disable
+
+#undef RTE_ENTER_CRITICAL
+#undef RTE_EXIT_CRITICAL
+
+#define RTE_ENTER_CRITICAL()                                         \
+    while (__atomic_test_and_set(&rte_host_lock, __ATOMIC_ACQUIRE))  \
+    {                                                                \
+    }
+
+#define RTE_EXIT_CRITICAL()                                          \
+    __atomic_clear(&rte_host_lock, __ATOMIC_RELEASE);
+
+#include "rtedbg_generic_irq_disable.h"
+
+#endif  // RTEDBG_HOST_IRQ_DISABLE_H
+
+/*==== End of file ====*/
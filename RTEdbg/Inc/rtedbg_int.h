@@ -16,6 +16,7 @@
 #ifndef RTEDBG_INT_H
 #define RTEDBG_INT_H
 
+#include <stddef.h>
 #include "rtedbg.h"
 
 // Test if the value is a power of 2 and between 2^2 and 2^31
@@ -39,9 +40,16 @@
 #define RTE_LIMIT_INDEX(idx)  {if (idx >= (uint32_t)(RTE_BUFFER_SIZE)) {idx = 0U;}}
 #endif
 
+#if RTE_LAP_COUNTER_ENABLED == 1
+// Count the wrap-around if the buffer index (before it is limited) is beyond the buffer end
+#define RTE_COUNT_LAP(ptr, idx)  {if ((idx) >= (uint32_t)(RTE_BUFFER_SIZE)) {(ptr)->buf_laps++;}}
+#else
+#define RTE_COUNT_LAP(ptr, idx)
+#endif
+
 #define RTE_TIMESTAMP_MASK  (0xFFFFFFFFU >> (uint32_t)(RTE_FMT_ID_BITS))
 
-#define RTE_HEADER_SIZE  (sizeof(g_rtedbg) - sizeof(g_rtedbg.buffer))
+#define RTE_HEADER_SIZE  offsetof(rtedbg_t, buffer)    // Size of the g_rtedbg header [bytes]
 
 /***********************************************************************************
  * The configuration word defines the embedded system RTEdbg configuration.
@@ -51,7 +59,7 @@
  *        2: 1 = RTE_FILTER_OFF_ENABLED, 0 - filter off not possible
  *        3: 1 = RTE_SINGLE_SHOT_ENABLED, 0 - only post mortem mode possible
  *        4: 1 = RTE_USE_LONG_TIMESTAMP, 0 - long timestamps disabled
- *  5 ..  7: reserved for future use
+ *  5 ..  7: Context index (0 = g_rtedbg, 1 .. 7 = g_rtedbg_ctx[0 .. 6]) - see RTE_NO_OF_CONTEXTS
  *  8 .. 11: RTE_TIMESTAMP_SHIFT (0 = shift by 1, 1 = shift by 2, etc.)
  * 12 .. 14: RTE_FMT_ID_BITS     (offset 9 => values 0 .. 7 = 9 .. 16)
  *       15: reserved for future use
@@ -60,6 +68,7 @@
  *       31: RTE_BUFF_SIZE_RTE_IS_POWER_OF_2 (1 = buffer size is power of 2, 0 - is not)
  ***********************************************************************************/
 #define RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE  1U   /* Use bit zero to indicate single shot mode = active */
+#define RTE_CONTEXT_INDEX_SHIFT  5U     /* Position of the context index in the configuration word */
 #define RTE_BUFF_SIZE_RTE_IS_POWER_OF_2    ((RTE_IS_POWER_OF_2(RTE_BUFFER_SIZE)) ? 1U : 0U)
 #if RTE_BUFF_SIZE_RTE_IS_POWER_OF_2
 #define RTE_BUFF_SIZE_IS_POWER_OF_2   1U
@@ -77,7 +86,7 @@
         ((((uint32_t)RTE_TIMESTAMP_SHIFT) - 1U)              * (1U <<  8U)) + \
         ((((uint32_t)RTE_FMT_ID_BITS) - 9U)                  * (1U << 12U)) + \
         ((((uint32_t)RTE_MAX_SUBPACKETS) & 0xFFU)            * (1U << 16U)) + \
-        (((sizeof(g_rtedbg) - sizeof(g_rtedbg.buffer)) / 4U) * (1U << 24U)) + \
+        ((RTE_HEADER_SIZE / 4U)                              * (1U << 24U)) + \
         (RTE_BUFF_SIZE_IS_POWER_OF_2                         * (1U << 31U))   \
     )
 
@@ -110,6 +119,80 @@
 #error "The RTE_USE_LONG_TIMESTAMP must have a value of 0 or 1"
 #endif
 
+#if !defined RTE_NO_OF_CONTEXTS
+#define RTE_NO_OF_CONTEXTS  1
+#endif
+
+#if ((RTE_NO_OF_CONTEXTS) > 8) || ((RTE_NO_OF_CONTEXTS) < 1)
+#error "The RTE_NO_OF_CONTEXTS must have a value between 1 and 8"
+#endif
+
+#if ((RTE_NO_OF_CONTEXTS) > 1) && !defined RTE_CONTEXT_INDEX
+#error "The RTE_CONTEXT_INDEX() macro must be defined if more than one logging context is used."
+#endif
+
+#if !defined RTE_DUAL_BANK_ENABLED
+#define RTE_DUAL_BANK_ENABLED  0
+#endif
+
+#if !defined RTE_TRIGGER_ENABLED
+#define RTE_TRIGGER_ENABLED  0
+#endif
+
+#if (RTE_TRIGGER_ENABLED == 1) && (RTE_MSG_FILTERING_ENABLED == 0)
+#error "The trigger (RTE_TRIGGER_ENABLED) stops the logging with the message filter - enable the RTE_MSG_FILTERING_ENABLED."
+#endif
+
+#if !defined RTE_STATISTICS_ENABLED
+#define RTE_STATISTICS_ENABLED  0
+#endif
+
+#if !defined RTE_RATE_LIMIT_ENABLED
+#define RTE_RATE_LIMIT_ENABLED  0
+#endif
+
+#if !defined RTE_PRIORITY_BUFFER_SIZE
+#define RTE_PRIORITY_BUFFER_SIZE  0
+#endif
+
+#if !defined RTE_SINGLE_PASS_STRINGS
+#define RTE_SINGLE_PASS_STRINGS  0
+#endif
+
+#if !defined RTE_LAP_COUNTER_ENABLED
+#define RTE_LAP_COUNTER_ENABLED  0
+#endif
+
+#if !defined RTE_SINGLE_PASS_MAX_LENGTH
+#define RTE_SINGLE_PASS_MAX_LENGTH  64
+#endif
+
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+#if !RTE_IS_POWER_OF_2((RTE_PRIORITY_BUFFER_SIZE))
+#error "The RTE_PRIORITY_BUFFER_SIZE must be a power of 2."
+#endif
+
+#if (RTE_PRIORITY_BUFFER_SIZE) < ((RTE_MAX_SUBPACKETS) * 5U)
+#error "The priority region (RTE_PRIORITY_BUFFER_SIZE) must be larger than the largest message."
+#endif
+
+#if RTE_MSG_FILTERING_ENABLED == 0
+#error "The priority region (RTE_PRIORITY_BUFFER_SIZE) is selected per filter number - enable the RTE_MSG_FILTERING_ENABLED."
+#endif
+
+#if !defined RTE_PRIORITY_FILTER
+#define RTE_PRIORITY_FILTER  (0x80000000U >> (F_SYSTEM))
+#endif
+#endif // (RTE_PRIORITY_BUFFER_SIZE) > 0
+
+#if (RTE_RATE_LIMIT_ENABLED == 1) && (RTE_MSG_FILTERING_ENABLED == 0)
+#error "The rate limiter (RTE_RATE_LIMIT_ENABLED) works per filter number - enable the RTE_MSG_FILTERING_ENABLED."
+#endif
+
+#if (RTE_DUAL_BANK_ENABLED == 1) && ((RTE_NO_OF_CONTEXTS) > 1)
+#error "The dual bank logging (RTE_DUAL_BANK_ENABLED) is available only with one logging context."
+#endif
+
 
 #if RTE_MSG_FILTERING_ENABLED != 0
 #ifndef RTE_MESSAGE_DISABLED
@@ -178,6 +261,55 @@ typedef struct
         /*!< The size of the circular data logging buffer  (RTE_BUFFER_SIZE + 4).
              It includes four additional words at the end of the buffer to speed up data logging.
          */
+#if RTE_TRIGGER_ENABLED == 1
+    volatile uint32_t trigger_state;
+        /*!< RTE_TRIGGER_OFF, RTE_TRIGGER_ARMED, RTE_TRIGGER_FIRED or RTE_TRIGGER_DONE.
+         *   The host sets the trigger parameters and then arms it.
+         */
+    uint32_t trigger_fmt;       /*!< Format ID of the trigger message (as in the FMT word). */
+    uint32_t trigger_data;      /*!< Value of the first DATA word of the trigger message. */
+    uint32_t trigger_mask;      /*!< Bits of the first DATA word compared (0 = format ID only). */
+    uint32_t trigger_post;      /*!< Number of words logged after the trigger (post-trigger window). */
+    volatile uint32_t trigger_index;
+        /*!< Index of the trigger message in the circular buffer (valid after it fired). */
+#endif
+#if RTE_RATE_LIMIT_ENABLED == 1
+    volatile uint32_t rate_limit_mask;
+        /*!< Enable the rate limiter for a group of messages (the same bit order as in the filter).
+         *   Bit 31 = filter #0, bit 30 = filter #1, ... bit 0 = filter #31.
+         */
+    uint32_t rate_limit[32];
+        /*!< Token bucket parameters for each filter number - see RTE_RATE_LIMIT_CONFIG().
+         *   Bits 0 .. 23: interval between two tokens (timestamp counter ticks / 2^RTE_TIMESTAMP_SHIFT),
+         *   bits 24 .. 31: max. number of tokens (burst size). Interval 0 = no limit.
+         */
+    volatile uint16_t rate_shed[32];
+        /*!< Number of messages discarded by the rate limiter for each filter number.
+         *   The counters stop at 0xFFFF - the host resets them by writing zero.
+         */
+#endif
+#if RTE_LAP_COUNTER_ENABLED == 1
+    volatile uint32_t buf_laps;
+        /*!< Number of circular buffer wrap-arounds (modulo 2^32). It is incremented when the
+         *   space for the first message after the buffer end is reserved.
+         */
+#endif
+#if RTE_STATISTICS_ENABLED == 1
+    /* Logging statistics - always the last RTE_STAT_WORDS words of the header.
+     * They are updated in the g_rtedbg only (for all contexts). The counters are
+     * incremented without a lock - a count may be lost if a message logging is
+     * interrupted by another one just during the counter update.
+     */
+    uint32_t stat_messages[32];
+        /*!< Number of messages logged for each filter number (index = filter number). */
+    uint32_t stat_words[32];
+        /*!< Number of circular buffer words written for each filter number. */
+    uint32_t stat_discarded;
+        /*!< Messages discarded - single shot buffer full or too long messages
+         *   (RTE_DISCARD_TOO_LONG_MESSAGES).
+         */
+    uint32_t stat_truncated;    /*!< Number of too long messages truncated. */
+#endif
     //---- g_rtedbg structure header end -----------------------------------
 
     uint32_t buffer[(uint32_t)(RTE_BUFFER_SIZE) + 4U];
@@ -186,10 +318,138 @@ typedef struct
          * the code, since the check to see if the index is already at the end of the
          * buffer is performed only once per data subpacket.
          */
+
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    //---- Priority region (after the circular buffer) ------------------------
+    /* Messages of the filter groups enabled in the priority_filter are also copied to
+     * this small circular buffer. They are overwritten by other priority messages only.
+     * The region is used in the g_rtedbg only (for all contexts).
+     */
+    volatile uint32_t priority_index;
+        /*!< Index of the next priority region word. It is not limited to the region
+         *   size - the position in the priority_buffer is the index modulo the region size.
+         */
+    volatile uint32_t priority_filter;
+        /*!< Message groups copied to the priority region (the same bit order as in the filter). */
+    uint32_t priority_size;     /*!< Size of the priority region (RTE_PRIORITY_BUFFER_SIZE + 4). */
+    uint32_t priority_buffer[(uint32_t)(RTE_PRIORITY_BUFFER_SIZE) + 4U];
+        /*!< Priority circular buffer + 4 word trailer (the same format as the buffer). */
+#endif
 } rtedbg_t;
 
 extern rtedbg_t g_rtedbg;   // Global data logging structure
 
+#if RTE_DUAL_BANK_ENABLED == 1
+extern rtedbg_t g_rtedbg_bank;                  // Second bank of the ping-pong buffer (bank 1)
+extern rtedbg_t * volatile g_rte_active_bank;   // Bank to which the messages are logged
+
+// The bank index is stored in the context index field of the rte_cfg word (0 = g_rtedbg).
+#define rte_context(context)   (((context) == 0U) ? &g_rtedbg : &g_rtedbg_bank)
+#define RTE_CURRENT_CONTEXT()  (g_rte_active_bank)
+#elif RTE_NO_OF_CONTEXTS > 1
+extern rtedbg_t g_rtedbg_ctx[(RTE_NO_OF_CONTEXTS) - 1U];   // Additional logging contexts
+
+/*********************************************************************************
+ * @brief Get the data logging structure of a context.
+ *
+ * @param context  Context index (0 = g_rtedbg)
+ *
+ * @return Pointer to the data structure
+ *********************************************************************************/
+__STATIC_FORCEINLINE rtedbg_t *rte_context(const uint32_t context)
+{
+    return (context == 0U) ? &g_rtedbg : &g_rtedbg_ctx[context - 1U];
+}
+
+// Data structure of the currently executing context (task group or interrupt priority level)
+#define RTE_CURRENT_CONTEXT()  rte_context(RTE_CONTEXT_INDEX())
+#else
+#define rte_context(context)   (&g_rtedbg)
+#define RTE_CURRENT_CONTEXT()  (&g_rtedbg)
+#endif
+
+#if RTE_TRIGGER_ENABLED == 1
+/*********************************************************************************
+ * Trigger states (trigger_state). After the trigger message has been logged,
+ * the logging continues for trigger_post words and is then stopped by setting
+ * the message filter to zero (the previous value is saved to the filter_copy).
+ * The circular buffer then contains the pre-trigger and post-trigger data.
+ *********************************************************************************/
+#define RTE_TRIGGER_OFF     0U  // Trigger not active
+#define RTE_TRIGGER_ARMED   1U  // Waiting for the trigger message
+#define RTE_TRIGGER_FIRED   2U  // Trigger message logged - post-trigger window
+#define RTE_TRIGGER_DONE    3U  // Logging stopped
+
+void rte_trigger(rtedbg_t *p_rtedbg, uint32_t fmt, uint32_t data1, uint32_t buf_index);
+
+/* Check the trigger after the space for a message has been reserved. The cost is
+ * a single comparison if the trigger is not active. The 'data1' expression is
+ * evaluated only if the trigger is active.
+ * fmt - format ID as stored in the FMT word (without the bits 31 of DATA words)
+ */
+#define RTE_TRIGGER(p_rtedbg, fmt, data1, buf_index)                      \
+    if ((p_rtedbg)->trigger_state != RTE_TRIGGER_OFF)                     \
+    {                                                                     \
+        rte_trigger((p_rtedbg), (fmt), (data1), (buf_index));             \
+    }
+#else
+#define RTE_TRIGGER(p_rtedbg, fmt, data1, buf_index)
+#endif // RTE_TRIGGER_ENABLED == 1
+
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+void rte_priority_copy(const rtedbg_t *p_rtedbg, uint32_t buf_index, uint32_t no_words);
+
+/* Copy a logged message to the priority region if its filter number is enabled in the
+ * priority_filter. The cost for other messages is one bit test.
+ */
+#define RTE_PRIORITY_COPY(p_rtedbg, fmt_id, shift_bits, buf_index, no_words)                \
+    if (!RTE_MESSAGE_DISABLED(g_rtedbg.priority_filter, fmt_id, shift_bits))                \
+    {                                                                                       \
+        rte_priority_copy((p_rtedbg), (buf_index), (no_words));                             \
+    }
+#else
+#define RTE_PRIORITY_COPY(p_rtedbg, fmt_id, shift_bits, buf_index, no_words)
+#endif // (RTE_PRIORITY_BUFFER_SIZE) > 0
+
+#if RTE_RATE_LIMIT_ENABLED == 1
+// Value of the rate_limit[] word - one message per 'interval' with bursts of up to 'burst' messages
+#define RTE_RATE_LIMIT_CONFIG(interval, burst)  \
+    (((uint32_t)(interval) & 0x00FFFFFFU) | (((uint32_t)(burst) & 0xFFU) << 24U))
+
+uint32_t rte_rate_limit(uint32_t filter_no);
+
+/* Discard the message if the rate limiter is enabled for its filter number and there are
+ * no tokens left. Checked before the space is reserved - the cost is one bit test if the
+ * limiter is not enabled for the message group.
+ */
+#define RTE_RATE_LIMIT(fmt_id, shift_bits)                                                 \
+    if (!RTE_MESSAGE_DISABLED(g_rtedbg.rate_limit_mask, fmt_id, shift_bits))               \
+    {                                                                                      \
+        if (rte_rate_limit(((fmt_id) >> ((uint32_t)(RTE_FMT_ID_BITS) - (shift_bits))) & 0x1FU) != 0U) \
+        {                                                                                  \
+            return;                                                                        \
+        }                                                                                  \
+    }
+#else
+#define RTE_RATE_LIMIT(fmt_id, shift_bits)
+#endif // RTE_RATE_LIMIT_ENABLED == 1
+
+#if ((RTE_NO_OF_CONTEXTS) > 1) && (RTE_USE_LONG_TIMESTAMP != 0)
+void rte_long_timestamp_contexts(uint32_t long_t_stamp);
+
+/* The host decodes each context separately. The short timestamps of a context can only be
+ * extended to absolute values with a long timestamp message in the same circular buffer.
+ * The message is therefore logged to the current context and copied to all other contexts.
+ */
+#define RTE_LOG_LONG_TIMESTAMP(long_t_stamp)                                               \
+    {                                                                                      \
+        RTE_MSG1(MSG1_LONG_TIMESTAMP, F_SYSTEM, long_t_stamp);                             \
+        rte_long_timestamp_contexts(long_t_stamp);                                         \
+    }
+#else
+#define RTE_LOG_LONG_TIMESTAMP(long_t_stamp)  RTE_MSG1(MSG1_LONG_TIMESTAMP, F_SYSTEM, long_t_stamp)
+#endif
+
 /*********************************************************************************
  * @brief Union defined to move the top bit of 32-bit data words into an FMT word
  *        that combines bit 31 of the DATA words with the format ID and timestamp.
@@ -211,10 +471,29 @@ typedef union
 #define RTE_PARAM(par)  par
 #endif
 
+#if RTE_STATISTICS_ENABLED == 1
+#define RTE_STAT_WORDS  66U     // Number of header words with the statistics
+
+// Count a logged message. The filter number is in the top bits of the fmt_id (see RTE_PACK).
+#define RTE_STAT_MESSAGE(fmt_id, shift_bits, no_words)                                    \
+    {                                                                                     \
+        uint32_t stat_filter = ((fmt_id) >> ((uint32_t)(RTE_FMT_ID_BITS) - (shift_bits))) & 0x1FU; \
+        g_rtedbg.stat_messages[stat_filter]++;                                            \
+        g_rtedbg.stat_words[stat_filter] += (no_words);                                   \
+    }
+#define RTE_STAT_DISCARDED()    g_rtedbg.stat_discarded++;
+#define RTE_STAT_TRUNCATED()    g_rtedbg.stat_truncated++;
+#else
+#define RTE_STAT_MESSAGE(fmt_id, shift_bits, no_words)
+#define RTE_STAT_DISCARDED()
+#define RTE_STAT_TRUNCATED()
+#endif // RTE_STATISTICS_ENABLED == 1
+
+// Called when a message is discarded in the single shot mode (buffer full)
 #if defined RTE_STOP_SINGLE_SHOT_AT_FIRST_TOO_LARGE_MSG
-#define RTE_STOP_MESSAGE_LOGGING()  ptr->filter = 0
+#define RTE_STOP_MESSAGE_LOGGING()  RTE_STAT_DISCARDED() g_rtedbg.filter = 0
 #else
-#define RTE_STOP_MESSAGE_LOGGING()
+#define RTE_STOP_MESSAGE_LOGGING()  RTE_STAT_DISCARDED()
 #endif
 
 #ifndef RTE_DATA_MEMORY_BARRIER
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**********************************************************************************
+ * @file    rtedbg_timer_host.h
+ * @author  Branko Premzel
+ * @brief   Stand-in timestamp timer driver for a host (Linux/POSIX) build of the
+ *          RTEdbg library. The monotonic system clock with nanosecond resolution
+ *          is used as a free-running 32-bit up counter.
+ *
+ * @note    This driver is intended for measuring the execution time of the data
+ *          logging functions and for testing the library and the RTEcomLib
+ *          functions on a host computer without the target hardware.
+ *          Enable it by compiling the project with the RTE_HOST_BUILD macro
+ *          defined - see the rtedbg_config.h.
+ *          The timestamp frequency is 1 GHz (RTE_GET_TSTAMP_FREQUENCY()).
+ *
+ * @version RTEdbg library v1.01.00
+ **********************************************************************************/
+
+#ifndef RTEDBG_TIMER_HOST_H
+#define RTEDBG_TIMER_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <time.h>
+#include "rtedbg.h"
+
+#define RTE_TIMESTAMP_COUNTER_BITS  32U // Number of timer counter bits available for the timestamp
+
+
+#if !defined RTE_USE_INLINE_FUNCTIONS
+#if RTE_USE_LONG_TIMESTAMP != 0
+struct _tstamp64
+{
+    uint32_t l;    // Lower 32 bits of the 64-bit timestamp
+    uint32_t h;    // Upper 32 bits of the 64-bit timestamp
+} t_stamp;
+#endif // RTE_USE_LONG_TIMESTAMP != 0
+
+
+/***
+ * @brief Initialize the timestamp counter. The host clock is always running.
+ *        Only the long timestamp has to be reset.
+ */
+
+__STATIC_FORCEINLINE void rte_init_timestamp_counter(void)
+{
+#if RTE_USE_LONG_TIMESTAMP != 0
+    t_stamp.l = t_stamp.h = 0;                      // Reset the long timestamp
+#endif
+}
+#endif  // !defined RTE_USE_INLINE_FUNCTIONS
+
+
+/***
+ * @brief Get the current value of the timestamp counter.
+ *
+ * @return Lower 32 bits of the monotonic clock value [ns].
+ */
+
+__STATIC_FORCEINLINE uint32_t rte_get_timestamp(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec);
+}
+
+
+#if (RTE_USE_LONG_TIMESTAMP != 0) && (!defined RTE_USE_INLINE_FUNCTIONS)
+
+/*********************************************************************************
+ * @brief  Writes a message with a long timestamp to the buffer.
+ *         See the description in the rtedbg_timer_systick.h.
+ *
+ * @note    This function is not reentrant.
+ *********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_long_timestamp(void)
+{
+    uint32_t timestamp =
+        (uint32_t)(rte_get_timestamp() << (32U - (RTE_TIMESTAMP_COUNTER_BITS)));
+
+    if (t_stamp.l > timestamp)    // Counter rolled over?
+    {
+        t_stamp.h++;
+    }
+
+    t_stamp.l = timestamp;
+    uint64_t timestamp_64 = (uint64_t)timestamp | ((uint64_t)t_stamp.h << 32U);
+    uint32_t long_t_stamp = (uint32_t)(timestamp_64 >>
+                                ((32U - ((uint32_t)(RTE_FMT_ID_BITS))) - 1U + (RTE_TIMESTAMP_SHIFT) +
+                                 (32U - (RTE_TIMESTAMP_COUNTER_BITS))));
+    RTE_LOG_LONG_TIMESTAMP(long_t_stamp)
+}
+
+#endif // (RTE_USE_LONG_TIMESTAMP != 0) && (!defined RTE_USE_INLINE_FUNCTIONS)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTEDBG_TIMER_HOST_H */
+
+/*==== End of file ====*/
@@ -104,7 +104,7 @@ RTE_OPTIM_SIZE void rte_long_timestamp(void)
     uint32_t long_t_stamp = (uint32_t)(timestamp_64 >>
                                 ((32U - ((uint32_t)(RTE_FMT_ID_BITS))) - 1U + (RTE_TIMESTAMP_SHIFT) +
                                  (32U - (RTE_TIMESTAMP_COUNTER_BITS))));
-    RTE_MSG1(MSG1_LONG_TIMESTAMP, F_SYSTEM, long_t_stamp);
+    RTE_LOG_LONG_TIMESTAMP(long_t_stamp)
 }
 
 #endif // (RTE_USE_LONG_TIMESTAMP != 0) && (!defined RTE_USE_INLINE_FUNCTIONS)
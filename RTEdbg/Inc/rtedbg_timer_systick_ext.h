@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**********************************************************************************
+ * @file    rtedbg_timer_systick_ext.h
+ * @author  Branko Premzel
+ * @brief   Time measurement for the data logging functions using the SYSTICK timer
+ *          extended to 32 bits by the SYSTICK interrupt.
+ *          The SYSTICK counts down from the reload value 2^RTE_SYSTICK_BITS - 1. The
+ *          interrupt at the counter reload increments the overflow counter. The
+ *          timestamp is the inverted counter value combined with the overflow counter.
+ *
+ *          The rte_long_timestamp() does not have to be called periodically by the
+ *          application. The interrupt routine logs the long timestamp only when
+ *          it is needed:
+ *          *) during a pause in logging - the host could otherwise not detect the
+ *             short timestamp overflows. The long timestamp is logged if no message
+ *             has been logged for RTE_TSTAMP_IDLE_LIMIT SYSTICK periods. The time
+ *             between two messages without a long timestamp in between is then
+ *             less than half the short timestamp period (if the interrupt latency
+ *             is shorter than one SYSTICK period). During a pause, the long timestamp
+ *             is logged every half short timestamp period minus one SYSTICK period.
+ *          *) every RTE_LONG_TIMESTAMP_INTERVAL SYSTICK interrupts - the post-mortem
+ *             data must contain a long timestamp to determine the absolute time.
+ *          *) if RTE_TSTAMP_ANCHOR_WORDS (default half the circular buffer) or more
+ *             words have been logged since the last long timestamp - messages older
+ *             than the first long timestamp in a post-mortem snapshot can not be
+ *             decoded. During busy periods the buffer could otherwise be overwritten
+ *             several times between two periodic long timestamps. The logged words
+ *             are counted at each interrupt, so fewer than RTE_BUFFER_SIZE words
+ *             should be logged per SYSTICK period.
+ *          No long timestamps are needed while messages are logged frequently.
+ *          The short timestamp period must be at least eight SYSTICK periods
+ *          (checked at compile time).
+ *
+ * @note    The driver defines the interrupt routine RTE_TSTAMP_OVERFLOW_HANDLER
+ *          (default: SysTick_Handler). Define another name if the application has
+ *          its own SysTick_Handler and call the function from there.
+ *          The SYSTICK interrupt must be able to interrupt the code that logs
+ *          messages, or the critical sections must be shorter than half the SYSTICK
+ *          period. The overflow that has not been processed yet is detected with the
+ *          SYSTICK pending bit. The interrupt routine is executed every 2^20 CPU clock
+ *          cycles by default (21.8 ms at 48 MHz).
+ *          With several logging contexts or dual bank logging, the long timestamps
+ *          are logged to the data structure that is active for the SYSTICK interrupt.
+ *          See also the notes in the rtedbg_timer_systick.h.
+ *
+ * @version RTEdbg library v1.01.00
+ **********************************************************************************/
+
+#ifndef RTEDBG_TIMER_SYSTICK_EXT_H
+#define RTEDBG_TIMER_SYSTICK_EXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rtedbg.h"
+
+#define RTE_TIMESTAMP_COUNTER_BITS  32U // Number of timer counter bits available for the timestamp
+#define RTE_LONG_TIMESTAMP_REENTRANT 1U // The rte_long_timestamp() may be called from any interrupt
+
+#if !defined RTE_SYSTICK_BITS
+#define RTE_SYSTICK_BITS            20U // SYSTICK period = 2^RTE_SYSTICK_BITS CPU clock cycles
+#endif
+
+#if !defined RTE_LONG_TIMESTAMP_INTERVAL
+#define RTE_LONG_TIMESTAMP_INTERVAL 64U // Max. number of SYSTICK periods between two long timestamps
+#endif                                  // (0 = only during the pauses in logging)
+
+#if !defined RTE_TSTAMP_ANCHOR_WORDS
+#define RTE_TSTAMP_ANCHOR_WORDS     ((RTE_BUFFER_SIZE) / 2U)    // Max. number of words logged between
+#endif                                  // two long timestamps (checked at the SYSTICK interrupt)
+
+#if !defined RTE_TSTAMP_OVERFLOW_HANDLER
+#define RTE_TSTAMP_OVERFLOW_HANDLER SysTick_Handler
+#endif
+
+#define RTE_SYSTICK_RELOAD  ((1UL << (RTE_SYSTICK_BITS)) - 1UL)
+
+// Number of SYSTICK periods without messages after which the long timestamp is logged
+// (half the number of SYSTICK periods in the short timestamp period minus two)
+#define RTE_TSTAMP_IDLE_LIMIT \
+    ((1UL << ((((31U - (RTE_FMT_ID_BITS)) + (RTE_TIMESTAMP_SHIFT)) - (RTE_SYSTICK_BITS)) - 1U)) - 2UL)
+
+#if ((RTE_SYSTICK_BITS) > 24U) || ((RTE_SYSTICK_BITS) < 16U)
+#error "The RTE_SYSTICK_BITS must have a value between 16 and 24."
+#endif
+
+#if ((31U - (RTE_FMT_ID_BITS)) + (RTE_TIMESTAMP_SHIFT)) < ((RTE_SYSTICK_BITS) + 3U)
+#error "The short timestamp period must be at least eight SYSTICK periods - decrease the RTE_SYSTICK_BITS or increase the RTE_TIMESTAMP_SHIFT."
+#endif
+
+
+#if !defined RTE_USE_INLINE_FUNCTIONS
+volatile uint32_t rte_tstamp_overflows;     // Number of SYSTICK counter overflows
+
+static struct
+{
+    uint32_t last_index;    // Value of the buf_index at the previous SYSTICK interrupt
+    uint32_t idle;          // Number of SYSTICK interrupts without logged messages
+    uint32_t countdown;     // Number of SYSTICK interrupts until the next long timestamp
+    uint32_t words;         // Number of words logged since the last long timestamp
+} rte_tstamp_ext;
+
+
+/***
+ * @brief Initialize the SYSTICK timer, enable its interrupt and reset the overflow counter.
+ */
+
+__STATIC_FORCEINLINE void rte_init_timestamp_counter(void)
+{
+    rte_tstamp_overflows = 0U;
+    rte_tstamp_ext.last_index = 0U;
+    rte_tstamp_ext.idle = 0U;
+    rte_tstamp_ext.countdown = 1U;              // Log the long timestamp at the first interrupt
+    rte_tstamp_ext.words = 0U;
+    SysTick->LOAD  = RTE_SYSTICK_RELOAD;            /* Set the reload register */
+    SysTick->VAL   = 0UL;                           /* Reload the counter */
+    SysTick->CTRL  = SysTick_CTRL_CLKSOURCE_Msk |   /* Use the CPU core clock, */
+                     SysTick_CTRL_TICKINT_Msk |     /* enable the interrupt and */
+                     SysTick_CTRL_ENABLE_Msk;       /* enable the SysTick Timer */
+}
+#else
+extern volatile uint32_t rte_tstamp_overflows;
+#endif  // !defined RTE_USE_INLINE_FUNCTIONS
+
+
+/***
+ * @brief Get the current value of the extended (64-bit) timestamp counter.
+ *        The overflow counter is read again if the interrupt has changed it in the
+ *        meantime. An overflow that has not yet been processed by the interrupt
+ *        (interrupts disabled or a higher priority code running) is detected with
+ *        the pending bit. The counter has just been reloaded if its value is small.
+ *
+ * @return Current value of the extended timer counter.
+ */
+
+__STATIC_FORCEINLINE uint64_t rte_get_timestamp_64(void)
+{
+    uint32_t overflows;
+    uint32_t count;
+    uint32_t pending;
+
+    do
+    {
+        overflows = rte_tstamp_overflows;
+        count = ~SysTick->VAL & RTE_SYSTICK_RELOAD;   // Invert - the SYSTICK is a down counter
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    }
+    while (overflows != rte_tstamp_overflows);
+
+    if ((pending != 0U) && (count < ((RTE_SYSTICK_RELOAD + 1UL) / 2UL)))
+    {
+        overflows++;
+    }
+
+    return ((uint64_t)overflows << (RTE_SYSTICK_BITS)) | count;
+}
+
+
+/***
+ * @brief Get the current value of the timestamp counter.
+ *
+ * @return Lower 32 bits of the extended timer counter.
+ */
+
+__STATIC_FORCEINLINE uint32_t rte_get_timestamp(void)
+{
+    return (uint32_t)rte_get_timestamp_64();
+}
+
+
+#if !defined RTE_USE_INLINE_FUNCTIONS
+
+#if RTE_USE_LONG_TIMESTAMP != 0
+/*********************************************************************************
+ * @brief  Writes a message with a long timestamp to the buffer.
+ *         The low bits of the timestamp are included in the message words with the
+ *         format ID. Only the higher 32 bits are transmitted in the message's
+ *         data part.
+ *
+ * @note   The function may be called from anywhere - the long timestamp is
+ *         calculated from the extended timer counter.
+ *********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_long_timestamp(void)
+{
+    uint64_t timestamp_64 = rte_get_timestamp_64();
+    uint32_t long_t_stamp = (uint32_t)(timestamp_64 >>
+                                ((31U - ((uint32_t)(RTE_FMT_ID_BITS))) + (RTE_TIMESTAMP_SHIFT)));
+    RTE_LOG_LONG_TIMESTAMP(long_t_stamp)
+    rte_tstamp_ext.words = 0U;
+}
+#endif // RTE_USE_LONG_TIMESTAMP != 0
+
+
+/*********************************************************************************
+ * @brief  SYSTICK interrupt - extend the timer counter and log the long timestamp
+ *         if no message has been logged for RTE_TSTAMP_IDLE_LIMIT interrupts, if
+ *         the RTE_LONG_TIMESTAMP_INTERVAL has elapsed or if RTE_TSTAMP_ANCHOR_WORDS
+ *         have been logged since the last long timestamp.
+ *********************************************************************************/
+
+void RTE_TSTAMP_OVERFLOW_HANDLER(void)
+{
+    rte_tstamp_overflows++;
+
+#if RTE_USE_LONG_TIMESTAMP != 0
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
+    uint32_t index = p_rtedbg->buf_index;
+    uint32_t log_timestamp = 0U;
+
+    if (index != rte_tstamp_ext.last_index)
+    {
+        rte_tstamp_ext.idle = 0U;
+        uint32_t words = index - rte_tstamp_ext.last_index;
+        if (index < rte_tstamp_ext.last_index)
+        {
+            words += (uint32_t)(RTE_BUFFER_SIZE);   // The index has wrapped around
+        }
+        rte_tstamp_ext.words += words;
+        if (rte_tstamp_ext.words >= (uint32_t)(RTE_TSTAMP_ANCHOR_WORDS))
+        {
+            log_timestamp = 1U;
+        }
+    }
+    else
+    {
+        rte_tstamp_ext.idle++;
+        if (rte_tstamp_ext.idle >= RTE_TSTAMP_IDLE_LIMIT)
+        {
+            log_timestamp = 1U;
+        }
+    }
+
+#if (RTE_LONG_TIMESTAMP_INTERVAL) > 0
+    rte_tstamp_ext.countdown--;
+    if (rte_tstamp_ext.countdown == 0U)
+    {
+        log_timestamp = 1U;
+    }
+#endif
+
+    if (log_timestamp != 0U)
+    {
+        // The last_index is not updated - the long timestamp is counted as a logged
+        // message at the next interrupt.
+        rte_long_timestamp();
+        rte_tstamp_ext.countdown = RTE_LONG_TIMESTAMP_INTERVAL;
+        rte_tstamp_ext.idle = 0U;
+    }
+
+    rte_tstamp_ext.last_index = index;
+#endif // RTE_USE_LONG_TIMESTAMP != 0
+}
+
+#endif // !defined RTE_USE_INLINE_FUNCTIONS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTEDBG_TIMER_SYSTICK_EXT_H */
+
+/*==== End of file ====*/
@@ -38,6 +38,10 @@
 // Project-specific includes - define them in the rtedbg_config.h
 #include RTE_TIMER_DRIVER   // Timestamp timer driver
 
+#if !defined RTE_LONG_TIMESTAMP_REENTRANT
+#define RTE_LONG_TIMESTAMP_REENTRANT 0U // The rte_long_timestamp() of the driver is not reentrant
+#endif
+
 #if defined RTE_USE_LOCAL_CPU_DRIVER
 /* The option to enable a simpler and faster driver for a section of code with a priority
  * level high enough to prevent interruptions during execution. This applies only to
@@ -47,10 +51,176 @@
 #include RTE_CPU_DRIVER     // Buffer space reservation macro specific to the CPU
 #endif
 
+#if !defined RTE_RELEASE_SPACE
+// The CPU driver cannot return the unused reserved space (see the __rte_stringn())
+#define RTE_RELEASE_SPACE(ptr, end_idx, new_end, released)  {released = 0U;}
+#endif
+
+#if !defined RTE_ATOMIC_FETCH_ADD
+// The CPU driver does not define the atomic addition - a critical section is used
+#define RTE_ATOMIC_FETCH_ADD(var, value, old)                        \
+do {                                                                 \
+    RTE_ENTER_CRITICAL()                                             \
+    old = (var);                                                     \
+    (var) = old + (value);                                           \
+    RTE_EXIT_CRITICAL()                                              \
+} while(0)
+#endif
+
+#if !defined RTE_INCREMENT_SATURATED
+// The CPU driver does not define the atomic increment (e.g. a local driver for code that is not interrupted)
+#define RTE_INCREMENT_SATURATED(var)  {if ((var) != 0xFFFFU) {(var)++;}}
+#endif
+
 #if !defined RTE_USE_INLINE_FUNCTIONS
 #define RTE_CFG_MSG0_4 RTE_OPTIM_SPEED  /* Local configuration for __rte_msg0 to __rte_msg4 */
 
 rtedbg_t g_rtedbg RTE_DBG_RAM;      //!< Data structure with circular logging buffer
+static_assert((RTE_HEADER_SIZE / 4U) <= 127U,
+              "The g_rtedbg header size does not fit into the rte_cfg word (max. 127 words) - disable an option.");
+#if RTE_NO_OF_CONTEXTS > 1
+rtedbg_t g_rtedbg_ctx[(RTE_NO_OF_CONTEXTS) - 1U] RTE_DBG_RAM;
+    //!< Data structures of the additional logging contexts (context 1, 2, ...)
+#endif
+#if RTE_DUAL_BANK_ENABLED == 1
+rtedbg_t g_rtedbg_bank RTE_DBG_RAM; //!< Second bank of the ping-pong buffer
+rtedbg_t * volatile g_rte_active_bank = &g_rtedbg;  //!< Bank to which the messages are logged
+#endif
+#if RTE_RATE_LIMIT_ENABLED == 1
+typedef struct
+{
+    uint32_t tokens;    // Number of messages that can be logged without waiting
+    uint32_t last;      // Time of the last token refill (timestamp scaled to 32 bits)
+} rte_rate_state_t;
+
+static rte_rate_state_t rte_rate_state[32];    //!< Token buckets of the rate limiter
+#endif
+
+
+/********************************************************************************
+ * @brief Set the complete circular buffer to RTE_ERASED_STATE.
+ *
+ * @param p_rtedbg   Pointer to the data structure
+ ********************************************************************************/
+
+__STATIC_FORCEINLINE void rte_erase_buffer(rtedbg_t *p_rtedbg)
+{
+#if defined RTE_USE_MEMSET
+    memset(&p_rtedbg->buffer, RTE_ERASED_STATE & 0xFFu, sizeof(p_rtedbg->buffer));
+#else
+    int32_t count = (int32_t)((sizeof(p_rtedbg->buffer) / sizeof(uint32_t)) - 1U);
+    do
+    {
+        *((volatile uint32_t *)(&p_rtedbg->buffer[(unsigned)count])) = RTE_ERASED_STATE;  //lint !e929
+            // volatile used to prevent compiler from using the memset() function
+            // memset() is slow in many embedded system library implementations (setting bytes instead of words)
+        count--;
+    }
+    while (count >= 0);
+#endif // defined RTE_USE_MEMSET
+}
+
+
+#if RTE_STATISTICS_ENABLED == 1
+/********************************************************************************
+ * @brief Clear the logging statistics counters.
+ *
+ * @param p_rtedbg   Pointer to the data structure
+ ********************************************************************************/
+
+__STATIC_FORCEINLINE void rte_clear_statistics(rtedbg_t *p_rtedbg)
+{
+    for (uint32_t filter_no = 0U; filter_no < 32U; filter_no++)
+    {
+        p_rtedbg->stat_messages[filter_no] = 0U;
+        p_rtedbg->stat_words[filter_no] = 0U;
+    }
+    p_rtedbg->stat_discarded = 0U;
+    p_rtedbg->stat_truncated = 0U;
+}
+#endif // RTE_STATISTICS_ENABLED == 1
+
+
+/********************************************************************************
+ * @brief Initialize a data logging structure - see the rte_init() description.
+ *
+ * @param p_rtedbg   Pointer to the data structure (context)
+ * @param config_id  Configuration word value (including the context index)
+ ********************************************************************************/
+
+__STATIC_FORCEINLINE void rte_init_context(rtedbg_t *p_rtedbg, uint32_t config_id,
+                                           const uint32_t initial_filter_value, const uint32_t init_mode)
+{
+#if (RTE_FILTER_OFF_ENABLED == 0) || (RTE_MSG_FILTERING_ENABLED == 0)
+    UNUSED(initial_filter_value);
+#endif
+
+#if RTE_SINGLE_SHOT_ENABLED != 0
+    if ((init_mode & RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE) != 0U)
+    {
+        config_id |= RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE;
+        p_rtedbg->buf_index = 0U;
+    }
+#endif // RTE_SINGLE_SHOT_ENABLED != 0
+
+    // If the structure has not yet been initialized, clear the header and circular buffer.
+    if ((p_rtedbg->rte_cfg != config_id) || (init_mode >= RTE_RESTART_LOGGING))
+    {
+        /* Disable logging so that no task logs data during initialization.
+         * The g_rtedbg message filter applies to all contexts. */
+        g_rtedbg.filter = 0U;
+        RTE_DATA_MEMORY_BARRIER();  // Make sure all CPU cores see the change.
+
+        /* Initialize the g_rtedbg structure and buffer after a power-on reset or reboot. The
+         * circular buffer must be set to 0xFFFFFFFF. This is the only value that does not
+         * appear as normal data and enables the rtemsg data decoding software to detect that
+         * part of the buffer has been reserved but not yet written to - e.g. because the task
+         * logging data has been interrupted for a long time by higher priority tasks or services. */
+        rte_erase_buffer(p_rtedbg);
+
+#if (RTE_FILTER_OFF_ENABLED != 0) && (RTE_MSG_FILTERING_ENABLED != 0)
+        p_rtedbg->filter = initial_filter_value;
+#if RTE_FIRMWARE_MAY_SET_FILTER == 1
+        p_rtedbg->filter_copy = initial_filter_value;
+#endif
+#endif
+        p_rtedbg->buf_index = 0U;
+#if RTE_LAP_COUNTER_ENABLED == 1
+        p_rtedbg->buf_laps = 0U;
+#endif
+#if RTE_TRIGGER_ENABLED == 1
+        p_rtedbg->trigger_state = RTE_TRIGGER_OFF;
+#endif
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+        for (uint32_t i = 0U; i < ((uint32_t)(RTE_PRIORITY_BUFFER_SIZE) + 4U); i++)
+        {
+            p_rtedbg->priority_buffer[i] = RTE_ERASED_STATE;
+        }
+        p_rtedbg->priority_index = 0U;
+        p_rtedbg->priority_filter = (p_rtedbg == &g_rtedbg) ? (RTE_PRIORITY_FILTER) : 0U;
+#endif
+#if RTE_RATE_LIMIT_ENABLED == 1
+        p_rtedbg->rate_limit_mask = 0U;
+        for (uint32_t filter_no = 0U; filter_no < 32U; filter_no++)
+        {
+            p_rtedbg->rate_limit[filter_no] = 0U;
+            p_rtedbg->rate_shed[filter_no] = 0U;
+        }
+#endif
+#if RTE_STATISTICS_ENABLED == 1
+        rte_clear_statistics(p_rtedbg);
+#endif
+    }
+
+    p_rtedbg->rte_cfg = config_id;
+    p_rtedbg->buffer_size = (uint32_t)(RTE_BUFFER_SIZE) + 4U;
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    p_rtedbg->priority_size = (uint32_t)(RTE_PRIORITY_BUFFER_SIZE) + 4U;
+#endif
+
+    // Set the timestamp frequency
+    p_rtedbg->timestamp_frequency = RTE_GET_TSTAMP_FREQUENCY();
+}
 
 
 /********************************************************************************
@@ -92,54 +262,25 @@ RTE_OPTIM_SIZE void rte_init(const uint32_t initial_filter_value, const uint32_t
 #endif
 
     uint32_t config_id = RTE_CONFIG_ID;                                     //lint !e9053
-#if RTE_SINGLE_SHOT_ENABLED != 0
-    if ((init_mode & RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE) != 0U)
-    {
-        config_id |= RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE;
-        g_rtedbg.buf_index = 0U;
-    }
-#endif // RTE_SINGLE_SHOT_ENABLED != 0
 
-    // If g_rtedbg has not yet been initialized, clear the header and circular buffer.
-    if ((g_rtedbg.rte_cfg != config_id) || (init_mode >= RTE_RESTART_LOGGING))
+#if RTE_NO_OF_CONTEXTS > 1
+    /* The additional contexts are initialized first and the g_rtedbg (context 0)
+     * last. The context index is stored in the configuration word. */
+    for (uint32_t context = (uint32_t)(RTE_NO_OF_CONTEXTS) - 1U; context > 0U; context--)
     {
-        /* Disable logging so that no task logs data during initialization. */
-        g_rtedbg.filter = 0U;
-        RTE_DATA_MEMORY_BARRIER();  // Make sure all CPU cores see the change.
-
-        /* Initialize the g_rtedbg structure and buffer after a power-on reset or reboot. The
-         * circular buffer must be set to 0xFFFFFFFF. This is the only value that does not
-         * appear as normal data and enables the rtemsg data decoding software to detect that
-         * part of the buffer has been reserved but not yet written to - e.g. because the task
-         * logging data has been interrupted for a long time by higher priority tasks or services. */
-#if defined RTE_USE_MEMSET
-        memset(&g_rtedbg.buffer, RTE_ERASED_STATE & 0xFFu, sizeof(g_rtedbg.buffer));
-#else
-        int32_t count = (int32_t)((sizeof(g_rtedbg.buffer) / sizeof(uint32_t)) - 1U);
-        do
-        {
-            *((volatile uint32_t *)(&g_rtedbg.buffer[(unsigned)count])) = RTE_ERASED_STATE;  //lint !e929
-                // volatile used to prevent compiler from using the memset() function
-                // memset() is slow in many embedded system library implementations (setting bytes instead of words)
-            count--;
-        }
-        while (count >= 0);
-#endif // defined RTE_USE_MEMSET
-
-#if (RTE_FILTER_OFF_ENABLED != 0) && (RTE_MSG_FILTERING_ENABLED != 0)
-        g_rtedbg.filter = initial_filter_value;
-#if RTE_FIRMWARE_MAY_SET_FILTER == 1
-        g_rtedbg.filter_copy = initial_filter_value;
-#endif
-#endif
-        g_rtedbg.buf_index = 0U;
+        rte_init_context(rte_context(context), config_id | (context << RTE_CONTEXT_INDEX_SHIFT),
+                         initial_filter_value, init_mode);
     }
+#endif
 
-    g_rtedbg.rte_cfg = config_id;
-    g_rtedbg.buffer_size = (uint32_t)(RTE_BUFFER_SIZE) + 4U;
+#if RTE_DUAL_BANK_ENABLED == 1
+    // Bank 1 has the bank index in the context index field of the configuration word.
+    g_rte_active_bank = &g_rtedbg;
+    rte_init_context(&g_rtedbg_bank, config_id | (1U << RTE_CONTEXT_INDEX_SHIFT),
+                     initial_filter_value, init_mode);
+#endif
 
-    // Set the timestamp frequency and initialize the timestamp timer
-    g_rtedbg.timestamp_frequency = RTE_GET_TSTAMP_FREQUENCY();
+    rte_init_context(&g_rtedbg, config_id, initial_filter_value, init_mode);
     rte_init_timestamp_counter();
 
 #if RTE_FILTER_OFF_ENABLED != 0
@@ -170,25 +311,29 @@ RTE_OPTIM_SIZE void rte_init(const uint32_t initial_filter_value, const uint32_t
 
 RTE_CFG_MSG0_4 void __rte_msg0(const uint32_t fmt_id)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 0U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 0U))
     {
         return;     // Discard the message if not enabled
     }
+    RTE_RATE_LIMIT(fmt_id, 0U)
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, 1U);                             //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id, 0U, buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 0U, 1U)
 
 #if RTE_DELAYED_TSTAMP_READ != 0
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
     p_rtedbg->buffer[buf_index] = timestamp | 1U | (fmt_id << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 0U, buf_index, 1U)
 }
 
 
@@ -201,23 +346,26 @@ RTE_CFG_MSG0_4 void __rte_msg0(const uint32_t fmt_id)
 
 RTE_CFG_MSG0_4 void __rte_msg1(const uint32_t fmt_id, const rte_any32_t data1)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 1U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 1U))
     {
         return;
     }
+    RTE_RATE_LIMIT(fmt_id, 1U)
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, 2U);                             //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id << 1U, RTE_PARAM(data1), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 1U, 2U)
 
     rte_pack_data_t data;                                                   //lint !e9018
     data.w32.bits31 = fmt_id;
-    uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+    uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
 
     data.w32.data = RTE_PARAM(data1);
     data.w64 <<= 1U;
@@ -228,6 +376,7 @@ RTE_CFG_MSG0_4 void __rte_msg1(const uint32_t fmt_id, const rte_any32_t data1)
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
     *data_packet = timestamp | 1U | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 1U, buf_index, 2U)
 }
 
 
@@ -240,26 +389,29 @@ RTE_CFG_MSG0_4 void __rte_msg1(const uint32_t fmt_id, const rte_any32_t data1)
 
 RTE_CFG_MSG0_4 void __rte_msg2(const uint32_t fmt_id, const rte_any32_t data1, const rte_any32_t data2)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 2U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 2U))
     {
         return;
     }
+    RTE_RATE_LIMIT(fmt_id, 2U)
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, 3U);                             //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id << 2U, RTE_PARAM(data1), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 2U, 3U)
 
     rte_pack_data_t data;                                                   //lint !e9018
     data.w32.bits31 = fmt_id;
 
     data.w32.data = RTE_PARAM(data1);
     data.w64 <<= 1U;
-    uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+    uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
     *data_packet = data.w32.data;
     data_packet++;
 
@@ -273,6 +425,7 @@ RTE_CFG_MSG0_4 void __rte_msg2(const uint32_t fmt_id, const rte_any32_t data1, c
 #endif
     // The FMT word with timestamp is written as the last value after other values are already in the buffer
     *data_packet = timestamp | 1U | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 2U, buf_index, 3U)
 }
 
 
@@ -286,26 +439,29 @@ RTE_CFG_MSG0_4 void __rte_msg2(const uint32_t fmt_id, const rte_any32_t data1, c
 RTE_CFG_MSG0_4 void __rte_msg3(const uint32_t fmt_id, const rte_any32_t data1,
                                 const rte_any32_t data2, const rte_any32_t data3)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 3U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 3U))
     {
         return;
     }
+    RTE_RATE_LIMIT(fmt_id, 3U)
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, 4U);                             //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id << 3U, RTE_PARAM(data1), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 3U, 4U)
 
     rte_pack_data_t data;                                                   //lint !e9018
     data.w32.bits31 = fmt_id;
 
     data.w32.data = RTE_PARAM(data1);
     data.w64 <<= 1U;    // The top bit of all data words are packed to the FMT word
-    uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+    uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
     *data_packet = data.w32.data;
     data_packet++;
 
@@ -325,6 +481,7 @@ RTE_CFG_MSG0_4 void __rte_msg3(const uint32_t fmt_id, const rte_any32_t data1,
 
     // The FMT word with timestamp is written as the last value after other values are already in the buffer
     *data_packet = timestamp | 1U | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 3U, buf_index, 4U)
 }
 
 
@@ -338,19 +495,22 @@ RTE_CFG_MSG0_4 void __rte_msg3(const uint32_t fmt_id, const rte_any32_t data1,
 RTE_CFG_MSG0_4 void __rte_msg4(const uint32_t fmt_id, const rte_any32_t data1, const rte_any32_t data2,
                                 const rte_any32_t data3, const rte_any32_t data4)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 4U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 4U))
     {
         return;
     }
+    RTE_RATE_LIMIT(fmt_id, 4U)
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, 5U);                             //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id << 4U, RTE_PARAM(data1), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 4U, 5U)
 
     rte_pack_data_t data;                                                   //lint !e9018
     data.w32.bits31 = fmt_id;
@@ -358,7 +518,7 @@ RTE_CFG_MSG0_4 void __rte_msg4(const uint32_t fmt_id, const rte_any32_t data1, c
     // Save data to the buffer
     data.w32.data = RTE_PARAM(data1);
     data.w64 <<= 1U;
-    uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+    uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
     *data_packet = data.w32.data;
     data_packet++;
 
@@ -383,6 +543,7 @@ RTE_CFG_MSG0_4 void __rte_msg4(const uint32_t fmt_id, const rte_any32_t data1, c
 
     // The FMT word with timestamp is written as the last value after other values are already in the buffer
     *data_packet = timestamp | 1U | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 4U, buf_index, 5U)
 }
 
 #else // RTE_MINIMIZED_CODE_SIZE == 1
@@ -440,6 +601,249 @@ RTE_OPTIM_SIZE void __rte_msg4(const uint32_t fmt_id, const rte_any32_t data1, c
 
 
 #if !defined RTE_USE_INLINE_FUNCTIONS
+#if RTE_TRIGGER_ENABLED == 1
+/********************************************************************************
+ * @brief Check the trigger condition and stop the logging at the end of the
+ *        post-trigger window. Called by the RTE_TRIGGER() macro if the trigger
+ *        is active (armed or fired).
+ *
+ * @param p_rtedbg   Pointer to the data structure to which the message is logged
+ * @param fmt        Format ID as stored in the FMT word (without the bits 31 of DATA words)
+ * @param data1      First DATA word of the message (0 if there is no data)
+ * @param buf_index  Index of the message in the circular buffer
+ *
+ * @note  The logging is stopped by the first message that starts at least
+ *        trigger_post words after the trigger message. That message is still logged.
+ *        The trigger_post value must be smaller than the buffer size, otherwise the
+ *        pre-trigger data and the trigger message are overwritten.
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_trigger(rtedbg_t *p_rtedbg, uint32_t fmt, uint32_t data1, uint32_t buf_index)
+{
+    uint32_t state = p_rtedbg->trigger_state;
+
+    if (state == RTE_TRIGGER_ARMED)
+    {
+        if ((((fmt ^ p_rtedbg->trigger_fmt) & ((1U << (uint32_t)(RTE_FMT_ID_BITS)) - 1U)) != 0U)
+            || (((data1 ^ p_rtedbg->trigger_data) & p_rtedbg->trigger_mask) != 0U))
+        {
+            return;     // Not the trigger message
+        }
+
+        p_rtedbg->trigger_index = buf_index;
+        p_rtedbg->trigger_state = RTE_TRIGGER_FIRED;
+    }
+    else if (state != RTE_TRIGGER_FIRED)
+    {
+        return;
+    }
+
+    uint32_t trigger_index = p_rtedbg->trigger_index;
+    uint32_t distance = buf_index - trigger_index;
+    if (buf_index < trigger_index)
+    {
+        distance += (uint32_t)(RTE_BUFFER_SIZE);    // The index has wrapped around
+    }
+
+    if (distance >= p_rtedbg->trigger_post)
+    {
+        // End of the post-trigger window - stop logging (the host can restore the filter)
+        uint32_t filter = g_rtedbg.filter;
+        if (filter != 0U)
+        {
+            g_rtedbg.filter_copy = filter;
+        }
+        g_rtedbg.filter = 0U;
+        RTE_DATA_MEMORY_BARRIER();  // Ensure visibility of changes across all CPU cores.
+        p_rtedbg->trigger_state = RTE_TRIGGER_DONE;
+    }
+}
+
+
+/********************************************************************************
+ * @brief Get the first DATA word of a message for the trigger data comparison.
+ *        The data is read byte by byte, so the address does not have to be aligned.
+ *
+ * @param address  Start address of data
+ * @param length   Data length (bytes)
+ *
+ * @return First data word (unused bytes are zero)
+ ********************************************************************************/
+
+__STATIC_FORCEINLINE uint32_t rte_trigger_data(volatile const void *const address, uint32_t length)
+{
+    volatile const uint8_t *addr = (volatile const uint8_t *)address;      //lint !e925 !e9079
+    uint32_t data = 0U;
+
+    if (length > 4U)
+    {
+        length = 4U;
+    }
+
+    while (length > 0U)
+    {
+        length--;
+        data = (data << 8U) | (uint32_t)addr[length];
+    }
+
+    return data;
+}
+#endif // RTE_TRIGGER_ENABLED == 1
+
+
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+/********************************************************************************
+ * @brief Copy a message to the priority region of the g_rtedbg. Called by the
+ *        RTE_PRIORITY_COPY() macro after the message has been written to the
+ *        circular buffer if its filter number is enabled in the priority_filter.
+ *        The subpackets are copied in the same way as they were written - a subpacket
+ *        at the end of the region continues in the four-word trailer.
+ *
+ * @param p_rtedbg   Pointer to the data structure to which the message was logged
+ * @param buf_index  Index of the message in the circular buffer
+ * @param no_words   Message size (number of words)
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_priority_copy(const rtedbg_t *p_rtedbg, uint32_t buf_index, uint32_t no_words)
+{
+    uint32_t index;
+
+    // Reserve space in the priority region in the same way as in the circular buffer
+    // (CPU driver). The index is not limited (wraps at 2^32).
+    RTE_ATOMIC_FETCH_ADD(g_rtedbg.priority_index, no_words, index);
+
+    do
+    {
+        const uint32_t *p_src = &p_rtedbg->buffer[buf_index];
+        uint32_t *p_dst = &g_rtedbg.priority_buffer[index & ((uint32_t)(RTE_PRIORITY_BUFFER_SIZE) - 1U)];
+        uint32_t words_this_packet = (no_words > 5U) ? 5U : no_words;
+
+        for (uint32_t i = 0U; i < words_this_packet; i++)
+        {
+            p_dst[i] = p_src[i];    // The FMT word is copied last
+        }
+
+        buf_index += 5U;
+        RTE_LIMIT_INDEX(buf_index)
+        index += 5U;
+        no_words -= words_this_packet;
+    }
+    while (no_words > 0U);
+}
+#endif // (RTE_PRIORITY_BUFFER_SIZE) > 0
+
+
+#if RTE_RATE_LIMIT_ENABLED == 1
+/********************************************************************************
+ * @brief Token bucket rate limiter. Called by the RTE_RATE_LIMIT() macro if the
+ *        limiter is enabled for the filter number of the message (rate_limit_mask).
+ *        A token is added every 'interval' up to the burst size. Each logged message
+ *        uses one token. Messages are discarded while there are no tokens left.
+ *
+ * @param filter_no  Filter number of the message (0 ... 31)
+ *
+ * @return 0 - log the message, 1 - discard it (counted in the rate_shed[filter_no])
+ *
+ * @note  The interval must be shorter than the period of the timestamp counter.
+ *        If no message of the group has been logged for longer than this period,
+ *        the bucket may not be refilled completely. The token state is updated
+ *        without a lock - a message logged in an interrupt during the update may not
+ *        be counted. This only affects the accuracy of the limit. The rate_shed[]
+ *        counters are incremented atomically and stop at 0xFFFF.
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE uint32_t rte_rate_limit(const uint32_t filter_no)
+{
+    uint32_t config = g_rtedbg.rate_limit[filter_no];
+    uint32_t interval = config & 0x00FFFFFFU;
+    if (interval == 0U)
+    {
+        return 0U;      // The message group is not limited
+    }
+
+    uint32_t burst = config >> 24U;
+    rte_rate_state_t *p_state = &rte_rate_state[filter_no];
+    const uint32_t unit_shift = (32U - (RTE_TIMESTAMP_COUNTER_BITS)) + (RTE_TIMESTAMP_SHIFT);
+
+    // The timestamp is scaled to 32 bits, so the difference is also valid after the counter wraps.
+    uint32_t now = (uint32_t)(rte_get_timestamp() << (32U - (RTE_TIMESTAMP_COUNTER_BITS)));
+    uint32_t elapsed = (now - p_state->last) >> unit_shift;
+    uint32_t tokens = p_state->tokens;
+
+    while ((elapsed >= interval) && (tokens < burst))
+    {
+        tokens++;
+        elapsed -= interval;
+        p_state->last += interval << unit_shift;
+    }
+
+    if (tokens >= burst)
+    {
+        tokens = burst;         // Also if the burst size has been reduced by the host
+        p_state->last = now;
+    }
+
+    if (tokens == 0U)
+    {
+        RTE_INCREMENT_SATURATED(g_rtedbg.rate_shed[filter_no]);
+        return 1U;
+    }
+
+    p_state->tokens = tokens - 1U;
+    return 0U;
+}
+#endif // RTE_RATE_LIMIT_ENABLED == 1
+
+
+#if ((RTE_NO_OF_CONTEXTS) > 1) && (RTE_USE_LONG_TIMESTAMP != 0)
+/********************************************************************************
+ * @brief Log the long timestamp message to the data structure of a context.
+ *        The message is the same as the one logged by the __rte_msg1().
+ *
+ * @param p_rtedbg      Pointer to the data logging structure of the context
+ * @param long_t_stamp  Timestamp bits above the short timestamp
+ ********************************************************************************/
+
+static void rte_long_timestamp_context(rtedbg_t *p_rtedbg, const uint32_t long_t_stamp)
+{
+    uint32_t buf_index;
+    RTE_RESERVE_SPACE(p_rtedbg, buf_index, 2U);                             //lint !e717
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+    uint32_t fmt = (uint32_t)(MSG1_LONG_TIMESTAMP) | (long_t_stamp >> 31U);
+
+    p_rtedbg->buffer[buf_index] = long_t_stamp << 1U;
+    p_rtedbg->buffer[buf_index + 1U] = timestamp | 1U | (fmt << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+}
+
+
+/********************************************************************************
+ * @brief Copy the long timestamp message to all contexts except the current one
+ *        (see the RTE_LOG_LONG_TIMESTAMP()). Each context is therefore anchored
+ *        to the absolute time and the host can merge the messages of all contexts.
+ *        The trigger, statistics and priority region are not updated for the copies.
+ *
+ * @param long_t_stamp  Timestamp bits above the short timestamp
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_long_timestamp_contexts(const uint32_t long_t_stamp)
+{
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, (uint32_t)(F_SYSTEM) << (uint32_t)(RTE_FMT_ID_BITS), 0U))
+    {
+        return;
+    }
+
+    uint32_t current = RTE_CONTEXT_INDEX();
+    for (uint32_t context = 0U; context < (uint32_t)(RTE_NO_OF_CONTEXTS); context++)
+    {
+        if (context != current)
+        {
+            rte_long_timestamp_context(rte_context(context), long_t_stamp);
+        }
+    }
+}
+#endif // ((RTE_NO_OF_CONTEXTS) > 1) && (RTE_USE_LONG_TIMESTAMP != 0)
+
+
 /********************************************************************************
  * @brief Log a message defined by address and size + timestamp/format ID.
  *
@@ -467,6 +871,9 @@ RTE_OPTIM_SIZE void __rte_msg4(const uint32_t fmt_id, const rte_any32_t data1, c
  * a system error when accessing an unaligned memory address.
  * If logging a message at an unaligned address occurs while RTE_HANDLE_UNALIGNED_MEMORY_ACCESS
  * is enabled, logging will be slower compared to cases where the memory address is aligned.
+ * The data is then read with aligned word accesses and the adjacent words are combined with
+ * shifts. The aligned words that do not contain any data byte are not read - the unused
+ * bytes of the last DATA word may be zero.
  *
  * If the message length is not divisible by 4 and the memory protection unit (MPU)
  * is enabled, the additional bytes copied in the last word must not be outside the
@@ -483,7 +890,7 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
     }
 #endif
 
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
     volatile const uint32_t *addr_w = (volatile const uint32_t *)address;    //lint !e925 !e9079 !e9087
 #if RTE_HANDLE_UNALIGNED_MEMORY_ACCESS == 1
     volatile const uint8_t *addr_b = (volatile const uint8_t *)address;       //lint !e925 !e9079 !e9087
@@ -494,16 +901,19 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U))   //lint !e948 !e944
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U))   //lint !e948 !e944
     {
         return;     // Discard the message if not enabled
     }
+    RTE_RATE_LIMIT(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U)
 
     if (length > RTE_MAX_MSG_SIZE)
     {
 #if RTE_DISCARD_TOO_LONG_MESSAGES != 0
+        RTE_STAT_DISCARDED()
         return;
 #else
+        RTE_STAT_TRUNCATED()
         length = RTE_MAX_MSG_SIZE;
 #endif
     }
@@ -517,6 +927,13 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, no_words);                       //lint !e717
+    RTE_TRIGGER(p_rtedbg, (RTE_MINIMIZED_CODE_SIZE != 0) ? fmt_id : (fmt_id << 4U),
+                rte_trigger_data(address, length), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U, no_words)
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    const uint32_t msg_index = buf_index;
+    const uint32_t msg_words = no_words;
+#endif
 
 #if RTE_DELAYED_TSTAMP_READ != 0
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
@@ -535,6 +952,21 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 #if RTE_HANDLE_UNALIGNED_MEMORY_ACCESS == 1
     if ((uint32_t)address & 3U)
     {
+        // Aligned words are read and two adjacent words are combined with shifts (little
+        // endian CPU). Only the aligned words that contain data bytes are read.
+        const uint32_t offset = (uint32_t)((uintptr_t)address & 3U);        //lint !e923
+        const uint32_t shift = offset * 8U;
+        volatile const uint32_t *p_word = (volatile const uint32_t *)(addr_b - offset);    //lint !e826 !e927
+        // Number of aligned words with data (none for an empty message)
+        uint32_t no_loads = (length != 0U) ? ((offset + length + 3U) / 4U) : 0U;
+        uint32_t low = 0U;          // Data bytes of the previous aligned word
+        if (no_loads != 0U)
+        {
+            low = *p_word >> shift;
+            p_word++;
+            no_loads--;
+        }
+
         do
         {
             rte_pack_data_t data;                                               //lint !e9018
@@ -545,17 +977,21 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 #endif
 
             // Store data in the reserved space in the circular buffer
-            uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+            uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
             uint32_t words_this_packet = (no_words > 5U) ? 5U : no_words;
 
             // Process full words in this packet
             for (uint32_t i = 1U; i < words_this_packet; i++)
             {
-                data.w32.data = (uint32_t)addr_b[3];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[2];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[1];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[0];
-                addr_b += 4U;
+                uint32_t high = 0U;
+                if (no_loads != 0U)
+                {
+                    high = *p_word;
+                    p_word++;
+                    no_loads--;
+                }
+                data.w32.data = low | (high << (32U - shift));
+                low = high >> shift;
                 data.w64 <<= 1U;
                 *data_packet = data.w32.data;
                 data_packet++;
@@ -589,7 +1025,7 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 #endif
 
             // Store data in the reserved space in the circular buffer
-            uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+            uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
             switch (no_words)
             {
                 default:
@@ -641,26 +1077,47 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 
 #elif RTE_MINIMIZED_CODE_SIZE == 2
     //********* Version optimized for code size *********
+#if RTE_HANDLE_UNALIGNED_MEMORY_ACCESS == 1
+    // Unaligned address: aligned words are read and two adjacent words are combined with
+    // shifts (little endian CPU). Only the aligned words that contain data bytes are read.
+    const uint32_t offset = (uint32_t)((uintptr_t)address & 3U);            //lint !e923
+    const uint32_t shift = offset * 8U;
+    volatile const uint32_t *p_word = (volatile const uint32_t *)(addr_b - offset);    //lint !e826 !e927
+    // Number of aligned words with data (none for an empty message)
+    uint32_t no_loads = (length != 0U) ? ((offset + length + 3U) / 4U) : 0U;
+    uint32_t low = 0U;              // Data bytes of the previous aligned word
+    if ((offset != 0U) && (no_loads != 0U))
+    {
+        low = *p_word >> shift;
+        p_word++;
+        no_loads--;
+    }
+#endif
+
     do
     {
         rte_pack_data_t data;                                               //lint !e9018
         data.w32.bits31 = 0xF0U;    // Extended data mask
 
         // Store data in the reserved space in the circular buffer
-        uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+        uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
         uint32_t words_this_packet = (no_words > 5U) ? 5U : no_words;
 
         // Process full words in this packet
         for (uint32_t i = 1U; i < words_this_packet; i++)
         {
 #if RTE_HANDLE_UNALIGNED_MEMORY_ACCESS == 1
-            if ((uint32_t)address & 3U)
+            if (offset != 0U)
             {
-                data.w32.data = (uint32_t)addr_b[3];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[2];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[1];
-                data.w32.data = (data.w32.data << 8U) | (uint32_t)addr_b[0];
-                addr_b += 4U;
+                uint32_t high = 0U;
+                if (no_loads != 0U)
+                {
+                    high = *p_word;
+                    p_word++;
+                    no_loads--;
+                }
+                data.w32.data = low | (high << (32U - shift));
+                low = high >> shift;
             }
             else
 #endif
@@ -685,6 +1142,8 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
 #else
 #error "RTE_MINIMIZED_CODE_SIZE value out of range"
 #endif
+
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U, msg_index, msg_words)
 }
 
 
@@ -701,30 +1160,35 @@ RTE_OPTIM_LARGE void __rte_msgn(const uint32_t fmt_id,
  * @note  This function allows you to log data whose length is not divisible by
  *        four and the length is unknown at compile time, or whose address does not
  *        need to be word aligned. The string type data also does not have to be
- *        null terminated. The data is read as bytes from the source address.
+ *        null terminated. Whole words are read with a single 32-bit access if the
+ *        address is word aligned. Otherwise, the data is read as bytes. Bytes beyond
+ *        the end of the data are never read.
  ********************************************************************************/
 
 RTE_OPTIM_LARGE void __rte_msgx(const uint32_t fmt_id,
                                 volatile const void *const address, const uint32_t data_length)
 {
-    rtedbg_t *p_rtedbg = &g_rtedbg;
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
     uint32_t length = data_length;
 
 #if RTE_DELAYED_TSTAMP_READ != 1
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
-    if (RTE_MESSAGE_DISABLED(p_rtedbg->filter, fmt_id, 4U))
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 4U))
     {
         return;
     }
+    RTE_RATE_LIMIT(fmt_id, 4U)
 
     // Calculate the space required to copy the message to the circular buffer
     if (length > (RTE_MAX_MSGX_SIZE - 1U))
     {
 #if RTE_DISCARD_TOO_LONG_MESSAGES != 0
+        RTE_STAT_DISCARDED()
         return;
 #else
+        RTE_STAT_TRUNCATED()
         length = RTE_MAX_MSGX_SIZE - 1U;
 #endif
     }
@@ -732,65 +1196,94 @@ RTE_OPTIM_LARGE void __rte_msgx(const uint32_t fmt_id,
     uint32_t no_words = 2U + (length / 4U) + (length / 16U);
     uint32_t buf_index;
     RTE_RESERVE_SPACE(p_rtedbg, buf_index, no_words);                       //lint !e717
+    RTE_TRIGGER(p_rtedbg, fmt_id << 4U, rte_trigger_data(address, length), buf_index)
+    RTE_STAT_MESSAGE(fmt_id, 4U, no_words)
+#if (RTE_PRIORITY_BUFFER_SIZE) > 0
+    const uint32_t msg_index = buf_index;
+    const uint32_t msg_words = no_words;
+#endif
 
 #if RTE_DELAYED_TSTAMP_READ != 0
     uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
 #endif
 
     timestamp |= (fmt_id << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U))) | 1U;
-    rte_pack_data_t data;                                                   //lint !e9018
     volatile const uint8_t *addr = (volatile const uint8_t *)address;      //lint !e925 !e9079
-    int32_t remaining_bytes = (int32_t)length;
+
+    // Whole words are read from a word aligned address with a single access (little endian
+    // CPU - the same as in the __rte_msgn()). Bytes are never read beyond the end of data.
+    // The number of whole DATA words is known in advance - the word loops do not check
+    // the remaining length and the alignment is checked once per subpacket. The top bits
+    // of the DATA words are collected in a 32-bit variable (no 64-bit shift per word).
+    const uint32_t aligned = (((uintptr_t)address & 3U) == 0U) ? 1U : 0U;  //lint !e923
+    uint32_t full_words = length / 4U;
 
     do
     {
-        data.w32.bits31 = 0U;
-        no_words = 4U;
-        uint32_t *data_packet = &g_rtedbg.buffer[buf_index];
+        uint32_t bits31 = 0U;
+        no_words = (full_words < 4U) ? full_words : 4U;
+        full_words -= no_words;
+        uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
 
-        do
+        if (no_words != 0U)    // Skipped if there are no whole words in the last subpacket
         {
-            data.w32.data = 0U;
-            switch (remaining_bytes)
+            if (aligned != 0U)
             {
-                default:
-                    data.w32.data = ((uint32_t)addr[3U]) << 24U;
-                    RTE_FALLTHROUGH; /* fallthrough */ //lint -fallthrough
-                case 3:
-                    data.w32.data |= ((uint32_t)addr[2U]) << 16U;
+                for (uint32_t i = 0U; i < no_words; i++)
+                {
+                    const uint32_t word = *(volatile const uint32_t *)addr; //lint !e927 !e826
+                    addr += 4U;                                             //lint !e9016
+                    bits31 = (bits31 << 1U) | (word >> 31U);
+                    *data_packet = word << 1U;
+                    data_packet++;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0U; i < no_words; i++)
+                {
+                    const uint32_t word = (uint32_t)addr[0U] | ((uint32_t)addr[1U] << 8U)
+                                        | ((uint32_t)addr[2U] << 16U) | ((uint32_t)addr[3U] << 24U);
+                    addr += 4U;                                             //lint !e9016
+                    bits31 = (bits31 << 1U) | (word >> 31U);
+                    *data_packet = word << 1U;
+                    data_packet++;
+                }
+            }
+        }
+
+        if (no_words < 4U)
+        {
+            // The last DATA word - remaining bytes and the length of data (top most byte)
+            uint32_t word = length << 24U;
+            switch (length & 3U)
+            {
+                case 3U:
+                    word |= ((uint32_t)addr[2U]) << 16U;
                     RTE_FALLTHROUGH; /* fallthrough */ //lint -fallthrough
-                case 2:
-                    data.w32.data |= ((uint32_t)addr[1U]) << 8U;
+                case 2U:
+                    word |= ((uint32_t)addr[1U]) << 8U;
                     RTE_FALLTHROUGH; /* fallthrough */ //lint -fallthrough
-                case 1:
-                    data.w32.data |= (uint32_t)*addr;
+                case 1U:
+                    word |= (uint32_t)*addr;
                     break;
-                case 0:
+                default:
                     break;
             }
 
-            addr += 4U;                                                     //lint !e9016
-            remaining_bytes -= 4;
-            if (remaining_bytes < 0)
-            {
-                // Add the length of data (top most byte of last DATA word)
-                data.w32.data |= (length << 24U);
-                no_words = 1U;      // Exit the loop
-            }
-
-            data.w64 <<= 1U;
-            *data_packet = data.w32.data;
+            bits31 = (bits31 << 1U) | (word >> 31U);
+            *data_packet = word << 1U;
             data_packet++;
-            no_words--;
         }
-        while (no_words != 0U);
 
         // Add the 32-bit word with the format ID and timestamp
-        *data_packet = timestamp | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+        *data_packet = timestamp | (bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
         buf_index += 5U;
         RTE_LIMIT_INDEX(buf_index)
     }
-    while (remaining_bytes >= 0);
+    while (no_words == 4U);
+
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 4U, msg_index, msg_words)
 }
 
 
@@ -808,6 +1301,28 @@ RTE_OPTIM_SIZE void __rte_string(const uint32_t fmt_id, const char * const addre
 }
 
 
+/********************************************************************************
+ * @brief Find the length of a string (excluding the trailing null byte).
+ *
+ * @param address     String start address
+ * @param max_length  Maximum number of bytes checked
+ *
+ * @return String length (max. max_length)
+ ********************************************************************************/
+
+__STATIC_FORCEINLINE uint32_t rte_string_length(const char * const address, const uint32_t max_length)
+{
+    const char *s = address;
+    uint32_t len;
+    for (len = 0U; (len < max_length) && (*s != '\0'); len++)
+    {
+        s++;
+    }
+
+    return len;
+}
+
+
 /********************************************************************************
  * @brief Write a string to the circular buffer. The maximum message length is limited
  *        by RTE_MAX_MSG_SIZE. If the length of the string (excluding the trailing
@@ -817,25 +1332,518 @@ RTE_OPTIM_SIZE void __rte_string(const uint32_t fmt_id, const char * const addre
  * @param fmt_id      Format ID number - see the description of __rte_msg0().
  * @param address     String start address
  * @param max_length  Maximum message length to be stored in the circular buffer
+ *
+ * @note  With RTE_SINGLE_PASS_STRINGS = 1, the end of the string is searched for in the
+ *        first 16 bytes (one subpacket) before the space is reserved. The space for a
+ *        longer string is reserved for the longest possible string (max_length) and the
+ *        string is copied while searching for its end. This is done only if max_length
+ *        is not larger than RTE_SINGLE_PASS_MAX_LENGTH and the single shot logging is
+ *        not active - the length of the string is determined first otherwise (as with
+ *        RTE_SINGLE_PASS_STRINGS = 0). Whole words are read with a single 32-bit access
+ *        if the address is word aligned. Otherwise, the string is read byte by byte -
+ *        the address does not have to be aligned. The bytes after the end of the string
+ *        are saved as zeros in the last DATA word. The unused words at the end of the
+ *        reserved space are returned if no other message has been logged in the meantime.
+ *        Otherwise, they are set to RTE_ERASED_STATE.
  ********************************************************************************/
 
+#if RTE_SINGLE_PASS_STRINGS == 1
 RTE_OPTIM_SPEED void __rte_stringn(const uint32_t fmt_id,
                                    const char * const address, const uint32_t max_length)
 {
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
     uint32_t length = max_length;
+
+#if RTE_DELAYED_TSTAMP_READ != 1
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U))   //lint !e948 !e944
+    {
+        return;     // Discard the message if not enabled
+    }
+
     if (RTE_MAX_MSG_SIZE < length)
     {
         length = RTE_MAX_MSG_SIZE;  // Limit the size to the maximum possible
     }
 
-    const char *s = address;
-    uint32_t len;
-    for (len = 0U; (*s != '\0') && (len < length); len++)
+    // Short strings (up to one subpacket) - reserve only the space required
+    uint32_t len = rte_string_length(address, (length < 16U) ? length : 16U);
+    if (len < 16U)
     {
-        s++;
+        length = len;
+    }
+    else if ((length > (uint32_t)(RTE_SINGLE_PASS_MAX_LENGTH))
+#if RTE_SINGLE_SHOT_ENABLED != 0
+             || ((p_rtedbg->rte_cfg & RTE_SINGLE_SHOT_LOGGING_IS_ACTIVE) != 0U)
+#endif
+            )
+    {
+        // Do not reserve too much space for a long string (the unused words can not
+        // always be returned) - find the string length first.
+        __rte_msgn(fmt_id, address, rte_string_length(address, length));
+        return;
+    }
+
+    RTE_RATE_LIMIT(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U)
+
+    // Reserve the space required for the longest possible string
+    uint32_t max_words = ((length + 3U) / 4U) + ((length + 15U) / 16U);
+    if (max_words == 0U)
+    {
+        max_words = 1U;
     }
 
-    __rte_msgn(fmt_id, address, len);
+    uint32_t buf_index;
+    RTE_RESERVE_SPACE(p_rtedbg, buf_index, max_words);                      //lint !e717
+    const uint32_t msg_index = buf_index;
+
+#if RTE_DELAYED_TSTAMP_READ != 0
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+#if RTE_MINIMIZED_CODE_SIZE != 0
+    const unsigned fmt_mask = ((1U << ((uint32_t)(RTE_FMT_ID_BITS) - 4U)) - 1U) << 4U;
+    timestamp |= ((fmt_id & fmt_mask) << (32U - (uint32_t)(RTE_FMT_ID_BITS))) | 1U;
+#else
+    const unsigned fmt_mask = ((1U << ((uint32_t)(RTE_FMT_ID_BITS) - 4U)) - 1U) << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U));
+    timestamp |= ((fmt_id << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U))) & fmt_mask) | 1U;
+#endif
+
+    const uint8_t *addr = (const uint8_t *)address;                             //lint !e9079
+    const uint32_t aligned = (((uintptr_t)address & 3U) == 0U) ? 1U : 0U;       //lint !e923
+    uint32_t remaining_bytes = length;
+    uint32_t no_words = 0U;         // Number of words written (DATA and FMT)
+    uint32_t data_words;            // Number of DATA words in the last subpacket
+    uint32_t *data_packet;
+    uint32_t done = 0U;
+
+    do
+    {
+        rte_pack_data_t data;                                               //lint !e9018
+#if RTE_MINIMIZED_CODE_SIZE != 0
+        data.w32.bits31 = 0xF0U;    // Extended data mask
+#else
+        data.w32.bits31 = 0U;
+#endif
+        data_packet = &p_rtedbg->buffer[buf_index];
+        data_words = 0U;
+
+        do
+        {
+            uint32_t word;
+            uint32_t bytes;         // Number of string bytes in the word
+
+            if ((aligned != 0U) && (remaining_bytes >= 4U))
+            {
+                word = *(const uint32_t *)addr;                             //lint !e826 !e927
+                bytes = 4U;
+                if (((word - 0x01010101U) & ~word & 0x80808080U) != 0U)
+                {
+                    // The word contains the terminating null byte (little endian CPU)
+                    bytes = 0U;
+                    while (((word >> (bytes * 8U)) & 0xFFU) != 0U)
+                    {
+                        bytes++;
+                    }
+                    word &= ~(0xFFFFFFFFU << (bytes * 8U));
+                }
+            }
+            else
+            {
+                const uint32_t max_bytes = (remaining_bytes > 4U) ? 4U : remaining_bytes;
+                word = 0U;
+                bytes = 0U;
+                while ((bytes < max_bytes) && (addr[bytes] != 0U))
+                {
+                    word |= (uint32_t)addr[bytes] << (bytes * 8U);
+                    bytes++;
+                }
+            }
+
+            addr += 4U;
+            remaining_bytes -= bytes;
+            if ((bytes != 4U) || (remaining_bytes == 0U))
+            {
+                done = 1U;          // End of the string or maximum length reached
+                if (bytes == 0U)
+                {
+                    break;
+                }
+            }
+
+            data.w32.data = word;
+            data.w64 <<= 1U;
+            *data_packet = data.w32.data;
+            data_packet++;
+            data_words++;
+        }
+        while ((data_words < 4U) && (done == 0U));
+
+        if ((done == 0U) && (*addr == 0U))
+        {
+            done = 1U;              // The string ends with the subpacket
+        }
+
+        // Add the word with format ID and timestamp (and extended data bits in minimized mode)
+#if RTE_MINIMIZED_CODE_SIZE != 0
+        *data_packet = timestamp |
+                      (((data.w32.bits31 & 0x0FU) | (fmt_id & (data.w32.bits31 >> 4U)))
+                       << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+#else
+        *data_packet = timestamp | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+#endif
+        no_words += data_words + 1U;
+        buf_index += 5U;
+        RTE_LIMIT_INDEX(buf_index)
+    }
+    while (done == 0U);
+
+    if (no_words != max_words)
+    {
+        uint32_t released;
+        RTE_RELEASE_SPACE(p_rtedbg, msg_index + max_words, msg_index + no_words, released);  //lint !e717
+        if (released == 0U)
+        {
+            // Space has been reserved by another message in the meantime - mark the
+            // unused words as reserved but not written.
+            uint32_t unused = max_words - no_words;
+            uint32_t count = 4U - data_words;   // Unused words after the last FMT word
+            data_packet++;
+            for (;;)
+            {
+                if (count > unused)
+                {
+                    count = unused;
+                }
+                unused -= count;
+                while (count != 0U)
+                {
+                    *data_packet = RTE_ERASED_STATE;
+                    data_packet++;
+                    count--;
+                }
+
+                if (unused == 0U)
+                {
+                    break;
+                }
+                data_packet = &p_rtedbg->buffer[buf_index];
+                buf_index += 5U;
+                RTE_LIMIT_INDEX(buf_index)
+                count = 5U;
+            }
+        }
+    }
+
+    RTE_TRIGGER(p_rtedbg, (RTE_MINIMIZED_CODE_SIZE != 0) ? fmt_id : (fmt_id << 4U),
+                rte_trigger_data(address, length - remaining_bytes), msg_index)
+    RTE_STAT_MESSAGE(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U, no_words)
+    RTE_PRIORITY_COPY(p_rtedbg, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U, msg_index, no_words)
+}
+
+#else  // RTE_SINGLE_PASS_STRINGS == 0
+
+RTE_OPTIM_SPEED void __rte_stringn(const uint32_t fmt_id,
+                                   const char * const address, const uint32_t max_length)
+{
+    uint32_t length = max_length;
+    if (RTE_MAX_MSG_SIZE < length)
+    {
+        length = RTE_MAX_MSG_SIZE;  // Limit the size to the maximum possible
+    }
+
+    __rte_msgn(fmt_id, address, rte_string_length(address, length));
+}
+#endif // RTE_SINGLE_PASS_STRINGS == 1
+
+
+/********************************************************************************
+ * @brief Reserve space for a message with 'no_words' DATA words and prepare the writer
+ *        for the rte_writer_put() and rte_msg_commit() - see the RTE_MSG_RESERVE().
+ *        The maximum message length is limited by RTE_MAX_MSG_SIZE.
+ *
+ * @param p_writer  Writer data structure
+ * @param fmt_id    Format ID number - see the description of __rte_msg0().
+ * @param no_words  Number of 32-bit DATA words
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE void __rte_msg_reserve(rte_writer_t * const p_writer,
+                                      const uint32_t fmt_id, const uint32_t no_words)
+{
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
+    uint32_t data_words = no_words;
+
+    p_writer->p_rtedbg = NULL;      // Not active until the space is reserved
+    p_writer->p_word = NULL;
+    p_writer->p_end = NULL;
+
+#if RTE_DELAYED_TSTAMP_READ != 1
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+    if (RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U))   //lint !e948 !e944
+    {
+        return;     // Discard the message if not enabled
+    }
+    RTE_RATE_LIMIT(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U)
+
+    if (data_words > (RTE_MAX_MSG_SIZE / 4U))
+    {
+#if RTE_DISCARD_TOO_LONG_MESSAGES != 0
+        RTE_STAT_DISCARDED()
+        return;
+#else
+        RTE_STAT_TRUNCATED()
+        data_words = RTE_MAX_MSG_SIZE / 4U;
+#endif
+    }
+
+    // Add one FMT word for every four DATA words
+    uint32_t msg_words = data_words + ((data_words + 3U) / 4U);
+    if (msg_words == 0U)
+    {
+        msg_words = 1U;
+    }
+
+    uint32_t buf_index;
+    RTE_RESERVE_SPACE(p_rtedbg, buf_index, msg_words);                      //lint !e717
+    RTE_STAT_MESSAGE(fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U, msg_words)
+
+#if RTE_DELAYED_TSTAMP_READ != 0
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+#if RTE_MINIMIZED_CODE_SIZE != 0
+    const unsigned fmt_mask = ((1U << ((uint32_t)(RTE_FMT_ID_BITS) - 4U)) - 1U) << 4U;
+    timestamp |= ((fmt_id & fmt_mask) << (32U - (uint32_t)(RTE_FMT_ID_BITS))) | 1U;
+    p_writer->bits31 = 0xF0U;   // Extended data mask
+#else
+    const unsigned fmt_mask = ((1U << ((uint32_t)(RTE_FMT_ID_BITS) - 4U)) - 1U) << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U));
+    timestamp |= ((fmt_id << (32U - ((uint32_t)(RTE_FMT_ID_BITS) - 4U))) & fmt_mask) | 1U;
+    p_writer->bits31 = 0U;
+#endif
+
+    p_writer->fmt_word = timestamp;
+    p_writer->fmt_id = fmt_id;
+    p_writer->buf_index = buf_index;
+    p_writer->msg_index = buf_index;
+    p_writer->msg_words = msg_words;
+    const uint32_t sub_words = (data_words > 4U) ? 4U : data_words;
+    p_writer->p_word = &p_rtedbg->buffer[buf_index];
+    p_writer->p_end = &p_rtedbg->buffer[buf_index + sub_words];
+    p_writer->next_words = data_words - sub_words;
+    p_writer->p_rtedbg = p_rtedbg;
+
+    if (data_words == 0U)
+    {
+        __rte_writer_next(p_writer);    // Message without data - only the FMT word
+    }
+}
+
+
+/********************************************************************************
+ * @brief Write the FMT word of a complete subpacket and prepare the writer for the
+ *        next subpacket (if any). Called by the rte_writer_put().
+ *
+ * @param p_writer  Writer prepared by the RTE_MSG_RESERVE()
+ ********************************************************************************/
+
+RTE_OPTIM_SPEED void __rte_writer_next(rte_writer_t * const p_writer)
+{
+    const uint32_t bits31 = p_writer->bits31;
+
+    // Add the word with format ID and timestamp (and extended data bits in minimized mode)
+#if RTE_MINIMIZED_CODE_SIZE != 0
+    *p_writer->p_word = p_writer->fmt_word |
+                        (((bits31 & 0x0FU) | (p_writer->fmt_id & (bits31 >> 4U)))
+                         << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    p_writer->bits31 = 0xF0U;   // Extended data mask
+#else
+    *p_writer->p_word = p_writer->fmt_word | (bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+    p_writer->bits31 = 0U;
+#endif
+
+    uint32_t next_words = p_writer->next_words;
+    if (next_words != 0U)
+    {
+        rtedbg_t *p_rtedbg = (rtedbg_t *)p_writer->p_rtedbg;                //lint !e9079
+        uint32_t buf_index = p_writer->buf_index + 5U;
+        RTE_LIMIT_INDEX(buf_index)
+        p_writer->buf_index = buf_index;
+
+        const uint32_t sub_words = (next_words > 4U) ? 4U : next_words;
+        p_writer->p_word = &p_rtedbg->buffer[buf_index];
+        p_writer->p_end = &p_rtedbg->buffer[buf_index + sub_words];
+        p_writer->next_words = next_words - sub_words;
+    }
+}
+
+
+#if RTE_TRIGGER_ENABLED == 1
+/********************************************************************************
+ * @brief Get the first DATA word of a committed message for the trigger check.
+ *        The word is restored from the circular buffer (bit 31 from the FMT word).
+ *
+ * @param p_writer  Writer of the message
+ *
+ * @return First DATA word (0 if there is no data)
+ ********************************************************************************/
+
+static uint32_t rte_writer_data1(const rte_writer_t * const p_writer)
+{
+    const rtedbg_t *p_rtedbg = (const rtedbg_t *)p_writer->p_rtedbg;      //lint !e9079
+    const uint32_t sub_words = (p_writer->msg_words > 5U) ? 4U : (p_writer->msg_words - 1U);
+
+    if (sub_words == 0U)
+    {
+        return 0U;
+    }
+
+    const uint32_t fmt = p_rtedbg->buffer[p_writer->msg_index + sub_words];
+    const uint32_t bit31 = (fmt >> ((32U - (uint32_t)(RTE_FMT_ID_BITS)) + (sub_words - 1U))) & 1U;
+    return (p_rtedbg->buffer[p_writer->msg_index] >> 1U) | (bit31 << 31U);
+}
+#endif // RTE_TRIGGER_ENABLED == 1
+
+
+/********************************************************************************
+ * @brief Complete the message prepared by the RTE_MSG_RESERVE(). The DATA words
+ *        that have not been written are logged as zero.
+ *
+ * @param p_writer  Writer prepared by the RTE_MSG_RESERVE()
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE void rte_msg_commit(rte_writer_t * const p_writer)
+{
+    rtedbg_t *p_rtedbg = (rtedbg_t *)p_writer->p_rtedbg;                    //lint !e9079
+
+    if (p_rtedbg == NULL)
+    {
+        return;     // The message is not logged
+    }
+
+    while (p_writer->p_word != p_writer->p_end)
+    {
+        rte_writer_put(p_writer, 0U);
+    }
+
+    RTE_TRIGGER(p_rtedbg, (RTE_MINIMIZED_CODE_SIZE != 0) ? p_writer->fmt_id : (p_writer->fmt_id << 4U),
+                rte_writer_data1(p_writer), p_writer->msg_index)
+    RTE_PRIORITY_COPY(p_rtedbg, p_writer->fmt_id, (RTE_MINIMIZED_CODE_SIZE != 0) ? 0U : 4U,
+                      p_writer->msg_index, p_writer->msg_words)
+    p_writer->p_rtedbg = NULL;
+}
+
+
+/********************************************************************************
+ * @brief Log the messages collected with the RTE_BATCH_MSG0() ... RTE_BATCH_MSG4().
+ *        The filters are checked for all messages first. The space for the enabled
+ *        messages is reserved at once. The first message gets the timestamp of the
+ *        commit and every next one a timestamp one unit later - otherwise the decoder
+ *        would join e.g. two RTE_BATCH_MSG4() with the same format ID into one message.
+ *        Every message is stored in the same way as with the __rte_msg0() ... __rte_msg4().
+ *        The batch is empty after the call.
+ *
+ * @param p_batch  Batch prepared by the rte_batch_init()
+ ********************************************************************************/
+
+RTE_OPTIM_SPEED void rte_batch_commit(rte_batch_t * const p_batch)
+{
+    rtedbg_t *p_rtedbg = RTE_CURRENT_CONTEXT();
+    const uint32_t no_msgs = p_batch->no_msgs;
+    uint32_t enabled = 0U;          // Bit mask of the enabled messages
+    uint32_t total_words = 0U;      // Number of words for the enabled messages (DATA and FMT)
+
+    p_batch->no_msgs = 0U;
+    p_batch->no_words = 0U;
+
+#if RTE_DELAYED_TSTAMP_READ != 1
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+
+    for (uint32_t i = 0U; i < no_msgs; i++)
+    {
+        const uint32_t fmt_id = p_batch->fmt_id[i];
+        uint32_t msg_enabled = RTE_MESSAGE_DISABLED(g_rtedbg.filter, fmt_id, 0U) ? 0U : 1U;
+#if RTE_RATE_LIMIT_ENABLED == 1
+        if ((msg_enabled != 0U) && !RTE_MESSAGE_DISABLED(g_rtedbg.rate_limit_mask, fmt_id, 0U))
+        {
+            if (rte_rate_limit((fmt_id >> (uint32_t)(RTE_FMT_ID_BITS)) & 0x1FU) != 0U)
+            {
+                msg_enabled = 0U;
+            }
+        }
+#endif
+        if (msg_enabled != 0U)
+        {
+            enabled |= 1UL << i;
+            total_words += (uint32_t)p_batch->msg_words[i] + 1U;
+        }
+    }
+
+    if (total_words == 0U)
+    {
+        return;     // No message enabled
+    }
+
+    uint32_t buf_index;
+    RTE_RESERVE_SPACE(p_rtedbg, buf_index, total_words);                    //lint !e717
+
+#if RTE_DELAYED_TSTAMP_READ != 0
+    uint32_t timestamp = (rte_get_timestamp() >> ((RTE_TIMESTAMP_SHIFT) - 1U)) & RTE_TIMESTAMP_MASK;
+#endif
+    timestamp |= 1U;
+
+    const rte_any32_t *p_data = &p_batch->data[0];
+
+    for (uint32_t i = 0U; i < no_msgs; i++)
+    {
+        const uint32_t no_words = p_batch->msg_words[i];
+
+        if ((enabled & (1UL << i)) != 0U)
+        {
+#if RTE_BUFF_SIZE_IS_POWER_OF_2 == 0
+            if (buf_index >= (uint32_t)(RTE_BUFFER_SIZE))
+            {
+                // The batch wraps around the end of the buffer. The next writer starts at
+                // index 0 - reserve the space for the rest of the batch again.
+                RTE_RESERVE_SPACE(p_rtedbg, buf_index, total_words);        //lint !e717
+            }
+#endif
+            const uint32_t fmt_id = p_batch->fmt_id[i];
+            RTE_TRIGGER(p_rtedbg, (fmt_id >> no_words) << no_words,
+                        (no_words != 0U) ? RTE_PARAM(p_data[0]) : 0U, buf_index)
+            RTE_STAT_MESSAGE(fmt_id, 0U, no_words + 1U)
+
+            // Same as in the __rte_msg1() ... __rte_msg4() - the lowest no_words bits of the
+            // format ID field contain the bits 31 of the DATA words.
+            rte_pack_data_t data;                                           //lint !e9018
+            data.w32.bits31 = fmt_id >> no_words;
+            uint32_t *data_packet = &p_rtedbg->buffer[buf_index];
+
+            for (uint32_t j = 0U; j < no_words; j++)
+            {
+                data.w32.data = RTE_PARAM(p_data[j]);
+                data.w64 <<= 1U;
+                *data_packet = data.w32.data;
+                data_packet++;
+            }
+
+            *data_packet = timestamp | (data.w32.bits31 << (32U - (uint32_t)(RTE_FMT_ID_BITS)));
+            RTE_PRIORITY_COPY(p_rtedbg, fmt_id, 0U, buf_index, no_words + 1U)
+            timestamp = (timestamp + 2U) & RTE_TIMESTAMP_MASK;  // Next timestamp unit (bit 0 stays 1)
+
+            buf_index += no_words + 1U;
+            total_words -= no_words + 1U;
+#if RTE_BUFF_SIZE_IS_POWER_OF_2 != 0
+            RTE_LIMIT_INDEX(buf_index)
+#endif
+        }
+
+        p_data = &p_data[no_words];
+    }
 }
 
 
@@ -892,6 +1900,77 @@ RTE_OPTIM_SIZE void rte_restore_filter(void)
 #endif // RTE_FIRMWARE_MAY_SET_FILTER != 0
 
 
+#if RTE_DUAL_BANK_ENABLED == 1
+/********************************************************************************
+ * @brief Swap the banks of the ping-pong buffer. The inactive bank is erased
+ *        and becomes active. The previously active bank is frozen - its content
+ *        does not change until the next swap and can be transferred to the host
+ *        while messages are logged to the other bank.
+ *
+ * @return Index of the frozen bank (0 = g_rtedbg, 1 = g_rtedbg_bank)
+ *
+ * @note  The erasing of the bank takes time proportional to the buffer size.
+ *        The message filter is not changed - no messages are lost during the swap.
+ *        A message whose logging was interrupted just before the swap is completed
+ *        in the frozen bank. The host decodes it as an incomplete message if it reads
+ *        the frozen bank before the interrupted task continues.
+ *        The trigger words are copied to the new bank since the trigger is checked in
+ *        the active bank. A post-trigger window continues in the new bank.
+ *        The function is called from the serial interrupt (RTECOM_SWAP_BANKS). A long
+ *        timestamp is logged at the start of the new bank only if the rte_long_timestamp()
+ *        of the timer driver is reentrant (e.g. rtedbg_timer_systick_ext.h). Otherwise,
+ *        the interrupt could corrupt the long timestamp state of an interrupted
+ *        rte_long_timestamp() call - the new bank is then anchored by the next periodic
+ *        rte_long_timestamp() call of the application.
+ ********************************************************************************/
+
+RTE_OPTIM_SIZE uint32_t rte_swap_banks(void)
+{
+    rtedbg_t *p_frozen = g_rte_active_bank;
+    rtedbg_t *p_next = (p_frozen == &g_rtedbg) ? &g_rtedbg_bank : &g_rtedbg;
+
+    rte_erase_buffer(p_next);
+    p_next->buf_index = 0U;
+#if RTE_LAP_COUNTER_ENABLED == 1
+    p_next->buf_laps = 0U;
+#endif
+
+#if RTE_TRIGGER_ENABLED == 1
+    p_next->trigger_fmt = p_frozen->trigger_fmt;
+    p_next->trigger_data = p_frozen->trigger_data;
+    p_next->trigger_mask = p_frozen->trigger_mask;
+    p_next->trigger_post = p_frozen->trigger_post;
+    uint32_t trigger_state = p_frozen->trigger_state;
+    uint32_t trigger_index = p_frozen->trigger_index;
+    if (trigger_state == RTE_TRIGGER_FIRED)
+    {
+        // Keep the distance from the trigger message - the index of the new bank starts with 0
+        uint32_t buf_index = p_frozen->buf_index;
+        RTE_LIMIT_INDEX(buf_index)
+        uint32_t distance = buf_index - trigger_index;
+        if (buf_index < trigger_index)
+        {
+            distance += (uint32_t)(RTE_BUFFER_SIZE);    // The index has wrapped around
+        }
+        trigger_index = (uint32_t)(RTE_BUFFER_SIZE) - distance;
+    }
+    p_next->trigger_index = trigger_index;
+    p_next->trigger_state = trigger_state;
+#endif
+
+    RTE_DATA_MEMORY_BARRIER();          // The bank must be erased before the loggers see it.
+    g_rte_active_bank = p_next;
+    RTE_DATA_MEMORY_BARRIER();          // Ensure visibility of changes across all CPU cores.
+
+#if (RTE_USE_LONG_TIMESTAMP != 0) && (RTE_LONG_TIMESTAMP_REENTRANT == 1U)
+    rte_long_timestamp();               // Absolute time reference for the new bank
+#endif
+
+    return (p_frozen == &g_rtedbg) ? 0U : 1U;
+}
+#endif // RTE_DUAL_BANK_ENABLED == 1
+
+
 /********************************************************************************
  * @brief Retrieve the current value of the message filter.
  *
@@ -917,6 +1996,15 @@ RTE_OPTIM_SIZE uint32_t rte_get_filter(void)
 RTE_OPTIM_SIZE void rte_timestamp_frequency(const uint32_t new_frequency)
 {
     g_rtedbg.timestamp_frequency = new_frequency;
+#if RTE_NO_OF_CONTEXTS > 1
+    for (uint32_t context = 1U; context < (uint32_t)(RTE_NO_OF_CONTEXTS); context++)
+    {
+        rte_context(context)->timestamp_frequency = new_frequency;
+    }
+#endif
+#if RTE_DUAL_BANK_ENABLED == 1
+    g_rtedbg_bank.timestamp_frequency = new_frequency;
+#endif
     RTE_MSG1(MSG1_TSTAMP_FREQUENCY, F_SYSTEM, new_frequency)
 }
 #endif  // !defined RTE_USE_INLINE_FUNCTIONS